@@ -44,6 +44,7 @@ typedef struct _aos_graphics_info
     uint32 vres;      /*竖直分辨率。*/
     uintn  fb_base;   /*帧缓冲基址。*/
     uintn  fb_size;   /*帧缓冲大小。*/
+    uintn  fb_vbase;  /*帧缓冲线性基址。按写合并映射，未映射时为0。*/
     uint32 red;       /*红色区掩码。*/
     uint32 green;     /*绿色区掩码。*/
     uint32 blue;      /*蓝色区掩码。*/
@@ -64,6 +65,7 @@ struct _aos_boot_vma
     uintn         start; /*开始地址。*/
     uintn         end;   /*结束地址。*/
     uint64        flags; /*标志。*/
+    uintn         paddr; /*物理起始地址。*/
 };
 
 /**
@@ -87,6 +89,7 @@ typedef struct _aos_kernel_info
     uintn   sbase; /*栈线性基址。*/
     uintn   gbase; /*GDT基址。*/
     uintn   pbase; /*内核内存池线性基址。*/
+    uintn   fbase; /*页框描述符数组线性基址。*/
     uintn   entry; /*入口偏移。*/
     uintn   load;  /*加载段数目。*/
     uintn*  start; /*加载段起始数组。*/
@@ -108,7 +111,7 @@ typedef struct _aos_efi_memory_descriptor
 
 /**
  * 内存信息。其包含了所有可用但已分配的内存块的物理信息，其基址是所有非内核程序遗留数据参考。
- * 固定块长度为5，分别为引导池、页表池、内核池、GDT、内核栈。
+ * 固定块长度为6，分别为引导池、页表池、内核池、GDT、内核栈、页框描述符数组。
  * 可变块长度为内核LOAD段数目，按文件内部排序。
  * 基址用于引导部分需要提前映射的低4GB数据进行映射。
  */
@@ -118,10 +121,11 @@ typedef struct _aos_memory_info
     uintn                      map_length;      /*内存图长度。*/
     uintn                      map_entry_size;  /*内存项大小。*/
     uintn                      vbase;           /*数据映射线性基址。*/
-    uintn                      fblock_paddr[5]; /*固定内存块物理基址数组。*/
-    uintn                      fblock_pages[5]; /*固定内存块页数数组。*/
+    uintn                      fblock_paddr[6]; /*固定内存块物理基址数组。*/
+    uintn                      fblock_pages[6]; /*固定内存块页数数组。*/
     uintn*                     vblock_paddr;    /*可变内存块物理基址数组。*/
     uintn*                     vblock_pages;    /*可变内存块页数数组。*/
+    uintn                      frames;          /*页框描述符数目。*/
 } aos_memory_info;
 
 /**
@@ -486,6 +490,16 @@ typedef struct _aos_boot_params
  */
 #define AOS_FEATURES_X2APIC BIT4
 
+/**
+ * 特性PCID标志位。
+ */
+#define AOS_FEATURES_PCID BIT5
+
+/**
+ * 特性INVPCID标志位。
+ */
+#define AOS_FEATURES_INVPCID BIT6
+
 /**
  * 状态魔数。
  */
@@ -516,6 +530,11 @@ typedef struct _aos_boot_params
  */
 #define AOS_APIC_X2APIC 2
 
+/**
+ * 页框描述符大小。引导部分按该大小为每个物理页框预留内核页框描述符。
+ */
+#define AOS_FRAME_DESCRIPTOR_SIZE 32
+
 /**
  * 线性区内存类型掩码。
  */
@@ -0,0 +1,197 @@
+/**
+ * 内核本地APIC操作。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#include <cpu/apic.h>
+#include <support/control.h>
+#include <support/io.h>
+
+/**
+ * MSR IA32_APIC_BASE的基址。
+ */
+const static uint32 IA32_APIC_BASE=0x1B;
+
+/**
+ * MSR IA32_X2APIC_APICID的基址。
+ */
+const static uint32 IA32_X2APIC_APICID=0x802;
+
+/**
+ * MSR IA32_X2APIC_EOI的基址。
+ */
+const static uint32 IA32_X2APIC_EOI=0x80B;
+
+/**
+ * MSR IA32_X2APIC_ICR的基址。
+ */
+const static uint32 IA32_X2APIC_ICR=0x830;
+
+/**
+ * xAPIC编号寄存器偏移。
+ */
+const static uintn XAPIC_ID=0x20;
+
+/**
+ * xAPIC中断结束寄存器偏移。
+ */
+const static uintn XAPIC_EOI=0xB0;
+
+/**
+ * xAPIC中断命令寄存器低32位偏移。
+ */
+const static uintn XAPIC_ICR_LOW=0x300;
+
+/**
+ * xAPIC中断命令寄存器高32位偏移。
+ */
+const static uintn XAPIC_ICR_HIGH=0x310;
+
+/**
+ * 中断命令寄存器投递状态位。
+ */
+const static uint32 APIC_ICR_PENDING=BIT12;
+
+/**
+ * 中断命令寄存器电平有效位。
+ */
+const static uint32 APIC_ICR_ASSERT=BIT14;
+
+/**
+ * 中断命令寄存器INIT投递模式。
+ */
+const static uint32 APIC_ICR_INIT=0x500;
+
+/**
+ * 中断命令寄存器启动投递模式。
+ */
+const static uint32 APIC_ICR_STARTUP=0x600;
+
+/**
+ * 获取xAPIC寄存器地址。
+ * 
+ * @param base   IA32_APIC_BASE的值。
+ * @param offset 寄存器偏移。
+ * 
+ * @return 寄存器地址。
+ */
+static inline volatile uint32* apic_xapic_register(uint64 base,uintn offset)
+{
+    return (volatile uint32*)((base&0xFFFFFFFFFFFFF000UL)+offset);
+}
+
+/**
+ * 从本地APIC读取当前CPU的编号。只在安装每CPU区域前使用，此后以get_current_cpu_id读取。
+ * 
+ * @return 当前CPU编号，APIC未启用时返回0。
+ */
+uint32 apic_get_id(void)
+{
+    uint64 base=x86_read_msr(IA32_APIC_BASE);
+    if(!(base&BIT11))
+    {
+        return 0;
+    }
+    else if(base&BIT10)
+    {
+        return (uint32)x86_read_msr(IA32_X2APIC_APICID);
+    }
+    else
+    {
+        return *apic_xapic_register(base,XAPIC_ID)>>24;
+    }
+}
+
+/**
+ * 向指定CPU写入中断命令。按IA32_APIC_BASE选择xAPIC或x2APIC方式，APIC未启用时忽略。
+ * 
+ * @param id      目标CPU编号。
+ * @param command 中断命令寄存器低32位。
+ * 
+ * @return 无返回值。
+ */
+static void apic_send_command(uint32 id,uint32 command)
+{
+    uint64 base=x86_read_msr(IA32_APIC_BASE);
+    if(!(base&BIT11))
+    {
+        return;
+    }
+    else if(base&BIT10)
+    {
+        x86_write_msr(IA32_X2APIC_ICR,((uint64)id<<32)|command);
+    }
+    else
+    {
+        /*xAPIC要求上一次投递完成后才能写入新命令*/
+        while(*apic_xapic_register(base,XAPIC_ICR_LOW)&APIC_ICR_PENDING)
+        {
+            x86_cpu_pause();
+        }
+        *apic_xapic_register(base,XAPIC_ICR_HIGH)=id<<24;
+        *apic_xapic_register(base,XAPIC_ICR_LOW)=command;
+    }
+}
+
+/**
+ * 向指定CPU发送固定模式的处理器间中断。
+ * 
+ * @param id     目标CPU编号。
+ * @param vector 中断向量。
+ * 
+ * @return 无返回值。
+ */
+void apic_send_ipi(uint32 id,uint8 vector)
+{
+    apic_send_command(id,APIC_ICR_ASSERT|vector);
+}
+
+/**
+ * 向指定CPU发送INIT处理器间中断，使其进入等待启动中断的状态。
+ * 
+ * @param id 目标CPU编号。
+ * 
+ * @return 无返回值。
+ */
+void apic_send_init(uint32 id)
+{
+    apic_send_command(id,APIC_ICR_ASSERT|APIC_ICR_INIT);
+}
+
+/**
+ * 向指定CPU发送启动处理器间中断。目标从物理地址vector<<12处以实模式开始执行。
+ * 
+ * @param id     目标CPU编号。
+ * @param vector 启动页号，启动代码需位于低1MB内按4KB对齐。
+ * 
+ * @return 无返回值。
+ */
+void apic_send_startup(uint32 id,uint8 vector)
+{
+    apic_send_command(id,APIC_ICR_ASSERT|APIC_ICR_STARTUP|vector);
+}
+
+/**
+ * 向本地APIC发送中断结束信号。
+ * 
+ * @return 无返回值。
+ */
+void apic_eoi(void)
+{
+    uint64 base=x86_read_msr(IA32_APIC_BASE);
+    if(!(base&BIT11))
+    {
+        return;
+    }
+    else if(base&BIT10)
+    {
+        x86_write_msr(IA32_X2APIC_EOI,0);
+    }
+    else
+    {
+        *apic_xapic_register(base,XAPIC_EOI)=0;
+    }
+}
\ No newline at end of file
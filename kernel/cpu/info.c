@@ -6,42 +6,13 @@
  * 
  * SPDX-License-Identifier: MIT
  */
-#include <support/asm.h>
-#include <support/const.h>
+#include <cpu/info.h>
+#include <support/io.h>
 
 /**
  * MSR IA32_APIC_BASE的基址。
  */
-const uint32 IA32_APIC_BASE=0x1B;
-
-/**
- * MSR IA32_X2APIC_APICID的基址。
- */
-const uint32 IA32_X2APIC_APICID=0x802;
-
-/**
- * 获取当前运行CPU的编号。
- * 
- * @return 当前CPU编号。
- */
-uint32 get_current_cpu_id(void)
-{
-    uint64 base=read_msr(IA32_APIC_BASE);
-    if(!(base&BIT11))
-    {
-        return 0;
-    }
-    else if(base&BIT10)
-    {
-        return (uint32)read_msr(IA32_X2APIC_APICID);
-    }
-    else
-    {
-        base&=0xFFFFFFFFFFFFF000UL;
-        uint32* id=(uint32*)(base+0x20);
-        return *id>>24;
-    }
-}
+const static uint32 IA32_APIC_BASE=0x1B;
 
 /**
  * 获取当前运行CPU的是否是引导处理器。
@@ -50,5 +21,5 @@ uint32 get_current_cpu_id(void)
  */
 bool is_bootstrap_processor(void)
 {
-    return read_msr(IA32_APIC_BASE)&BIT8;
+    return x86_read_msr(IA32_APIC_BASE)&BIT8;
 }
\ No newline at end of file
@@ -0,0 +1,27 @@
+/**
+ * 内核CPU管理模块初始化。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#include <cpu/apic.h>
+#include <cpu/per_cpu_vars.h>
+#include <cpu/rcu.h>
+#include <init/params.h>
+
+/**
+ * 通过启动参数初始化CPU管理模块。引导处理器安装每CPU区域，之后才能读取CPU编号与每CPU变量，并加入宽限期检测。
+ * 在其他模块之前调用。
+ * 
+ * @param params 启动参数。
+ * 
+ * @return 无返回值。
+ */
+void kernel_cpu_init(aos_boot_params* params)
+{
+    (void)params;
+    per_cpu_install(null,apic_get_id());
+    rcu_cpu_online();
+}
\ No newline at end of file
@@ -6,4 +6,173 @@
  * 
  * SPDX-License-Identifier: MIT
  */
-#include <support/type.h>
\ No newline at end of file
+#include <cpu/info.h>
+#include <cpu/per_cpu_vars.h>
+#include <memory/pool.h>
+#include <support/const.h>
+#include <support/io.h>
+#include <support/memory.h>
+
+#ifdef AOS_KERNEL_HOST
+/**
+ * 单个CPU的变量区域。按缓存行对齐，避免CPU之间伪共享。
+ */
+typedef struct _per_cpu_slot
+{
+    alignas(64) uint64 vars[PER_CPU_COUNT]; /*变量值。*/
+} per_cpu_slot;
+
+/**
+ * 每CPU变量区域。宿主机上没有GS基址，按模拟的CPU编号索引。
+ */
+static per_cpu_slot per_cpu_slots[CPU_ID_LIMIT];
+
+/**
+ * 获取每CPU变量值。宿主机上按模拟的CPU编号索引。
+ * 
+ * @param variable 每CPU变量。
+ * 
+ * @return 变量对应值，无设置或无对应返回0。
+ */
+uint64 get_per_cpu_variable(per_cpu_variable variable)
+{
+    uint32 id=get_current_cpu_id();
+    if(id>=CPU_ID_LIMIT||variable>=PER_CPU_COUNT)
+    {
+        return 0;
+    }
+    return per_cpu_slots[id].vars[variable];
+}
+
+/**
+ * 获取指定CPU的每CPU变量值。用于统计等跨CPU只读场景，读取结果可能已过时。
+ * 
+ * @param id       CPU编号。
+ * @param variable 每CPU变量。
+ * 
+ * @return 变量对应值，无设置或无对应返回0。
+ */
+uint64 get_per_cpu_variable_by_id(uint32 id,per_cpu_variable variable)
+{
+    if(id>=CPU_ID_LIMIT||variable>=PER_CPU_COUNT)
+    {
+        return 0;
+    }
+    return per_cpu_slots[id].vars[variable];
+}
+
+/**
+ * 设置每CPU变量值。宿主机上按模拟的CPU编号索引。
+ * 
+ * @param variable 每CPU变量。
+ * @param value    变量值。
+ * 
+ * @return 上一次存储的变量值。
+ */
+uint64 set_per_cpu_variable(per_cpu_variable variable,uint64 value)
+{
+    uint32 id=get_current_cpu_id();
+    if(id>=CPU_ID_LIMIT||variable>=PER_CPU_COUNT)
+    {
+        return 0;
+    }
+    uint64 old=per_cpu_slots[id].vars[variable];
+    per_cpu_slots[id].vars[variable]=value;
+    return old;
+}
+#else
+/**
+ * MSR IA32_GS_BASE的基址。
+ */
+const static uint32 IA32_GS_BASE=0xC0000101;
+
+/**
+ * 每CPU段起始，由链接脚本定义。
+ */
+extern uint8 __per_cpu_start[];
+
+/**
+ * 每CPU段结束，由链接脚本定义。
+ */
+extern uint8 __per_cpu_end[];
+
+/**
+ * 每CPU区域头部。链接脚本把它放在每CPU段起始，引导处理器直接使用每CPU段本身。
+ */
+static per_cpu_area boot_area __attribute__((section(".percpu.head")));
+
+/**
+ * 各CPU的区域。按CPU编号索引，只用于跨CPU访问。
+ */
+static per_cpu_area* areas[CPU_ID_LIMIT];
+
+/**
+ * 获取每CPU段中对象在当前CPU区域中的副本。
+ * 
+ * @param object 带PER_CPU_SECTION属性的对象。
+ * 
+ * @return 当前CPU的副本。
+ */
+void* per_cpu_pointer(const void* object)
+{
+    return (uint8*)per_cpu_self()+((uintn)object-(uintn)__per_cpu_start);
+}
+
+/**
+ * 申请一个已清零的每CPU区域，大小为整个每CPU段。由引导处理器为应用处理器申请。
+ * 
+ * @return 成功返回区域，失败返回空指针。
+ */
+per_cpu_area* per_cpu_create_area(void)
+{
+    uintn size=(uintn)(__per_cpu_end-__per_cpu_start);
+    per_cpu_area* area=pool_alloc_aligned(size,alignof(per_cpu_area));
+    if(area!=null)
+    {
+        memory_zero(area,size);
+    }
+    return area;
+}
+
+/**
+ * 当前CPU安装每CPU区域，写入GS基址、自指针与CPU编号。每个CPU在访问每CPU变量与CPU编号前调用一次。
+ * 
+ * @param area 区域，空指针表示引导处理器直接使用每CPU段本身。
+ * @param id   CPU编号。
+ * 
+ * @return 成功安装返回真。编号超出范围时区域仍然安装，但不能按编号跨CPU访问，返回假。
+ */
+bool per_cpu_install(per_cpu_area* area,uint32 id)
+{
+    if(area==null)
+    {
+        area=&boot_area;
+    }
+    area->self=area;
+    area->id=id;
+    x86_write_msr(IA32_GS_BASE,(uint64)area);
+    if(id>=CPU_ID_LIMIT)
+    {
+        return false;
+    }
+    areas[id]=area;
+    return true;
+}
+
+/**
+ * 获取指定CPU的每CPU变量值。用于统计等跨CPU只读场景，读取结果可能已过时。
+ * 
+ * @param id       CPU编号。
+ * @param variable 每CPU变量。
+ * 
+ * @return 变量对应值，无设置或无对应返回0。
+ */
+uint64 get_per_cpu_variable_by_id(uint32 id,per_cpu_variable variable)
+{
+    if(id>=CPU_ID_LIMIT||variable>=PER_CPU_COUNT||areas[id]==null)
+    {
+        return 0;
+    }
+    return areas[id]->vars[variable];
+}
+#endif /*AOS_KERNEL_HOST*/
\ No newline at end of file
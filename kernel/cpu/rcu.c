@@ -0,0 +1,372 @@
+/**
+ * 内核读-复制-更新同步。基于静止状态，读者不执行任何原子操作。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#include <cpu/info.h>
+#include <cpu/rcu.h>
+#include <support/atomic.h>
+#include <support/control.h>
+#include <support/io.h>
+#include <support/sync.h>
+
+/**
+ * 单个CPU的宽限期状态。静止序号独占缓存行，只有本CPU写入。
+ */
+typedef struct _rcu_cpu
+{
+    alignas(64) atomic_uint64 quiescent;  /*最近一次静止状态时看到的宽限期号，0表示未加入检测。*/
+    rcu_head*                 next_head;  /*等待新宽限期的回调链表头。*/
+    rcu_head**                next_tail;  /*等待新宽限期的回调链表尾指针。*/
+    rcu_head*                 wait_head;  /*等待宽限期结束的回调链表头。*/
+    uint64                    wait_gp;    /*等待批次需要的宽限期号。*/
+} rcu_cpu;
+
+/**
+ * 每CPU宽限期状态。按CPU编号索引。
+ */
+static rcu_cpu rcu_cpus[CPU_ID_LIMIT];
+
+/**
+ * 最新开始的宽限期号，从1开始。
+ */
+static atomic_uint64 gp_current=1;
+
+/**
+ * 已知结束的宽限期号。
+ */
+static atomic_uint64 gp_completed;
+
+/**
+ * 未加入检测的CPU提交或退出检测时留下的回调链表头，由下一个推进批次的CPU接管。
+ */
+static rcu_head* orphan_head=null;
+
+/**
+ * 托管回调链表尾指针。
+ */
+static rcu_head** orphan_tail=&orphan_head;
+
+/**
+ * 托管回调链表非空。供推进批次时不加锁检查。
+ */
+static atomic_bool orphan_pending;
+
+/**
+ * 托管回调链表锁。零值即为未上锁状态。
+ */
+static spinlock orphan_lock;
+
+/**
+ * 获取当前CPU的宽限期状态。
+ * 
+ * @return 宽限期状态，编号超出范围返回空指针。
+ */
+static inline rcu_cpu* rcu_get_cpu(void)
+{
+    uint32 id=get_current_cpu_id();
+    return id<CPU_ID_LIMIT?&rcu_cpus[id]:null;
+}
+
+/**
+ * 检查宽限期是否结束。全部已加入检测的CPU在宽限期开始后都经过了静止状态即结束。
+ * 
+ * @param gp 宽限期号。
+ * 
+ * @return 已结束返回真。
+ */
+static bool rcu_gp_completed(uint64 gp)
+{
+    if(atomic_load_explicit(&gp_completed,MEMORY_ORDER_ACQUIRE)>=gp)
+    {
+        return true;
+    }
+    uint64 oldest=atomic_load(&gp_current);
+    for(uint32 id=0;id<CPU_ID_LIMIT;id++)
+    {
+        uint64 quiescent=atomic_load_explicit(&rcu_cpus[id].quiescent,MEMORY_ORDER_ACQUIRE);
+        if(quiescent!=0&&quiescent<oldest)
+        {
+            oldest=quiescent;
+        }
+    }
+    atomic_fetch_max_explicit(&gp_completed,oldest,MEMORY_ORDER_RELEASE);
+    return oldest>=gp;
+}
+
+/**
+ * 当前CPU记录静止状态。顺序一致存储带全屏障，之后的读取不会被提前到报告之前。
+ * 
+ * @param cpu 宽限期状态。
+ * 
+ * @return 无返回值。
+ */
+static inline void rcu_report(rcu_cpu* cpu)
+{
+    atomic_store(&cpu->quiescent,atomic_load(&gp_current));
+}
+
+/**
+ * 依次调用回调链表。
+ * 
+ * @param head 回调链表头。
+ * 
+ * @return 无返回值。
+ */
+static void rcu_invoke(rcu_head* head)
+{
+    while(head!=null)
+    {
+        /*回调通常会释放结点所在对象，先取后继*/
+        rcu_head* next=head->next;
+        head->callback(head);
+        head=next;
+    }
+}
+
+/**
+ * 检查是否没有CPU加入宽限期检测。此时不存在读者，回调可以立即调用。
+ * 
+ * @return 没有CPU加入检测返回真。
+ */
+static bool rcu_all_offline(void)
+{
+    for(uint32 id=0;id<CPU_ID_LIMIT;id++)
+    {
+        if(atomic_load(&rcu_cpus[id].quiescent)!=0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * 把回调链表交给其他CPU托管。没有CPU加入检测时取出全部托管回调直接调用。
+ * 检查在锁内进行，与最后一个CPU退出检测互斥，托管回调不会无人接管。
+ * 
+ * @param head 回调链表头，可以为空。
+ * @param tail 回调链表尾结点的后继指针。
+ * 
+ * @return 无返回值。
+ */
+static void rcu_orphan(rcu_head* head,rcu_head** tail)
+{
+    rcu_head* done=null;
+    uintn flags=x86_read_flags();
+    x86_disable_interrupts();
+    spinlock_lock(&orphan_lock);
+    if(head!=null)
+    {
+        *orphan_tail=head;
+        orphan_tail=tail;
+    }
+    if(rcu_all_offline())
+    {
+        done=orphan_head;
+        orphan_head=null;
+        orphan_tail=&orphan_head;
+    }
+    atomic_store_explicit(&orphan_pending,orphan_head!=null,MEMORY_ORDER_RELAXED);
+    spinlock_unlock(&orphan_lock);
+    x86_write_flags(flags);
+    rcu_invoke(done);
+}
+
+/**
+ * 当前CPU接管托管回调，并入等待新宽限期的批次。调用时已关中断。
+ * 
+ * @param cpu 宽限期状态。
+ * 
+ * @return 无返回值。
+ */
+static void rcu_adopt(rcu_cpu* cpu)
+{
+    if(!atomic_load_explicit(&orphan_pending,MEMORY_ORDER_RELAXED))
+    {
+        return;
+    }
+    spinlock_lock(&orphan_lock);
+    if(orphan_head!=null)
+    {
+        *cpu->next_tail=orphan_head;
+        cpu->next_tail=orphan_tail;
+        orphan_head=null;
+        orphan_tail=&orphan_head;
+    }
+    atomic_store_explicit(&orphan_pending,false,MEMORY_ORDER_RELAXED);
+    spinlock_unlock(&orphan_lock);
+}
+
+/**
+ * 当前CPU加入宽限期检测。此后该CPU必须定期调用rcu_quiescent_state，否则宽限期无法结束。
+ * 
+ * @return 无返回值。
+ */
+void rcu_cpu_online(void)
+{
+    rcu_cpu* cpu=rcu_get_cpu();
+    if(cpu==null)
+    {
+        return;
+    }
+    if(cpu->next_tail==null)
+    {
+        cpu->next_head=null;
+        cpu->next_tail=&cpu->next_head;
+        cpu->wait_head=null;
+    }
+    rcu_report(cpu);
+}
+
+/**
+ * 当前CPU退出宽限期检测。用于长时间停机或不再访问受保护数据的CPU，调用时不能处于读临界区。
+ * 尚未调用的回调交给其他CPU，不等待宽限期结束。
+ * 
+ * @return 无返回值。
+ */
+void rcu_cpu_offline(void)
+{
+    rcu_cpu* cpu=rcu_get_cpu();
+    if(cpu==null||atomic_load_explicit(&cpu->quiescent,MEMORY_ORDER_RELAXED)==0)
+    {
+        return;
+    }
+
+    /*退出后不再推进批次，未结束的回调交给其他CPU，在其后开始的宽限期结束后调用，不等待其他CPU*/
+    uintn flags=x86_read_flags();
+    x86_disable_interrupts();
+    rcu_head* head=cpu->next_head;
+    rcu_head** tail=cpu->next_tail;
+    if(cpu->wait_head!=null)
+    {
+        /*等待中的批次排在新回调之前*/
+        rcu_head* last=cpu->wait_head;
+        while(last->next!=null)
+        {
+            last=last->next;
+        }
+        last->next=head;
+        if(head==null)
+        {
+            tail=&last->next;
+        }
+        head=cpu->wait_head;
+    }
+    cpu->wait_head=null;
+    cpu->next_head=null;
+    cpu->next_tail=&cpu->next_head;
+    atomic_store(&cpu->quiescent,0);
+    x86_write_flags(flags);
+    rcu_orphan(head,tail);
+}
+
+/**
+ * 推进CPU的回调批次。调用已结束宽限期的批次，上一批结束后把新回调作为下一批开始新宽限期。
+ * 
+ * @param cpu 宽限期状态。
+ * 
+ * @return 开始了新宽限期返回真。
+ */
+static bool rcu_advance(rcu_cpu* cpu)
+{
+    rcu_head* done=null;
+    bool started=false;
+    uintn flags=x86_read_flags();
+    x86_disable_interrupts();
+    if(cpu->wait_head!=null&&rcu_gp_completed(cpu->wait_gp))
+    {
+        done=cpu->wait_head;
+        cpu->wait_head=null;
+    }
+    rcu_adopt(cpu);
+    if(cpu->wait_head==null&&cpu->next_head!=null)
+    {
+        /*上一批结束后才开始新宽限期，期间提交的回调合并为一批*/
+        cpu->wait_head=cpu->next_head;
+        cpu->next_head=null;
+        cpu->next_tail=&cpu->next_head;
+        cpu->wait_gp=atomic_fetch_add(&gp_current,1)+1;
+        started=true;
+    }
+    x86_write_flags(flags);
+    rcu_invoke(done);
+    return started;
+}
+
+/**
+ * 当前CPU报告经过静止状态，并推进本CPU的回调批次，接管其他CPU留下的回调。在确定不处于读临界区的位置调用，
+ * 目前由kernel_memory_init与kernel_smp_init末尾，以及应用处理器的空闲循环调用。
+ * 
+ * @return 无返回值。
+ */
+void rcu_quiescent_state(void)
+{
+    rcu_cpu* cpu=rcu_get_cpu();
+    if(cpu==null||atomic_load_explicit(&cpu->quiescent,MEMORY_ORDER_RELAXED)==0)
+    {
+        return;
+    }
+    rcu_report(cpu);
+    if(rcu_advance(cpu))
+    {
+        /*调用者仍处于静止状态，对新宽限期再报告一次，其他CPU都已报告时本批立即结束*/
+        rcu_report(cpu);
+        rcu_advance(cpu);
+    }
+}
+
+/**
+ * 提交延迟回调。当前所有读临界区结束后调用，同一宽限期内提交的回调成批处理，由之后的静止状态报告推进。
+ * 当前CPU未加入宽限期检测时交给其他CPU，没有CPU加入检测时直接调用，因此回调不能获取调用者持有的锁。
+ * 
+ * @param head     回调结点。
+ * @param callback 回调函数。
+ * 
+ * @return 无返回值。
+ */
+void call_rcu(rcu_head* head,rcu_callback callback)
+{
+    if(head==null||callback==null)
+    {
+        return;
+    }
+    head->next=null;
+    head->callback=callback;
+
+    rcu_cpu* cpu=rcu_get_cpu();
+    if(cpu==null||atomic_load_explicit(&cpu->quiescent,MEMORY_ORDER_RELAXED)==0)
+    {
+        /*不能同步等待：其他CPU可能正等待调用者，无法经过静止状态*/
+        rcu_orphan(head,&head->next);
+        return;
+    }
+    uintn flags=x86_read_flags();
+    x86_disable_interrupts();
+    *cpu->next_tail=head;
+    cpu->next_tail=&head->next;
+    x86_write_flags(flags);
+}
+
+/**
+ * 等待当前所有读临界区结束。
+ * 
+ * @return 无返回值。
+ */
+void synchronize_rcu(void)
+{
+    uint64 gp=atomic_fetch_add(&gp_current,1)+1;
+    rcu_cpu* cpu=rcu_get_cpu();
+    while(!rcu_gp_completed(gp))
+    {
+        /*调用者自身不在读临界区，报告后只等其他CPU*/
+        if(cpu!=null&&atomic_load_explicit(&cpu->quiescent,MEMORY_ORDER_RELAXED)!=0)
+        {
+            rcu_report(cpu);
+        }
+        x86_cpu_pause();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,640 @@
+/**
+ * 内核多处理器启动。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#include <cpu/apic.h>
+#include <cpu/info.h>
+#include <cpu/per_cpu_vars.h>
+#include <cpu/rcu.h>
+#include <cpu/smp.h>
+#include <init/module.h>
+#include <memory/page.h>
+#include <memory/pool.h>
+#include <memory/ptm.h>
+#include <memory/tlb.h>
+#include <memory/vma.h>
+#include <support/atomic.h>
+#include <support/control.h>
+#include <support/io.h>
+#include <support/memory.h>
+#include <support/util.h>
+
+/**
+ * 蹦床区页数。依次为启动代码页、临时根页表、PML4（仅五级分页）、PDPT与PD，全部位于低1MB。
+ */
+#define SMP_TRAMPOLINE_PAGES 5
+
+/**
+ * 蹦床页内数据区偏移，与smp_trampoline.S一致。
+ */
+const static uintn SMP_TRAMPOLINE_DATA=0x800;
+
+/**
+ * 蹦床区上界。启动中断只能指向低1MB。
+ */
+const static uintn SMP_TRAMPOLINE_LIMIT=SIZE_1MB;
+
+/**
+ * 应用处理器栈页数，与引导处理器启动栈相同。
+ */
+const static uintn SMP_STACK_PAGES=16;
+
+/**
+ * 应用处理器栈线性区下界，与启动栈同在内核区域。
+ */
+const static uintn SMP_STACK_BASE=-4*SIZE_512GB;
+
+/**
+ * 应用处理器栈线性区上界。
+ */
+const static uintn SMP_STACK_LIMIT=-3*SIZE_512GB;
+
+/**
+ * 发送INIT后等待的微秒数。
+ */
+const static uintn SMP_INIT_DELAY=10000;
+
+/**
+ * 发送启动中断后等待的微秒数。
+ */
+const static uintn SMP_STARTUP_DELAY=200;
+
+/**
+ * 就绪屏障最长等待的毫秒数。
+ */
+const static uintn SMP_BOOT_TIMEOUT=1000;
+
+/**
+ * 等待中的处理器每轮空闲清零的页数。
+ */
+const static uintn SMP_IDLE_ZERO_PAGES=8;
+
+/**
+ * 已清零页栈补满或内存不足后，再次尝试清零前的空转轮数。
+ */
+const static uintn SMP_IDLE_BACKOFF=1024;
+
+/**
+ * GDT中第一个TSS描述符下标。前8项为引导GDT固定描述符，其后每个处理器按启动参数处理器数组顺序占两项。
+ */
+const static uintn SMP_TSS_SLOT=8;
+
+/**
+ * 64位可用TSS描述符类型。
+ */
+const static uint64 SMP_TSS_TYPE=0x9;
+
+/**
+ * 临时页表中间项标志，存在且可写。
+ */
+const static uint64 SMP_TABLE_FLAGS=0x3;
+
+/**
+ * 临时页表恒等映射低2MB的大页项，存在、可写且为大页。
+ */
+const static uint64 SMP_LARGE_FLAGS=0x83;
+
+/**
+ * CR4.LA57。
+ */
+const static uintn SMP_CR4_LA57=BIT12;
+
+/**
+ * CR4.PCIDE。只能在长模式下开启，由内存管理模块在应用处理器上设置。
+ */
+const static uintn SMP_CR4_PCIDE=BIT17;
+
+/**
+ * CR4.CET。要求CR0.WP已置位，保护模式下不能先于分页开启。
+ */
+const static uintn SMP_CR4_CET=BIT23;
+
+/**
+ * MSR IA32_PAT的基址。
+ */
+const static uint32 IA32_PAT=0x277;
+
+/**
+ * MSR IA32_EFER的基址。
+ */
+const static uint32 IA32_EFER=0xC0000080;
+
+/**
+ * IA32_EFER.LMA，只读。
+ */
+const static uint64 IA32_EFER_LMA=BIT10;
+
+/**
+ * PIT通道2数据端口。
+ */
+const static uint16 PIT_CHANNEL2=0x42;
+
+/**
+ * PIT命令端口。
+ */
+const static uint16 PIT_COMMAND=0x43;
+
+/**
+ * PIT通道2门控与输出端口。
+ */
+const static uint16 PIT_GATE=0x61;
+
+/**
+ * PIT输入频率。
+ */
+const static uintn PIT_FREQUENCY=1193182;
+
+/**
+ * PIT单次计数最长的微秒数，保证计数不超过16位。
+ */
+const static uintn PIT_MAX_DELAY=50000;
+
+/**
+ * EFI引导服务代码内存类型。
+ */
+const static uint32 EFI_BOOT_SERVICES_CODE=3;
+
+/**
+ * EFI引导服务数据内存类型。
+ */
+const static uint32 EFI_BOOT_SERVICES_DATA=4;
+
+/**
+ * EFI未分配内存类型。
+ */
+const static uint32 EFI_CONVENTIONAL_MEMORY=7;
+
+/**
+ * 蹦床页数据区。偏移与smp_trampoline.S一致，远跳转偏移由模板给出相对页首的值。
+ */
+typedef struct _smp_trampoline_data
+{
+    uint16        gdtr[4];            /*0x00 引导GDT描述符，界限与32位物理基址。*/
+    uint32        protected_entry;    /*0x08 保护模式入口物理地址。*/
+    uint16        protected_selector; /*0x0C 32位代码段选择子。*/
+    uint16        reserved0;          /*0x0E 保留。*/
+    uint32        long_entry;         /*0x10 长模式入口物理地址。*/
+    uint16        long_selector;      /*0x14 64位代码段选择子。*/
+    uint16        reserved1;          /*0x16 保留。*/
+    uint32        cr0;                /*0x18 CR0，写入时开启分页。*/
+    uint32        cr4;                /*0x1C CR4。*/
+    uint32        cr3;                /*0x20 临时根页表物理地址。*/
+    atomic_uint32 ticket;             /*0x24 下一个栈号。*/
+    uint64        efer;               /*0x28 IA32_EFER。*/
+    uint16        kernel_gdtr[8];     /*0x30 内核GDT描述符，界限与64位线性基址。*/
+    uint64        kernel_cr3;         /*0x40 内核页表物理地址。*/
+    uint64        stacks;             /*0x48 栈顶数组线性地址。*/
+    uint64        entry;              /*0x50 内核入口线性地址。*/
+} smp_trampoline_data;
+
+/**
+ * 64位任务状态段。64位字段按32位拆分，避免按自然对齐插入填充。
+ */
+typedef struct _smp_tss
+{
+    uint32 reserved0;    /*保留。*/
+    uint32 rsp[6];       /*RSP0至RSP2，每项低32位在前。*/
+    uint32 reserved1[2]; /*保留。*/
+    uint32 ist[14];      /*IST1至IST7，每项低32位在前。*/
+    uint32 reserved2[2]; /*保留。*/
+    uint16 reserved3;    /*保留。*/
+    uint16 iomap;        /*I/O许可位图偏移，等于段长表示没有位图。*/
+} smp_tss;
+
+/**
+ * 单个CPU的启动状态。
+ */
+typedef struct _smp_cpu
+{
+    alignas(64) smp_tss tss;    /*任务状态段。*/
+    per_cpu_area*       area;   /*每CPU区域。*/
+    uintn               stack;  /*栈顶。*/
+    uintn               slot;   /*GDT中TSS描述符下标，0表示不启动。*/
+    bool                online; /*已上线。*/
+} smp_cpu;
+
+/**
+ * 蹦床启动代码起始。
+ */
+extern const uint8 smp_trampoline_start[];
+
+/**
+ * 蹦床启动代码结束。
+ */
+extern const uint8 smp_trampoline_end[];
+
+/**
+ * 应用处理器内核入口。
+ * 
+ * @return 不再返回。
+ */
+extern void smp_ap_start(void);
+
+/**
+ * 每CPU启动状态。按CPU编号索引。
+ */
+static smp_cpu smp_cpus[CPU_ID_LIMIT];
+
+/**
+ * 按栈号索引的栈顶。应用处理器按到达顺序领取，与CPU编号无关。
+ */
+static uintn smp_stacks[CPU_ID_LIMIT];
+
+/**
+ * GDT线性基址。
+ */
+static uintn gdt_base;
+
+/**
+ * 引导处理器的PAT。应用处理器复位后为默认值，需要与其一致。
+ */
+static uint64 pat;
+
+/**
+ * 已上线CPU数目。
+ */
+static atomic_uintn online;
+
+/**
+ * 到达就绪屏障的应用处理器数目。
+ */
+static atomic_uintn arrived;
+
+/**
+ * 就绪屏障已释放。
+ */
+static atomic_bool released;
+
+/**
+ * 忙等一段时间。尚无中断与校准时钟，用PIT通道2单次计数。
+ * 
+ * @param microseconds 微秒数。
+ * 
+ * @return 无返回值。
+ */
+static void smp_delay(uintn microseconds)
+{
+    uint8 gate=x86_read_port8(PIT_GATE);
+    while(microseconds!=0)
+    {
+        uintn step=min(microseconds,PIT_MAX_DELAY);
+        uintn ticks=max(step*PIT_FREQUENCY/1000000,(uintn)1);
+        /*打开通道2门控并关闭扬声器，方式0计满时OUT2置位*/
+        x86_write_port8(PIT_GATE,(uint8)((gate&~BIT1)|BIT0));
+        x86_write_port8(PIT_COMMAND,0xB0);
+        x86_write_port8(PIT_CHANNEL2,(uint8)ticks);
+        x86_write_port8(PIT_CHANNEL2,(uint8)(ticks>>8));
+        while(!(x86_read_port8(PIT_GATE)&BIT5))
+        {
+            x86_cpu_pause();
+        }
+        microseconds-=step;
+    }
+    x86_write_port8(PIT_GATE,gate);
+}
+
+/**
+ * 在低1MB内查找可放置蹦床区的连续空闲页。伙伴系统不管理低1MB，退出引导服务后的可用内存都能使用。
+ * 
+ * @param params 启动参数。
+ * 
+ * @return 找到返回物理基址，失败返回0。
+ */
+static uintn smp_find_trampoline(aos_boot_params* params)
+{
+    uintn entry=(uintn)params->minfo.memory_map;
+    uintn end=entry+params->minfo.map_length;
+    for(;entry+params->minfo.map_entry_size<=end;entry+=params->minfo.map_entry_size)
+    {
+        aos_efi_memory_descriptor* desc=(aos_efi_memory_descriptor*)entry;
+        if(desc->type!=EFI_CONVENTIONAL_MEMORY&&desc->type!=EFI_BOOT_SERVICES_CODE&&
+            desc->type!=EFI_BOOT_SERVICES_DATA)
+        {
+            continue;
+        }
+
+        /*跳过0号页，其中是实模式中断向量表与BIOS数据区*/
+        uintn base=max(desc->pstart,(uintn)SIZE_4KB);
+        uintn limit=min(desc->pstart+(desc->pages<<12),SMP_TRAMPOLINE_LIMIT);
+        if(base+SMP_TRAMPOLINE_PAGES*SIZE_4KB<=limit)
+        {
+            return base;
+        }
+    }
+    return 0;
+}
+
+/**
+ * 复制启动代码并填写数据区与临时页表。临时根页表共享内核上半部，下半部首项经各级恒等映射低2MB。
+ * 
+ * @param params 启动参数。
+ * @param base   蹦床区物理基址。
+ * 
+ * @return 无返回值。
+ */
+static void smp_build_trampoline(aos_boot_params* params,uintn base)
+{
+    uint8* page=page_address(base);
+    memory_zero(page,SMP_TRAMPOLINE_PAGES*SIZE_4KB);
+    memory_copy(page,smp_trampoline_start,(uintn)(smp_trampoline_end-smp_trampoline_start));
+
+    smp_trampoline_data* data=(smp_trampoline_data*)(page+SMP_TRAMPOLINE_DATA);
+    uintn limit=(params->minfo.fblock_pages[3]<<12)-1;
+    uintn gdt=params->minfo.fblock_paddr[3];
+    /*引导GDT位于低1MB，实模式下按物理地址加载*/
+    data->gdtr[0]=(uint16)limit;
+    data->gdtr[1]=(uint16)gdt;
+    data->gdtr[2]=(uint16)(gdt>>16);
+    data->protected_entry+=(uint32)base;
+    data->long_entry+=(uint32)base;
+    data->cr0=(uint32)x86_read_cr0();
+    data->cr4=(uint32)(x86_read_cr4()&~(SMP_CR4_PCIDE|SMP_CR4_CET));
+    data->cr3=(uint32)(base+SIZE_4KB);
+    atomic_init(&data->ticket,0);
+    data->efer=x86_read_msr(IA32_EFER)&~IA32_EFER_LMA;
+    data->kernel_gdtr[0]=(uint16)limit;
+    for(uintn index=0;index<4;index++)
+    {
+        data->kernel_gdtr[index+1]=(uint16)(gdt_base>>(index<<4));
+    }
+    data->kernel_cr3=x86_read_cr3()&~(uintn)(SIZE_4KB-1);
+    data->stacks=(uint64)smp_stacks;
+    data->entry=(uint64)smp_ap_start;
+
+    /*内核根页表上半部在内存管理模块初始化时已全部建立，复制后不会过时*/
+    uint64* table=(uint64*)(page+SIZE_4KB);
+    uint64* kernel=page_address(data->kernel_cr3);
+    memory_copy(table+256,kernel+256,256*sizeof(uint64));
+    uintn levels=data->cr4&SMP_CR4_LA57?3:2;
+    for(uintn level=0;level<levels;level++)
+    {
+        uintn next=base+(level+2)*SIZE_4KB;
+        table[0]=next|SMP_TABLE_FLAGS;
+        table=page_address(next);
+    }
+    table[0]=SMP_LARGE_FLAGS;
+}
+
+/**
+ * 释放栈映射的物理页。
+ * 
+ * @param run     连续映射段。
+ * @param context 未使用。
+ * 
+ * @return 总是继续遍历。
+ */
+static bool smp_free_stack_run(const ptm_run* run,void* context)
+{
+    (void)context;
+    for(uintn index=0;index<run->pages;index++)
+    {
+        free_page(run->paddr+(index<<12));
+    }
+    return true;
+}
+
+/**
+ * 为应用处理器申请栈。栈下方保留一页不映射的保护页。
+ * 
+ * @return 成功返回栈顶，失败返回0。
+ */
+static uintn smp_alloc_stack(void)
+{
+    uintn guard=vma_find_free(SMP_STACK_PAGES+1,SIZE_4KB,SMP_STACK_BASE,SMP_STACK_LIMIT);
+    if(guard==0||vma_insert(guard,1,VMA_TYPE_RESERVED)==null)
+    {
+        return 0;
+    }
+    uintn base=guard+SIZE_4KB;
+    uint64 flags=VMA_TYPE_MEMORY|VMA_FLAG_READ|VMA_FLAG_WRITE|VMA_FLAG_GLOBAL;
+    if(vma_insert(base,SMP_STACK_PAGES,flags|VMA_FLAG_ALLOCATED)==null)
+    {
+        vma_remove(guard);
+        return 0;
+    }
+
+    for(uintn index=0;index<SMP_STACK_PAGES;index++)
+    {
+        uintn page=alloc_page();
+        if(page!=0&&ptm_map(null,base+(index<<12),page,1,flags))
+        {
+            continue;
+        }
+        if(page!=0)
+        {
+            free_page(page);
+        }
+        ptm_walk(null,base,SMP_STACK_PAGES,smp_free_stack_run,null);
+        ptm_unmap(null,base,SMP_STACK_PAGES);
+        vma_remove(base);
+        vma_remove(guard);
+        return 0;
+    }
+    return base+SMP_STACK_PAGES*SIZE_4KB;
+}
+
+/**
+ * 在GDT中写入当前CPU的TSS描述符并加载任务寄存器。各CPU只写自己的槽位，可以并行执行。
+ * 
+ * @param cpu 启动状态。
+ * 
+ * @return 无返回值。
+ */
+static void smp_load_tss(smp_cpu* cpu)
+{
+    cpu->tss.rsp[0]=(uint32)cpu->stack;
+    cpu->tss.rsp[1]=(uint32)(cpu->stack>>32);
+    cpu->tss.iomap=sizeof(smp_tss);
+
+    uintn tss=(uintn)&cpu->tss;
+    uint64* gdt=(uint64*)gdt_base;
+    gdt[cpu->slot]=(sizeof(smp_tss)-1)|((tss&0xFFFFFF)<<16)|(SMP_TSS_TYPE<<40)|BIT47|(((tss>>24)&0xFF)<<56);
+    gdt[cpu->slot+1]=tss>>32;
+    x86_load_task_register((uint16)(cpu->slot<<3));
+}
+
+/**
+ * 应用处理器C入口。由smp_ap_start在内核页表与领取的栈上调用。
+ * 
+ * @param ticket 栈号。
+ * 
+ * @return 不再返回。
+ */
+noreturn void smp_ap_main(uint32 ticket)
+{
+    /*先安装每CPU区域，此后才能以GS读取CPU编号*/
+    uint32 id=apic_get_id();
+    smp_cpu* cpu=&smp_cpus[id];
+    per_cpu_install(cpu->area,id);
+    x86_write_msr(IA32_PAT,pat);
+    cpu->stack=smp_stacks[ticket];
+    smp_load_tss(cpu);
+    if(!kernel_memory_cpu_init())
+    {
+        /*未加入内存管理模块，不上线，只计入就绪屏障以免引导处理器等到超时*/
+        atomic_fetch_add(&arrived,1);
+        x86_disable_interrupts();
+        while(true)
+        {
+            x86_cpu_halt();
+        }
+    }
+    cpu->online=true;
+    atomic_fetch_add(&online,1);
+    atomic_fetch_add(&arrived,1);
+
+    while(!atomic_load_explicit(&released,MEMORY_ORDER_ACQUIRE))
+    {
+        x86_cpu_pause();
+    }
+    /*尚无中断描述符表，收不到击落中断，只能轮询；内核映射的击落不能推迟，不能以惰性模式停机。
+      空闲循环不处于读临界区，每轮报告静止状态推动宽限期。空闲时为全部处理器预先清零页面*/
+    rcu_cpu_online();
+    uintn backoff=0;
+    while(true)
+    {
+        tlb_poll();
+        rcu_quiescent_state();
+        if(backoff!=0)
+        {
+            backoff--;
+            x86_cpu_pause();
+        }
+        else if(zero_idle_pages(SMP_IDLE_ZERO_PAGES)==0)
+        {
+            backoff=SMP_IDLE_BACKOFF;
+        }
+    }
+}
+
+/**
+ * 通过启动参数启动全部应用处理器。
+ * 
+ * @param params 启动参数。
+ * 
+ * @return 无返回值。
+ */
+static void smp_start(aos_boot_params* params)
+{
+    gdt_base=params->kinfo.gbase;
+    pat=x86_read_msr(IA32_PAT);
+    atomic_init(&online,1);
+    atomic_init(&arrived,0);
+    atomic_init(&released,false);
+
+    /*引导处理器位于处理器数组首项，使用启动栈*/
+    uint32 self=get_current_cpu_id();
+    uintn slots=(params->minfo.fblock_pages[3]<<12)/sizeof(uint64);
+    if(self<CPU_ID_LIMIT)
+    {
+        smp_cpus[self].stack=params->kinfo.sbase+(params->minfo.fblock_pages[4]<<12);
+        smp_cpus[self].slot=SMP_TSS_SLOT;
+        smp_cpus[self].online=true;
+        smp_load_tss(&smp_cpus[self]);
+    }
+    if(params->state.apic==AOS_APIC_NO_APIC||params->cpus_length<=1)
+    {
+        return;
+    }
+    uintn trampoline=smp_find_trampoline(params);
+    if(trampoline==0)
+    {
+        return;
+    }
+
+    /*先准备全部栈与GDT槽位，再统一发送启动中断，使各处理器并行启动*/
+    uint32 targets[CPU_ID_LIMIT];
+    uintn count=0;
+    for(uintn index=1;index<params->cpus_length;index++)
+    {
+        uint32 id=params->cpus[index];
+        uintn slot=SMP_TSS_SLOT+(index<<1);
+        if(id==self||id>=CPU_ID_LIMIT||slot+1>=slots)
+        {
+            continue;
+        }
+        per_cpu_area* area=per_cpu_create_area();
+        if(area==null)
+        {
+            break;
+        }
+        uintn stack=smp_alloc_stack();
+        if(stack==0)
+        {
+            pool_free(area);
+            break;
+        }
+        smp_cpus[id].area=area;
+        smp_cpus[id].slot=slot;
+        smp_stacks[count]=stack;
+        targets[count++]=id;
+    }
+    if(count==0)
+    {
+        return;
+    }
+    smp_build_trampoline(params,trampoline);
+    smp_trampoline_data* data=(smp_trampoline_data*)((uint8*)page_address(trampoline)+SMP_TRAMPOLINE_DATA);
+
+    /*INIT-SIPI-SIPI，第二次启动中断只在仍有处理器未响应时发送*/
+    for(uintn index=0;index<count;index++)
+    {
+        apic_send_init(targets[index]);
+    }
+    smp_delay(SMP_INIT_DELAY);
+    for(uintn pass=0;pass<2&&atomic_load(&data->ticket)<count;pass++)
+    {
+        for(uintn index=0;index<count;index++)
+        {
+            apic_send_startup(targets[index],(uint8)(trampoline>>12));
+        }
+        smp_delay(SMP_STARTUP_DELAY);
+    }
+
+    /*就绪屏障，超时未到达的处理器保留其栈，迟到时仍可安全上线*/
+    for(uintn waited=0;atomic_load(&arrived)<count&&waited<SMP_BOOT_TIMEOUT;waited++)
+    {
+        smp_delay(1000);
+    }
+    atomic_store_explicit(&released,true,MEMORY_ORDER_RELEASE);
+}
+
+/**
+ * 通过启动参数启动全部应用处理器，返回时各处理器均已就绪或超时放弃。在内存管理模块初始化后调用。
+ * 
+ * @param params 启动参数。
+ * 
+ * @return 无返回值。
+ */
+void kernel_smp_init(aos_boot_params* params)
+{
+    smp_start(params);
+    /*启动失败时会移除栈区域，报告静止状态以释放对应结点*/
+    rcu_quiescent_state();
+}
+
+/**
+ * 获取已上线的CPU数目，包括引导处理器。
+ * 
+ * @return 已上线CPU数目。
+ */
+uintn smp_online_count(void)
+{
+    return atomic_load(&online);
+}
+
+/**
+ * 检查CPU是否已上线。
+ * 
+ * @param id CPU编号。
+ * 
+ * @return 已上线返回真。
+ */
+bool smp_is_online(uint32 id)
+{
+    return id<CPU_ID_LIMIT&&smp_cpus[id].online;
+}
\ No newline at end of file
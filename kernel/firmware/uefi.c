@@ -23,12 +23,13 @@ static spinlock lock;
 
 /**
  * 固件恐慌回调。这里主要是手动解锁运行时服务，保证恐慌时能正常使用运行时服务。
+ * 票号锁不能由非持有者解锁，直接重新初始化。
  * 
  * @return 无返回值。
  */
 static void firmware_panic_callback(void)
 {
-    spinlock_unlock(&lock);
+    spinlock_init(&lock);
 }
 
 /**
@@ -0,0 +1,57 @@
+/**
+ * 内核本地APIC操作。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef __AOS_KERNEL_CPU_APIC_H__
+#define __AOS_KERNEL_CPU_APIC_H__
+
+#include <support/type.h>
+
+/**
+ * 从本地APIC读取当前CPU的编号。只在安装每CPU区域前使用，此后以get_current_cpu_id读取。
+ * 
+ * @return 当前CPU编号，APIC未启用时返回0。
+ */
+uint32 apic_get_id(void);
+
+/**
+ * 向指定CPU发送固定模式的处理器间中断。
+ * 
+ * @param id     目标CPU编号。
+ * @param vector 中断向量。
+ * 
+ * @return 无返回值。
+ */
+void apic_send_ipi(uint32 id,uint8 vector);
+
+/**
+ * 向指定CPU发送INIT处理器间中断，使其进入等待启动中断的状态。
+ * 
+ * @param id 目标CPU编号。
+ * 
+ * @return 无返回值。
+ */
+void apic_send_init(uint32 id);
+
+/**
+ * 向指定CPU发送启动处理器间中断。目标从物理地址vector<<12处以实模式开始执行。
+ * 
+ * @param id     目标CPU编号。
+ * @param vector 启动页号，启动代码需位于低1MB内按4KB对齐。
+ * 
+ * @return 无返回值。
+ */
+void apic_send_startup(uint32 id,uint8 vector);
+
+/**
+ * 向本地APIC发送中断结束信号。
+ * 
+ * @return 无返回值。
+ */
+void apic_eoi(void);
+
+#endif /*__AOS_KERNEL_CPU_APIC_H__*/
@@ -9,14 +9,32 @@
 #ifndef __AOS_KERNEL_CPU_INFO_H__
 #define __AOS_KERNEL_CPU_INFO_H__
 
+#include <cpu/per_cpu_vars.h>
 #include <support/type.h>
 
 /**
- * 获取当前运行CPU的编号。
+ * 每CPU数据支持的CPU编号上限。xAPIC编号为8位，覆盖全部xAPIC处理器。
+ */
+#define CPU_ID_LIMIT 256
+
+#ifdef AOS_KERNEL_HOST
+/**
+ * 获取当前运行CPU的编号。宿主机上由宿主程序提供。
  * 
  * @return 当前CPU编号。
  */
 uint32 get_current_cpu_id(void);
+#else
+/**
+ * 获取当前运行CPU的编号。从每CPU区域读取，编译为一条GS相对的mov，不读取MSR或APIC寄存器。
+ * 
+ * @return 当前CPU编号。
+ */
+static inline uint32 get_current_cpu_id(void)
+{
+    return per_cpu_read32(offset_of(per_cpu_area,id));
+}
+#endif /*AOS_KERNEL_HOST*/
 
 /**
  * 获取当前运行CPU的是否是引导处理器。
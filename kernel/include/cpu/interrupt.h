@@ -11,6 +11,9 @@
 
 #include <support/type.h>
 
-
+/**
+ * TLB击落处理器间中断向量。
+ */
+#define INTERRUPT_VECTOR_TLB_SHOOTDOWN 0xFD
 
 #endif /*__AOS_KERNEL_CPU_INTERRUPT_H__*/
\ No newline at end of file
@@ -9,18 +9,45 @@
 #ifndef __AOS_KERNEL_CPU_PER_CPU_VARS_H__
 #define __AOS_KERNEL_CPU_PER_CPU_VARS_H__
 
+#include <support/const.h>
 #include <support/type.h>
+#include <support/util.h>
+
+/**
+ * 每CPU段属性。带该属性的静态对象属于每CPU模板，模板为整个每CPU段，各CPU的区域是它的一份已清零副本。
+ * 通过per_cpu_pointer取得当前CPU的副本，不能直接访问。
+ */
+#define PER_CPU_SECTION __attribute__((section(".percpu")))
+
+/**
+ * GS地址空间。以该限定访问的地址是相对GS基址的偏移，常量偏移的读写编译为一条GS相对的mov。
+ */
+#define PER_CPU_SEGMENT __attribute__((address_space(256)))
 
 /**
  * 每CPU变量。
  */
 typedef enum _per_cpu_variable
 {
-    PER_CPU_PAGE /*每CPU页池*/
+    PER_CPU_PAGE, /*每CPU页池*/
+    PER_CPU_POOL, /*每CPU内存池区域*/
+    PER_CPU_COUNT /*每CPU变量数目*/
 } per_cpu_variable;
 
 /**
- * 获取每CPU变量值。
+ * 每CPU区域头部，位于每CPU段起始。GS基址指向当前CPU的区域，头部字段通过GS相对寻址单条指令访问。
+ */
+typedef struct _per_cpu_area
+{
+    alignas(64) struct _per_cpu_area* self;                /*区域线性地址。*/
+    uint32                            id;                  /*CPU编号。*/
+    uint32                            reserved;            /*保留。*/
+    uint64                            vars[PER_CPU_COUNT]; /*变量值。*/
+} per_cpu_area;
+
+#ifdef AOS_KERNEL_HOST
+/**
+ * 获取每CPU变量值。宿主机上按模拟的CPU编号索引。
  * 
  * @param variable 每CPU变量。
  * 
@@ -29,7 +56,7 @@ typedef enum _per_cpu_variable
 uint64 get_per_cpu_variable(per_cpu_variable variable);
 
 /**
- * 设置每CPU变量值。如果没有初始化该CPU的每CPU变量区域则初始化。
+ * 设置每CPU变量值。宿主机上按模拟的CPU编号索引。
  * 
  * @param variable 每CPU变量。
  * @param value    变量值。
@@ -37,5 +64,125 @@ uint64 get_per_cpu_variable(per_cpu_variable variable);
  * @return 上一次存储的变量值。
  */
 uint64 set_per_cpu_variable(per_cpu_variable variable,uint64 value);
+#else
+/**
+ * 读取当前CPU区域中的64位字段。
+ * 
+ * @param offset 字段在区域中的偏移。
+ * 
+ * @return 字段值。
+ */
+static inline uint64 per_cpu_read64(uintn offset)
+{
+    return *(volatile const PER_CPU_SEGMENT uint64*)offset;
+}
+
+/**
+ * 读取当前CPU区域中的32位字段。
+ * 
+ * @param offset 字段在区域中的偏移。
+ * 
+ * @return 字段值。
+ */
+static inline uint32 per_cpu_read32(uintn offset)
+{
+    return *(volatile const PER_CPU_SEGMENT uint32*)offset;
+}
+
+/**
+ * 写入当前CPU区域中的64位字段。
+ * 
+ * @param offset 字段在区域中的偏移。
+ * @param value  字段值。
+ * 
+ * @return 无返回值。
+ */
+static inline void per_cpu_write64(uintn offset,uint64 value)
+{
+    *(volatile PER_CPU_SEGMENT uint64*)offset=value;
+}
+
+/**
+ * 获取每CPU变量值。
+ * 
+ * @param variable 每CPU变量。
+ * 
+ * @return 变量对应值，无对应返回0。
+ */
+static inline uint64 get_per_cpu_variable(per_cpu_variable variable)
+{
+    if(variable>=PER_CPU_COUNT)
+    {
+        return 0;
+    }
+    return per_cpu_read64(offset_of(per_cpu_area,vars)+variable*sizeof(uint64));
+}
+
+/**
+ * 设置每CPU变量值。
+ * 
+ * @param variable 每CPU变量。
+ * @param value    变量值。
+ * 
+ * @return 上一次存储的变量值。
+ */
+static inline uint64 set_per_cpu_variable(per_cpu_variable variable,uint64 value)
+{
+    if(variable>=PER_CPU_COUNT)
+    {
+        return 0;
+    }
+    uintn offset=offset_of(per_cpu_area,vars)+variable*sizeof(uint64);
+    uint64 old=per_cpu_read64(offset);
+    per_cpu_write64(offset,value);
+    return old;
+}
+
+/**
+ * 获取当前CPU的区域。
+ * 
+ * @return 区域线性地址。
+ */
+static inline per_cpu_area* per_cpu_self(void)
+{
+    return (per_cpu_area*)per_cpu_read64(offset_of(per_cpu_area,self));
+}
+
+/**
+ * 获取每CPU段中对象在当前CPU区域中的副本。
+ * 
+ * @param object 带PER_CPU_SECTION属性的对象。
+ * 
+ * @return 当前CPU的副本。
+ */
+void* per_cpu_pointer(const void* object);
+
+/**
+ * 申请一个已清零的每CPU区域，大小为整个每CPU段。由引导处理器为应用处理器申请。
+ * 
+ * @return 成功返回区域，失败返回空指针。
+ */
+per_cpu_area* per_cpu_create_area(void);
+
+/**
+ * 当前CPU安装每CPU区域，写入GS基址、自指针与CPU编号。每个CPU在访问每CPU变量与CPU编号前调用一次。
+ * 
+ * @param area 区域，空指针表示引导处理器直接使用每CPU段本身。
+ * @param id   CPU编号。
+ * 
+ * @return 成功安装返回真，编号超出范围返回假。
+ */
+bool per_cpu_install(per_cpu_area* area,uint32 id);
+#endif /*AOS_KERNEL_HOST*/
+
+/**
+ * 获取指定CPU的每CPU变量值。用于统计等跨CPU只读场景，读取结果可能已过时。
+ * 
+ * @param id       CPU编号。
+ * @param variable 每CPU变量。
+ * 
+ * @return 变量对应值，无设置或无对应返回0。
+ */
+uint64 get_per_cpu_variable_by_id(uint32 id,per_cpu_variable variable);
 
 #endif /*__AOS_KERNEL_CPU_PER_CPU_VARS_H__*/
\ No newline at end of file
@@ -0,0 +1,107 @@
+/**
+ * 内核读-复制-更新同步。基于静止状态，读者不执行任何原子操作。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef __AOS_KERNEL_CPU_RCU_H__
+#define __AOS_KERNEL_CPU_RCU_H__
+
+#include <support/barrier.h>
+#include <support/type.h>
+
+/**
+ * 延迟回调结点。嵌入在需要延迟释放的对象中。
+ */
+typedef struct _rcu_head rcu_head;
+
+/**
+ * 延迟回调函数。宽限期结束后在提交回调的CPU上调用。
+ * 
+ * @param head 回调结点。
+ * 
+ * @return 无返回值。
+ */
+typedef void (*rcu_callback)(rcu_head* head);
+
+struct _rcu_head
+{
+    rcu_head*    next;     /*后一回调。*/
+    rcu_callback callback; /*回调函数。*/
+};
+
+/**
+ * 发布指针。指向对象的初始化先于指针本身对读者可见。
+ */
+#define rcu_assign_pointer(pointer,value) __atomic_store_n(&(pointer),(value),__ATOMIC_RELEASE)
+
+/**
+ * 读取受保护的指针。在x86上编译为普通加载。
+ */
+#define rcu_dereference(pointer) __atomic_load_n(&(pointer),__ATOMIC_CONSUME)
+
+/**
+ * 进入读临界区。内核不可抢占，读临界区内不经过静止状态即可，只需阻止编译器移动访问。
+ * 读临界区内不能调用rcu_quiescent_state与synchronize_rcu，也不能睡眠。
+ * 
+ * @return 无返回值。
+ */
+static inline void rcu_read_lock(void)
+{
+    compiler_barrier();
+}
+
+/**
+ * 离开读临界区。
+ * 
+ * @return 无返回值。
+ */
+static inline void rcu_read_unlock(void)
+{
+    compiler_barrier();
+}
+
+/**
+ * 当前CPU加入宽限期检测。此后该CPU必须定期调用rcu_quiescent_state，否则宽限期无法结束。
+ * 
+ * @return 无返回值。
+ */
+void rcu_cpu_online(void);
+
+/**
+ * 当前CPU退出宽限期检测。用于长时间停机或不再访问受保护数据的CPU，调用时不能处于读临界区。
+ * 尚未调用的回调交给其他CPU，不等待宽限期结束。
+ * 
+ * @return 无返回值。
+ */
+void rcu_cpu_offline(void);
+
+/**
+ * 当前CPU报告经过静止状态，并推进本CPU的回调批次，接管其他CPU留下的回调。在确定不处于读临界区的位置调用，
+ * 目前由kernel_memory_init与kernel_smp_init末尾，以及应用处理器的空闲循环调用。
+ * 
+ * @return 无返回值。
+ */
+void rcu_quiescent_state(void);
+
+/**
+ * 提交延迟回调。当前所有读临界区结束后调用，同一宽限期内提交的回调成批处理，由之后的静止状态报告推进。
+ * 当前CPU未加入宽限期检测时交给其他CPU，没有CPU加入检测时直接调用，因此回调不能获取调用者持有的锁。
+ * 
+ * @param head     回调结点。
+ * @param callback 回调函数。
+ * 
+ * @return 无返回值。
+ */
+void call_rcu(rcu_head* head,rcu_callback callback);
+
+/**
+ * 等待当前所有读临界区结束。
+ * 
+ * @return 无返回值。
+ */
+void synchronize_rcu(void);
+
+#endif /*__AOS_KERNEL_CPU_RCU_H__*/
\ No newline at end of file
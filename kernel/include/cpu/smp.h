@@ -0,0 +1,30 @@
+/**
+ * 内核多处理器启动。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef __AOS_KERNEL_CPU_SMP_H__
+#define __AOS_KERNEL_CPU_SMP_H__
+
+#include <support/type.h>
+
+/**
+ * 获取已上线的CPU数目，包括引导处理器。
+ * 
+ * @return 已上线CPU数目。
+ */
+uintn smp_online_count(void);
+
+/**
+ * 检查CPU是否已上线。
+ * 
+ * @param id CPU编号。
+ * 
+ * @return 已上线返回真。
+ */
+bool smp_is_online(uint32 id);
+
+#endif /*__AOS_KERNEL_CPU_SMP_H__*/
\ No newline at end of file
@@ -11,6 +11,16 @@
 
 #include "params.h"
 
+/**
+ * 通过启动参数初始化CPU管理模块。引导处理器安装每CPU区域，之后才能读取CPU编号与每CPU变量，并加入宽限期检测。
+ * 在其他模块之前调用。
+ * 
+ * @param params 启动参数。
+ * 
+ * @return 无返回值。
+ */
+void kernel_cpu_init(aos_boot_params* params);
+
 /**
  * 通过启动参数初始化内存管理模块。
  * 
@@ -20,6 +30,23 @@
  */
 void kernel_memory_init(aos_boot_params* params);
 
+/**
+ * 当前CPU加入内存管理模块：启用页表控制位，建立每CPU页池并加入TLB击落。
+ * 应用处理器在使用内核映射前调用一次，引导处理器已在模块初始化时完成。
+ * 
+ * @return 成功加入返回真。失败时该CPU未加入TLB击落，不能再使用内核映射。
+ */
+bool kernel_memory_cpu_init(void);
+
+/**
+ * 通过启动参数启动全部应用处理器，返回时各处理器均已就绪或超时放弃。在内存管理模块初始化后调用。
+ * 
+ * @param params 启动参数。
+ * 
+ * @return 无返回值。
+ */
+void kernel_smp_init(aos_boot_params* params);
+
 /**
  * 通过启动参数初始化固件模块。
  * 
@@ -0,0 +1,85 @@
+/**
+ * 内核物理页管理。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef __AOS_KERNEL_MEMORY_PAGE_H__
+#define __AOS_KERNEL_MEMORY_PAGE_H__
+
+#include <support/type.h>
+
+/**
+ * 2MB大页阶数。
+ */
+#define PAGE_ORDER_2MB 9
+
+/**
+ * 1GB大页阶数。
+ */
+#define PAGE_ORDER_1GB 18
+
+/**
+ * 申请一块4kB物理页。优先从当前CPU的每CPU页池取出，快速路径不获取伙伴系统锁。
+ * 
+ * @return 申请成功返回页面物理基址，申请失败返回0。
+ */
+uintn alloc_page(void);
+
+/**
+ * 释放一块4kB物理页。优先放回当前CPU的每CPU页池，快速路径不获取伙伴系统锁。
+ * 
+ * @param base 页面物理基址。
+ * 
+ * @return 无返回值。
+ */
+void free_page(uintn base);
+
+/**
+ * 申请一块已清零的4kB物理页。优先取出空闲时清零好的页面，没有时同步清零。
+ * 
+ * @return 申请成功返回页面物理基址，申请失败返回0。
+ */
+uintn alloc_zeroed_page(void);
+
+/**
+ * 在空闲时清零页面，补充全部CPU共用的已清零页栈。由空闲CPU调用，目前是等待中的应用处理器。
+ * 
+ * @param budget 本次最多清零的页数。
+ * 
+ * @return 实际清零的页数。
+ */
+uintn zero_idle_pages(uintn budget);
+
+/**
+ * 申请一块物理大页。大页由整页块组成，物理基址按大页大小对齐，可以直接用大页映射。
+ * 1GB大页只在启动参数特性含AOS_FEATURES_PAGE1GB时才能映射为1GB页。
+ * 
+ * @param order 大页阶数，只接受PAGE_ORDER_2MB与PAGE_ORDER_1GB。
+ * 
+ * @return 申请成功返回大页物理基址，申请失败返回0。
+ */
+uintn alloc_huge_page(uintn order);
+
+/**
+ * 释放一块物理大页。
+ * 
+ * @param base  大页物理基址。
+ * @param order 申请时的大页阶数。
+ * 
+ * @return 无返回值。
+ */
+void free_huge_page(uintn base,uintn order);
+
+/**
+ * 获取物理地址在直接映射区中的线性地址。启动阶段已建立全部物理内存的直接映射，包括伙伴系统不管理的低1MB。
+ * 
+ * @param base 物理地址。
+ * 
+ * @return 线性地址。
+ */
+void* page_address(uintn base);
+
+#endif /*__AOS_KERNEL_MEMORY_PAGE_H__*/
@@ -20,6 +20,16 @@
  */
 void* pool_alloc(uintn size);
 
+/**
+ * 申请一块按指定对齐的内核内存池的内存。
+ * 
+ * @param size  申请大小。
+ * @param align 对齐要求，必须是2的幂。
+ * 
+ * @return 成功申请返回一个非空指针。
+ */
+void* pool_alloc_aligned(uintn size,uintn align);
+
 /**
  * 释放一块内核内存池的内存。
  * 
@@ -29,4 +39,11 @@ void* pool_alloc(uintn size);
  */
 void pool_free(void* ptr);
 
+/**
+ * 代为回收全部CPU内存池的远程释放链表，并把各内存池中完全空闲的扩展块全部归还页管理器。正被使用的内存池跳过。
+ * 
+ * @return 归还的页数。
+ */
+uintn pool_trim(void);
+
 #endif /*__AOS_KERNEL_MEMORY_POOL_H__*/
\ No newline at end of file
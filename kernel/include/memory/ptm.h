@@ -0,0 +1,136 @@
+/**
+ * 内核页表管理系统。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef __AOS_KERNEL_MEMORY_PTM_H__
+#define __AOS_KERNEL_MEMORY_PTM_H__
+
+#include <memory/tlb.h>
+#include <support/handle.h>
+#include <support/type.h>
+
+/**
+ * 用户地址空间。上半部共享内核页表，下半部独立映射。
+ */
+typedef struct _ptm_space
+{
+    uintn     root; /*根页表物理地址。*/
+    uint64    id;   /*地址空间编号，从不复用。*/
+    tlb_space tlb;  /*TLB跟踪信息。*/
+} ptm_space;
+
+/**
+ * 页表遍历报告的连续映射段。线性与物理地址都连续，页大小与标志组相同。
+ */
+typedef struct _ptm_run
+{
+    uintn  vaddr; /*线性起始地址。*/
+    uintn  paddr; /*物理起始地址。*/
+    uintn  pages; /*4KB页数。*/
+    uintn  size;  /*页大小，4KB、2MB或1GB。*/
+    uint64 flags; /*VMA标志组，包括权限与内存类型。*/
+} ptm_run;
+
+/**
+ * 页表遍历访问函数。
+ * 
+ * @param run     连续映射段。
+ * @param context 访问函数上下文。
+ * 
+ * @return 继续遍历返回真，停止遍历返回假。
+ */
+typedef bool (*ptm_visitor)(const ptm_run* run,void* context);
+
+/**
+ * 创建用户地址空间。根页表上半部复制内核根页表项。
+ * 
+ * @return 成功创建返回地址空间，失败返回空指针。
+ */
+ptm_space* ptm_space_create(void);
+
+/**
+ * 销毁用户地址空间，解除下半部全部映射并回收页表页。调用时不能有CPU正在使用它。
+ * 
+ * @param space 地址空间。
+ * 
+ * @return 无返回值。
+ */
+void ptm_space_destroy(ptm_space* space);
+
+/**
+ * 当前CPU切换到地址空间。启用PCID时每个CPU为最近使用的地址空间保留PCID，
+ * 切换回来时若映射代数未变则保留其TLB，否则只刷新该PCID。
+ * 
+ * @param space 地址空间，空指针表示只使用内核地址空间。
+ * 
+ * @return 无返回值。
+ */
+void ptm_space_switch(ptm_space* space);
+
+/**
+ * 在页表中建立映射。对齐允许时自动使用2MB与1GB大页，已有映射会被覆盖。
+ * 
+ * @param space 地址空间，空指针表示内核地址空间。用户地址空间只能映射下半部。
+ * @param vaddr 线性起始地址，需按4KB对齐。
+ * @param paddr 物理起始地址，需按4KB对齐。
+ * @param pages 页数。
+ * @param flags VMA标志组，决定权限与内存类型。
+ * 
+ * @return 成功映射返回真。失败时范围内映射全部解除。
+ */
+bool ptm_map(ptm_space* space,uintn vaddr,uintn paddr,uintn pages,uint64 flags);
+
+/**
+ * 解除页表中的映射。只覆盖部分大页时会先拆分大页。
+ * 
+ * @param space 地址空间，空指针表示内核地址空间。
+ * @param vaddr 线性起始地址，需按4KB对齐。
+ * @param pages 页数。
+ * 
+ * @return 成功解除返回真，拆分大页内存不足返回假。
+ */
+bool ptm_unmap(ptm_space* space,uintn vaddr,uintn pages);
+
+/**
+ * 修改页表中已有映射的权限与内存类型，未映射的部分保持不变。
+ * 
+ * @param space 地址空间，空指针表示内核地址空间。
+ * @param vaddr 线性起始地址，需按4KB对齐。
+ * @param pages 页数。
+ * @param flags VMA标志组。
+ * 
+ * @return 成功修改返回真。
+ */
+bool ptm_protect(ptm_space* space,uintn vaddr,uintn pages,uint64 flags);
+
+/**
+ * 遍历页表中的映射，按连续段报告。线性与物理地址都连续且页大小与标志组相同的叶项合并为一段，
+ * 非规范地址空洞自动跳过。遍历不持有页表锁，访问函数不能睡眠。
+ * 
+ * @param space   地址空间，空指针表示内核地址空间。用户地址空间只遍历下半部。
+ * @param vaddr   线性起始地址，需按4KB对齐。
+ * @param pages   页数。
+ * @param visitor 访问函数。
+ * @param context 访问函数上下文。
+ * 
+ * @return 遍历完成返回真，参数不合法或访问函数要求停止返回假。
+ */
+bool ptm_walk(ptm_space* space,uintn vaddr,uintn pages,ptm_visitor visitor,void* context);
+
+/**
+ * 输出页表中的映射，每个连续段一行。可在恐慌路径与测试中使用。
+ * 
+ * @param handle 输入输出句柄。要求其可写能力。
+ * @param space  地址空间，空指针表示内核地址空间。
+ * @param vaddr  线性起始地址，需按4KB对齐。
+ * @param pages  页数。
+ * 
+ * @return 无返回值。
+ */
+void ptm_dump(io_handle* handle,ptm_space* space,uintn vaddr,uintn pages);
+
+#endif /*__AOS_KERNEL_MEMORY_PTM_H__*/
\ No newline at end of file
@@ -0,0 +1,58 @@
+/**
+ * 内核低内存回收管理。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef __AOS_KERNEL_MEMORY_RECLAIM_H__
+#define __AOS_KERNEL_MEMORY_RECLAIM_H__
+
+#include <support/type.h>
+
+/**
+ * 低内存回调函数。物理页不足时调用，回调应释放自身缓存的空闲内存。
+ * 
+ * @return 归还页管理器的页数。
+ */
+typedef uintn (*low_memory_callback)(void);
+
+/**
+ * 低内存回调结点。
+ */
+typedef struct _low_memory_callback_node low_memory_callback_node;
+
+struct _low_memory_callback_node
+{
+    low_memory_callback_node* prev;     /*前一结点。*/
+    low_memory_callback_node* next;     /*后一结点。*/
+    low_memory_callback       callback; /*回调函数。*/
+};
+
+/**
+ * 注册一个低内存回调函数。
+ * 
+ * @param node 低内存回调结点。结点内存应该由各模块提供稳定内存区域。
+ * 
+ * @return 无返回值。
+ */
+void register_low_memory_callback(low_memory_callback_node* node);
+
+/**
+ * 注销一个低内存回调函数。
+ * 
+ * @param node 低内存回调结点。结点内存应该由各模块提供稳定内存区域。
+ * 
+ * @return 无返回值。
+ */
+void unregister_low_memory_callback(low_memory_callback_node* node);
+
+/**
+ * 依次调用所有低内存回调回收内存。其他CPU正在回收时直接返回。
+ * 
+ * @return 回收的总页数。
+ */
+uintn memory_reclaim(void);
+
+#endif /*__AOS_KERNEL_MEMORY_RECLAIM_H__*/
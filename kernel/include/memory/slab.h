@@ -0,0 +1,87 @@
+/**
+ * 内核对象缓存分配器。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef __AOS_KERNEL_MEMORY_SLAB_H__
+#define __AOS_KERNEL_MEMORY_SLAB_H__
+
+#include <support/type.h>
+
+/**
+ * 对象缓存。
+ */
+typedef struct _slab_cache slab_cache;
+
+/**
+ * 对象构造函数。对象所在板块建立时对每个对象调用一次，之后对象保持构造状态在缓存中循环使用。
+ * 
+ * @param object 对象指针。
+ * 
+ * @return 无返回值。
+ */
+typedef void (*slab_constructor)(void* object);
+
+/**
+ * 创建一个对象缓存。
+ * 
+ * @param name  缓存名称。
+ * @param size  对象大小。
+ * @param align 对象对齐，0表示按8字节对齐。
+ * @param ctor  对象构造函数，可为空。
+ * 
+ * @return 成功创建返回缓存，失败返回空指针。
+ */
+slab_cache* slab_cache_create(const char* name,uintn size,uintn align,slab_constructor ctor);
+
+/**
+ * 销毁一个对象缓存。调用者需保证缓存中对象已全部释放。
+ * 
+ * @param cache 对象缓存。
+ * 
+ * @return 无返回值。
+ */
+void slab_cache_destroy(slab_cache* cache);
+
+/**
+ * 从对象缓存申请一个对象。
+ * 
+ * @param cache 对象缓存。
+ * 
+ * @return 成功申请返回对象指针，失败返回空指针。
+ */
+void* slab_cache_alloc(slab_cache* cache);
+
+/**
+ * 向对象缓存释放一个对象。对象应处于构造状态。
+ * 
+ * @param cache  对象缓存。
+ * @param object 对象指针。
+ * 
+ * @return 无返回值。
+ */
+void slab_cache_free(slab_cache* cache,void* object);
+
+/**
+ * 按大小类申请一块内存。16至2048字节由对象缓存提供，更大的请求转交内核内存池。
+ * 
+ * @param size 申请大小。
+ * 
+ * @return 成功申请返回一个非空指针。
+ */
+void* slab_alloc(uintn size);
+
+/**
+ * 按大小类释放一块内存。
+ * 
+ * @param ptr  申请内存指针基址。
+ * @param size 申请时的大小。
+ * 
+ * @return 无返回值。
+ */
+void slab_free(void* ptr,uintn size);
+
+#endif /*__AOS_KERNEL_MEMORY_SLAB_H__*/
@@ -0,0 +1,23 @@
+/**
+ * 内核内存分配器统计。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef __AOS_KERNEL_MEMORY_STATS_H__
+#define __AOS_KERNEL_MEMORY_STATS_H__
+
+#include <support/handle.h>
+
+/**
+ * 输出全部内存分配器统计：伙伴系统各区各阶空闲块、每CPU页池、内存池各区域以及对象缓存。
+ * 
+ * @param handle 输入输出句柄。要求其可写能力。
+ * 
+ * @return 无返回值。
+ */
+void memory_dump_stats(io_handle* handle);
+
+#endif /*__AOS_KERNEL_MEMORY_STATS_H__*/
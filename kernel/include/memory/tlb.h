@@ -0,0 +1,111 @@
+/**
+ * 内核跨CPU TLB击落。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef __AOS_KERNEL_MEMORY_TLB_H__
+#define __AOS_KERNEL_MEMORY_TLB_H__
+
+#include <cpu/info.h>
+#include <support/atomic.h>
+
+/**
+ * 活跃CPU掩码字数。
+ */
+#define TLB_SPACE_WORDS (CPU_ID_LIMIT/64)
+
+/**
+ * 地址空间的TLB跟踪信息。记录当前装载该地址空间页表的CPU，击落只发往这些CPU。
+ * 每次击落递增代数，不在活跃掩码中的CPU切换回来时据此判断PCID下的残留TLB是否过期。
+ */
+typedef struct _tlb_space
+{
+    atomic_uint64 active[TLB_SPACE_WORDS]; /*活跃CPU掩码。*/
+    atomic_uint64 generation;              /*映射代数。*/
+} tlb_space;
+
+/**
+ * 初始化地址空间的TLB跟踪信息。
+ * 
+ * @param space 地址空间。
+ * 
+ * @return 无返回值。
+ */
+void tlb_space_init(tlb_space* space);
+
+/**
+ * 当前CPU开始使用地址空间。先加入活跃掩码再读代数，此后的击落必然发到当前CPU，
+ * 代数与上次记录相同说明切出期间没有错过刷新。
+ * 
+ * @param space 地址空间。
+ * 
+ * @return 加入时的映射代数。
+ */
+uint64 tlb_space_activate(tlb_space* space);
+
+/**
+ * 当前CPU停止使用地址空间。
+ * 
+ * @param space 地址空间。
+ * 
+ * @return 无返回值。
+ */
+void tlb_space_deactivate(tlb_space* space);
+
+/**
+ * 刷新当前CPU的全部TLB。
+ * 
+ * @param global 为真时一并刷新全局页与全部PCID，否则只刷新当前PCID的非全局页。
+ * 
+ * @return 无返回值。
+ */
+void tlb_flush_all(bool global);
+
+/**
+ * 让地址空间在其他活跃CPU上的一段线性范围TLB失效，返回时全部目标已完成刷新。
+ * 对同一CPU的并发请求合并为一个范围，只发送一次中断；用户地址空间的击落不打断处于惰性TLB模式的CPU，
+ * 改为在退出惰性模式时整体刷新。内核地址空间的击落与释放页表页的击落总是发送中断。
+ * 当前CPU的TLB由调用者自行刷新。
+ * 
+ * @param space  地址空间，空指针表示内核地址空间，即全部在线CPU。
+ * @param start  范围起始地址。
+ * @param end    范围结束地址，不包含在范围内。
+ * @param global 范围内含全局页。
+ * @param tables 击落后将释放页表页。
+ * 
+ * @return 无返回值。
+ */
+void tlb_shootdown(tlb_space* space,uintn start,uintn end,bool global,bool tables);
+
+/**
+ * 当前CPU进入惰性TLB模式。空闲等不访问用户映射的场景调用，期间不再接收用户地址空间的击落中断。
+ * 
+ * @return 无返回值。
+ */
+void tlb_enter_lazy(void);
+
+/**
+ * 当前CPU退出惰性TLB模式。惰性期间错过的刷新在此补做。
+ * 
+ * @return 无返回值。
+ */
+void tlb_leave_lazy(void);
+
+/**
+ * 处理发给当前CPU的击落请求。供不能接收击落中断的CPU在等待循环中轮询调用。
+ * 
+ * @return 无返回值。
+ */
+void tlb_poll(void);
+
+/**
+ * TLB击落中断处理。由INTERRUPT_VECTOR_TLB_SHOOTDOWN向量的中断入口调用。
+ * 
+ * @return 无返回值。
+ */
+void tlb_shootdown_interrupt(void);
+
+#endif /*__AOS_KERNEL_MEMORY_TLB_H__*/
@@ -9,7 +9,9 @@
 #ifndef __AOS_KERNEL_MEMORY_VMA_H__
 #define __AOS_KERNEL_MEMORY_VMA_H__
 
+#include <cpu/rcu.h>
 #include <support/const.h>
+#include <support/type.h>
 
 /**
  * VMA类型掩码。
@@ -72,4 +74,81 @@
  */
 #define VMA_FLAG_HUGEPAGE BIT13
 
+/**
+ * 已分配标志。表示该区域已分配实际页面。
+ */
+#define VMA_FLAG_ALLOCATED BIT14
+
+/**
+ * 线性区域。以起始地址为键组织成红黑树，每个节点记录与前一区域之间的空隙，
+ * 并维护子树内的最大空隙，使查找空闲范围不必遍历全部区域。
+ */
+typedef struct _vma_node vma_node;
+
+struct _vma_node
+{
+    vma_node* parent;  /*父节点。*/
+    vma_node* left;    /*左子节点。*/
+    vma_node* right;   /*右子节点。*/
+    uintn     start;   /*起始地址。*/
+    uintn     end;     /*结束地址，不包含在区域内。*/
+    uint64    flags;   /*区域标志。*/
+    uintn     gap;     /*与前一区域之间的空隙大小。*/
+    uintn     max_gap; /*子树内最大空隙大小。*/
+    bool      red;     /*节点为红色。*/
+    rcu_head  rcu;     /*移除后延迟释放。*/
+};
+
+/**
+ * 查找包含地址的线性区域。无锁查找，返回的区域只在调用者的读临界区内有效。
+ * 
+ * @param vaddr 线性地址。
+ * 
+ * @return 找到返回区域，否则返回空指针。
+ */
+const vma_node* vma_find(uintn vaddr);
+
+/**
+ * 检查一段范围是否与已有线性区域重叠。
+ * 
+ * @param vaddr 起始地址。
+ * @param pages 页数。
+ * 
+ * @return 存在重叠或范围非法返回真。
+ */
+bool vma_overlaps(uintn vaddr,uintn pages);
+
+/**
+ * 插入一个线性区域。
+ * 
+ * @param vaddr 起始地址，需按4KB对齐。
+ * @param pages 页数。
+ * @param flags 区域标志。
+ * 
+ * @return 成功插入返回区域，范围重叠或内存不足返回空指针。
+ */
+const vma_node* vma_insert(uintn vaddr,uintn pages,uint64 flags);
+
+/**
+ * 移除起始于给定地址的线性区域。
+ * 
+ * @param vaddr 起始地址。
+ * 
+ * @return 成功移除返回真。
+ */
+bool vma_remove(uintn vaddr);
+
+/**
+ * 在范围内查找满足对齐要求的空闲线性范围。优先取第一个不小于长度加对齐余量的空隙中最低的可用地址，
+ * 没有这样的空隙时取恰好放得下的最低地址。
+ * 
+ * @param pages 页数。
+ * @param align 对齐，需为不小于4KB的2的幂。
+ * @param low   范围下界。
+ * @param high  范围上界，不包含在范围内。
+ * 
+ * @return 成功找到返回起始地址，失败返回0。
+ */
+uintn vma_find_free(uintn pages,uintn align,uintn low,uintn high);
+
 #endif /*__AOS_KERNEL_MEMORY_VMA_H__*/
\ No newline at end of file
@@ -60,7 +60,7 @@ void register_panic_callback_before(panic_callback_node* node,panic_callback_nod
 void register_panic_callback_after(panic_callback_node* node,panic_callback_node* prev);
 
 /**
- * 注销一个恐慌回调函数。
+ * 注销一个恐慌回调函数。等待宽限期结束，返回后结点可以复用，不能在读临界区内调用。
  * 
  * @param node 恐慌回调结点。结点内存应该由各模块提供稳定内存区域。
  * 
@@ -44,7 +44,7 @@ struct _panic_output_node
 void register_panic_output(panic_output_node* node);
 
 /**
- * 注销一个恐慌输出函数。
+ * 注销一个恐慌输出函数。等待宽限期结束，返回后结点可以复用，不能在读临界区内调用。
  * 
  * @param node 恐慌输出结点。结点内存应该由各模块提供稳定内存区域。
  * 
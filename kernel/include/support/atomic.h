@@ -24,6 +24,37 @@ typedef enum memory_order
     MEMORY_ORDER_SEQ_CST=__ATOMIC_SEQ_CST  /*顺序一致性。*/
 } memory_order;
 
+#ifndef __clang__
+/*GCC没有clang的__c11_atomic内建函数，供宿主机程序以GCC构建时改用__atomic内建函数，取最值以比较交换循环实现*/
+#define __c11_atomic_init(object,value) __atomic_store_n(object,value,__ATOMIC_RELAXED)
+#define __c11_atomic_thread_fence(order) __atomic_thread_fence(order)
+#define __c11_atomic_signal_fence(order) __atomic_signal_fence(order)
+#define __c11_atomic_is_lock_free(size) __atomic_is_lock_free(size,0)
+#define __c11_atomic_store(object,desired,order) __atomic_store_n(object,desired,order)
+#define __c11_atomic_load(object,order) __atomic_load_n(object,order)
+#define __c11_atomic_exchange(object,desired,order) __atomic_exchange_n(object,desired,order)
+#define __c11_atomic_compare_exchange_strong(object,expected,desired,success,failure) \
+    __atomic_compare_exchange_n(object,expected,desired,false,success,failure)
+#define __c11_atomic_compare_exchange_weak(object,expected,desired,success,failure) \
+    __atomic_compare_exchange_n(object,expected,desired,true,success,failure)
+#define __c11_atomic_fetch_add(object,operand,order) __atomic_fetch_add(object,operand,order)
+#define __c11_atomic_fetch_sub(object,operand,order) __atomic_fetch_sub(object,operand,order)
+#define __c11_atomic_fetch_or(object,operand,order) __atomic_fetch_or(object,operand,order)
+#define __c11_atomic_fetch_xor(object,operand,order) __atomic_fetch_xor(object,operand,order)
+#define __c11_atomic_fetch_and(object,operand,order) __atomic_fetch_and(object,operand,order)
+#define __c11_atomic_fetch_nand(object,operand,order) __atomic_fetch_nand(object,operand,order)
+#define __c11_atomic_fetch_max(object,operand,order) __extension__({\
+    __typeof__(__atomic_load_n(object,__ATOMIC_RELAXED)) __old=__atomic_load_n(object,__ATOMIC_RELAXED);\
+    __typeof__(__old) __new=(operand);\
+    while(__old<__new&&!__atomic_compare_exchange_n(object,&__old,__new,true,order,__ATOMIC_RELAXED)){}\
+    __old;})
+#define __c11_atomic_fetch_min(object,operand,order) __extension__({\
+    __typeof__(__atomic_load_n(object,__ATOMIC_RELAXED)) __old=__atomic_load_n(object,__ATOMIC_RELAXED);\
+    __typeof__(__old) __new=(operand);\
+    while(__old>__new&&!__atomic_compare_exchange_n(object,&__old,__new,true,order,__ATOMIC_RELAXED)){}\
+    __old;})
+#endif /*__clang__*/
+
 /**
  * 有符号8位整型。
  */
@@ -52,4 +52,43 @@ static inline void x86_flush_all_global_tlbs(void)
     __asm__ volatile("mov %0,%%cr4"::"r"(cr4));
 }
 
+/**
+ * INVPCID刷新单个PCID内的单个地址。
+ */
+#define X86_INVPCID_ADDRESS 0
+
+/**
+ * INVPCID刷新单个PCID的全部非全局条目。
+ */
+#define X86_INVPCID_CONTEXT 1
+
+/**
+ * INVPCID刷新全部PCID的全部条目，包括全局条目。
+ */
+#define X86_INVPCID_ALL_GLOBAL 2
+
+/**
+ * INVPCID刷新全部PCID的全部非全局条目。
+ */
+#define X86_INVPCID_ALL 3
+
+/**
+ * 按PCID刷新TLB条目。需要CPU支持INVPCID。
+ * 
+ * @param type  刷新类型。
+ * @param pcid  PCID。
+ * @param vaddr 线性地址，仅单地址刷新有效。
+ * 
+ * @return 无返回值。
+ */
+static inline void x86_invpcid(uintn type,uint64 pcid,uintn vaddr)
+{
+    struct
+    {
+        uint64 pcid;
+        uint64 vaddr;
+    } descriptor={pcid,vaddr};
+    __asm__ volatile("invpcid %0,%1"::"m"(descriptor),"r"(type):"memory");
+}
+
 #endif /*__AOS_KERNEL_SUPPORT_CACHE_H__*/
\ No newline at end of file
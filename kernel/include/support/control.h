@@ -50,4 +50,76 @@ static inline void x86_cpu_halt(void)
     __asm__ volatile("hlt":::"memory");
 }
 
+/**
+ * 读取CR0。
+ * 
+ * @return CR0的值。
+ */
+static inline uintn x86_read_cr0(void)
+{
+    uintn cr0;
+    __asm__ volatile("mov %%cr0,%0":"=r"(cr0)::"memory");
+    return cr0;
+}
+
+/**
+ * 读取CR3。
+ * 
+ * @return CR3的值。
+ */
+static inline uintn x86_read_cr3(void)
+{
+    uintn cr3;
+    __asm__ volatile("mov %%cr3,%0":"=r"(cr3)::"memory");
+    return cr3;
+}
+
+/**
+ * 写入CR3。启用PCID时最高位置位表示不刷新该PCID的TLB条目。
+ * 
+ * @param cr3 待写入CR3的值。
+ * 
+ * @return 无返回值。
+ */
+static inline void x86_write_cr3(uintn cr3)
+{
+    __asm__ volatile("mov %0,%%cr3"::"r"(cr3):"memory");
+}
+
+/**
+ * 读取CR4。
+ * 
+ * @return CR4的值。
+ */
+static inline uintn x86_read_cr4(void)
+{
+    uintn cr4;
+    __asm__ volatile("mov %%cr4,%0":"=r"(cr4)::"memory");
+    return cr4;
+}
+
+/**
+ * 写入CR4。
+ * 
+ * @param cr4 待写入CR4的值。
+ * 
+ * @return 无返回值。
+ */
+static inline void x86_write_cr4(uintn cr4)
+{
+    __asm__ volatile("mov %0,%%cr4"::"r"(cr4):"memory");
+}
+
+/**
+ * 加载任务寄存器。
+ * 
+ * @param selector TSS描述符选择子。
+ * 
+ * @return 无返回值。
+ */
+static inline void x86_load_task_register(uint16 selector)
+{
+    __asm__ volatile("ltr %0"::"r"(selector):"memory");
+}
+
 #endif /*__AOS_KERNEL_SUPPORT_CONTROL_H__*/
\ No newline at end of file
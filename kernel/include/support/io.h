@@ -38,6 +38,18 @@ static inline void x86_write_msr(uint32 index,uint64 value)
     __asm__ volatile("wrmsr"::"a"(value&UINT32_MAX),"d"(value>>32),"c"(index));
 }
 
+/**
+ * 读取时间戳计数器。
+ * 
+ * @return 时间戳计数器的值。
+ */
+static inline uint64 x86_read_tsc(void)
+{
+    uint32 low,high;
+    __asm__ volatile("rdtsc":"=a"(low),"=d"(high)::"memory");
+    return ((uint64)high<<32)|low;
+}
+
 /**
  * 读取标志寄存器。
  * 
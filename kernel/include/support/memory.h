@@ -79,4 +79,15 @@ static inline void* memory_zero(void* m,uintn n)
     return memory_set(m,0,n);
 }
 
+/**
+ * 以非临时存储将内存m前n个字节设置成0。写入绕过缓存，不会挤出缓存中的热数据，
+ * 适合清零短期内不会访问的大块内存。返回前已完成存储围栏。
+ * 
+ * @param m 内存m。
+ * @param n 操作字节数。
+ * 
+ * @return 返回内存m的起始地址，便于进行链式处理。
+ */
+void* memory_zero_nontemporal(void* m,uintn n);
+
 #endif /*__AOS_KERNEL_SUPPORT_MEMORY_H__*/
\ No newline at end of file
@@ -11,14 +11,70 @@
 
 #include "atomic.h"
 
+#ifdef AOS_KERNEL_LOCK_STATS
 /**
- * 自旋锁。
+ * 锁统计。只由持有者更新，读取时使用宽松加载，结果可能已过时。定义AOS_KERNEL_LOCK_STATS时启用。
+ */
+typedef struct _lock_stats
+{
+    atomic_uint64 acquires;    /*加锁次数。*/
+    atomic_uint64 contentions; /*需要等待的加锁次数。*/
+    atomic_uint64 wait_cycles; /*等待总周期。*/
+    atomic_uint64 hold_cycles; /*持有总周期。*/
+    atomic_uint64 hold_max;    /*最长持有周期。*/
+    uint64        hold_start;  /*本次持有起点。*/
+} lock_stats;
+#endif /*AOS_KERNEL_LOCK_STATS*/
+
+/**
+ * 自旋锁。票号锁，按申请顺序获得锁，全部零值即为未上锁状态。
  */
 typedef struct _spinlock
 {
-    atomic_flag flag; /*标志。*/
+    atomic_uint32 next;  /*下一个发放的票号。*/
+    atomic_uint32 owner; /*正在服务的票号。*/
+#ifdef AOS_KERNEL_LOCK_STATS
+    lock_stats    stats; /*锁统计。*/
+#endif /*AOS_KERNEL_LOCK_STATS*/
 } spinlock;
 
+/**
+ * MCS队列锁结点。由加锁者提供，从加锁到解锁期间保持有效，等待者只在自己结点所在缓存行上自旋。
+ */
+typedef struct _mcs_node
+{
+    alignas(64) _Atomic(struct _mcs_node*) next; /*后继等待者。*/
+    atomic_bool                            wait; /*等待标志，前驱解锁时清除。*/
+} mcs_node;
+
+/**
+ * MCS队列锁。按申请顺序获得锁，适合多CPU激烈竞争的锁，全部零值即为未上锁状态。
+ */
+typedef struct _mcs_lock
+{
+    _Atomic(mcs_node*) tail;  /*队尾结点。*/
+#ifdef AOS_KERNEL_LOCK_STATS
+    lock_stats         stats; /*锁统计。*/
+#endif /*AOS_KERNEL_LOCK_STATS*/
+} mcs_lock;
+
+/**
+ * 读写锁。写者优先：有写者等待时新读者不再进入，全部零值即为未上锁状态。
+ */
+typedef struct _rwlock
+{
+    atomic_uint32 state; /*状态。低两位为写者持有与写者等待标志，其余位为读者数目。*/
+} rwlock;
+
+/**
+ * 顺序锁。读者不写共享缓存行，读取后发现期间有写入则重试，适合读多写少且可以重读的小块数据。
+ */
+typedef struct _seqlock
+{
+    atomic_uint32 sequence; /*序号。奇数表示写入中。*/
+    spinlock      lock;     /*写者互斥锁。*/
+} seqlock;
+
 /**
  * 自旋锁初始化。
  * 
@@ -51,8 +107,156 @@ bool spinlock_try_lock(spinlock* lock);
  * 
  * @param lock 自旋锁。
  * 
- * @return 成功上锁返回真。
+ * @return 无返回值。
  */
 void spinlock_unlock(spinlock* lock);
 
+/**
+ * MCS队列锁初始化。
+ * 
+ * @param lock MCS队列锁。
+ * 
+ * @return 无返回值。
+ */
+void mcs_lock_init(mcs_lock* lock);
+
+/**
+ * MCS队列锁阻塞加锁。
+ * 
+ * @param lock MCS队列锁。
+ * @param node 加锁者结点。
+ * 
+ * @return 无返回值。
+ */
+void mcs_lock_lock(mcs_lock* lock,mcs_node* node);
+
+/**
+ * MCS队列锁尝试加锁。
+ * 
+ * @param lock MCS队列锁。
+ * @param node 加锁者结点。
+ * 
+ * @return 成功上锁返回真。
+ */
+bool mcs_lock_try_lock(mcs_lock* lock,mcs_node* node);
+
+/**
+ * MCS队列锁解锁。
+ * 
+ * @param lock MCS队列锁。
+ * @param node 加锁时使用的结点。
+ * 
+ * @return 无返回值。
+ */
+void mcs_lock_unlock(mcs_lock* lock,mcs_node* node);
+
+/**
+ * 读写锁初始化。
+ * 
+ * @param lock 读写锁。
+ * 
+ * @return 无返回值。
+ */
+void rwlock_init(rwlock* lock);
+
+/**
+ * 读写锁阻塞加读锁。
+ * 
+ * @param lock 读写锁。
+ * 
+ * @return 无返回值。
+ */
+void rwlock_read_lock(rwlock* lock);
+
+/**
+ * 读写锁尝试加读锁。
+ * 
+ * @param lock 读写锁。
+ * 
+ * @return 成功上锁返回真。
+ */
+bool rwlock_read_try_lock(rwlock* lock);
+
+/**
+ * 读写锁解读锁。
+ * 
+ * @param lock 读写锁。
+ * 
+ * @return 无返回值。
+ */
+void rwlock_read_unlock(rwlock* lock);
+
+/**
+ * 读写锁阻塞加写锁。
+ * 
+ * @param lock 读写锁。
+ * 
+ * @return 无返回值。
+ */
+void rwlock_write_lock(rwlock* lock);
+
+/**
+ * 读写锁尝试加写锁。
+ * 
+ * @param lock 读写锁。
+ * 
+ * @return 成功上锁返回真。
+ */
+bool rwlock_write_try_lock(rwlock* lock);
+
+/**
+ * 读写锁解写锁。
+ * 
+ * @param lock 读写锁。
+ * 
+ * @return 无返回值。
+ */
+void rwlock_write_unlock(rwlock* lock);
+
+/**
+ * 顺序锁初始化。
+ * 
+ * @param lock 顺序锁。
+ * 
+ * @return 无返回值。
+ */
+void seqlock_init(seqlock* lock);
+
+/**
+ * 顺序锁开始读取。等待进行中的写入结束。
+ * 
+ * @param lock 顺序锁。
+ * 
+ * @return 读取开始时的序号，交给seqlock_read_retry检查。
+ */
+uint32 seqlock_read_begin(seqlock* lock);
+
+/**
+ * 顺序锁检查读取是否需要重试。读到的数据只有在返回假后才能使用。
+ * 
+ * @param lock     顺序锁。
+ * @param sequence seqlock_read_begin返回的序号。
+ * 
+ * @return 读取期间有写入返回真。
+ */
+bool seqlock_read_retry(seqlock* lock,uint32 sequence);
+
+/**
+ * 顺序锁开始写入。
+ * 
+ * @param lock 顺序锁。
+ * 
+ * @return 无返回值。
+ */
+void seqlock_write_lock(seqlock* lock);
+
+/**
+ * 顺序锁结束写入。
+ * 
+ * @param lock 顺序锁。
+ * 
+ * @return 无返回值。
+ */
+void seqlock_write_unlock(seqlock* lock);
+
 #endif /*__AOS_KERNEL_SUPPORT_SYNC_H__*/
\ No newline at end of file
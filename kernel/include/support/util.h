@@ -11,6 +11,30 @@
 
 #include "const.h"
 
+#ifndef __clang__
+/*GCC没有clang的位反向、循环移位与泛型位计数内建函数，供宿主机程序以GCC构建时改用移位与定宽内建函数实现*/
+#define __builtin_bitreverse8(value) ((uint8)(__builtin_bitreverse64((uint64)(value))>>56))
+#define __builtin_bitreverse16(value) ((uint16)(__builtin_bitreverse64((uint64)(value))>>48))
+#define __builtin_bitreverse32(value) ((uint32)(__builtin_bitreverse64((uint64)(value))>>32))
+#define __builtin_bitreverse64(value) __extension__({\
+    uint64 __value=(value);\
+    __value=((__value>>1)&0x5555555555555555ULL)|((__value&0x5555555555555555ULL)<<1);\
+    __value=((__value>>2)&0x3333333333333333ULL)|((__value&0x3333333333333333ULL)<<2);\
+    __value=((__value>>4)&0x0F0F0F0F0F0F0F0FULL)|((__value&0x0F0F0F0F0F0F0F0FULL)<<4);\
+    __builtin_bswap64(__value);})
+#define __builtin_rotateleft8(value,bits) ((uint8)(((value)<<((bits)&7))|((value)>>((-(bits))&7))))
+#define __builtin_rotateleft16(value,bits) ((uint16)(((value)<<((bits)&15))|((value)>>((-(bits))&15))))
+#define __builtin_rotateleft32(value,bits) ((uint32)(((value)<<((bits)&31))|((value)>>((-(bits))&31))))
+#define __builtin_rotateleft64(value,bits) ((uint64)(((value)<<((bits)&63))|((value)>>((-(bits))&63))))
+#define __builtin_rotateright8(value,bits) ((uint8)(((value)>>((bits)&7))|((value)<<((-(bits))&7))))
+#define __builtin_rotateright16(value,bits) ((uint16)(((value)>>((bits)&15))|((value)<<((-(bits))&15))))
+#define __builtin_rotateright32(value,bits) ((uint32)(((value)>>((bits)&31))|((value)<<((-(bits))&31))))
+#define __builtin_rotateright64(value,bits) ((uint64)(((value)>>((bits)&63))|((value)<<((-(bits))&63))))
+#define __builtin_popcountg(value) __builtin_popcountll((uint64)(value))
+#define __builtin_clzg(value) (__builtin_clzll((uint64)(value))-(int)(64-8*sizeof(value)))
+#define __builtin_ctzg(value) __builtin_ctzll((uint64)(value))
+#endif /*__clang__*/
+
 /**
  * 取绝对值。
  */
@@ -0,0 +1,150 @@
+/**
+ * 内核内存分配器基准测试集。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef __AOS_KERNEL_TEST_BENCH_BENCH_H__
+#define __AOS_KERNEL_TEST_BENCH_BENCH_H__
+
+#include <support/type.h>
+
+/**
+ * 申请操作。
+ */
+#define BENCH_OP_ALLOC 0
+
+/**
+ * 释放操作。
+ */
+#define BENCH_OP_FREE 1
+
+/**
+ * 轨迹操作。申请与释放通过槽号配对，释放操作的大小无意义。
+ */
+typedef struct _bench_op
+{
+    uint8  kind; /*操作类型。*/
+    uint8  cpu;  /*执行操作的CPU编号。*/
+    uint16 rsvd; /*保留。*/
+    uint32 slot; /*槽号。*/
+    uint64 size; /*申请大小，单位由运行的分配器决定。*/
+} bench_op;
+
+/**
+ * 分配轨迹。
+ */
+typedef struct _bench_trace
+{
+    const char* name;  /*轨迹名称。*/
+    bench_op*   ops;   /*操作数组。*/
+    uintn       count; /*操作数目。*/
+    uintn       slots; /*槽数目。*/
+} bench_trace;
+
+/**
+ * 生成均匀分布轨迹。活跃对象数在上限附近随机申请释放，大小在区间内均匀分布。
+ * 
+ * @param trace 分配轨迹。
+ * @param count 申请次数。
+ * @param live  活跃对象上限。
+ * @param min   最小申请大小。
+ * @param max   最大申请大小。
+ * @param seed  随机种子。
+ * 
+ * @return 成功生成返回真。
+ */
+bool bench_trace_uniform(bench_trace* trace,uintn count,uintn live,uint64 min,uint64 max,uint64 seed);
+
+/**
+ * 生成幂律分布轨迹。大小按2的幂分档，档位概率随大小减半，档内均匀分布。
+ * 
+ * @param trace 分配轨迹。
+ * @param count 申请次数。
+ * @param live  活跃对象上限。
+ * @param min   最小申请大小。
+ * @param max   最大申请大小。
+ * @param seed  随机种子。
+ * 
+ * @return 成功生成返回真。
+ */
+bool bench_trace_power_law(bench_trace* trace,uintn count,uintn live,uint64 min,uint64 max,uint64 seed);
+
+/**
+ * 生成生产者消费者轨迹。CPU0批量申请，CPU1批量释放，覆盖跨CPU释放路径。
+ * 
+ * @param trace 分配轨迹。
+ * @param count 申请次数。
+ * @param batch 每批对象数。
+ * @param min   最小申请大小。
+ * @param max   最大申请大小。
+ * @param seed  随机种子。
+ * 
+ * @return 成功生成返回真。
+ */
+bool bench_trace_producer_consumer(bench_trace* trace,uintn count,uintn batch,uint64 min,uint64 max,uint64 seed);
+
+/**
+ * 读取记录的轨迹文件。每行一个操作：“a 槽号 大小 [CPU]”或“f 槽号 [CPU]”，以#开头的行为注释。
+ * 
+ * @param trace 分配轨迹。
+ * @param path  文件路径。
+ * 
+ * @return 成功读取返回真。
+ */
+bool bench_trace_load(bench_trace* trace,const char* path);
+
+/**
+ * 释放轨迹占用的内存。
+ * 
+ * @param trace 分配轨迹。
+ * 
+ * @return 无返回值。
+ */
+void bench_trace_release(bench_trace* trace);
+
+/**
+ * 向宿主机申请一段按页对齐、零初始化的内存，页面在首次访问时才真正提交。
+ * 
+ * @param size 内存大小。
+ * 
+ * @return 成功申请返回基址，失败返回空指针。
+ */
+void* bench_host_map(uintn size);
+
+/**
+ * 向宿主机释放一段内存。
+ * 
+ * @param base 内存基址。
+ * @param size 内存大小。
+ * 
+ * @return 无返回值。
+ */
+void bench_host_unmap(void* base,uintn size);
+
+/**
+ * 获取宿主机单调时钟。
+ * 
+ * @return 纳秒数。
+ */
+uint64 bench_host_clock(void);
+
+/**
+ * 获取进程常驻内存峰值。
+ * 
+ * @return 字节数，无法获取返回0。
+ */
+uintn bench_host_peak_rss(void);
+
+/**
+ * 切换模拟的当前CPU。
+ * 
+ * @param id CPU编号。
+ * 
+ * @return 无返回值。
+ */
+void bench_host_set_cpu(uint32 id);
+
+#endif /*__AOS_KERNEL_TEST_BENCH_BENCH_H__*/
\ No newline at end of file
@@ -0,0 +1,41 @@
+/**
+ * 内核宿主机测试宿主机接口。
+ * @date 2026-10-18
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef __AOS_KERNEL_TEST_HOST_HOST_H__
+#define __AOS_KERNEL_TEST_HOST_HOST_H__
+
+#include <support/type.h>
+
+/**
+ * 宿主机线程数上限。
+ */
+#define HOST_THREAD_LIMIT 16
+
+/**
+ * 宿主机线程入口。
+ */
+typedef void (*host_thread_routine)(uintn index);
+
+/**
+ * 启动若干宿主机线程并等待全部结束。全部线程就绪后才同时进入入口，使它们确实相互竞争。
+ * 
+ * @param count   线程数，不超过HOST_THREAD_LIMIT。
+ * @param routine 线程入口，参数为线程序号。
+ * 
+ * @return 全部线程成功启动返回真。
+ */
+bool host_thread_run(uintn count,host_thread_routine routine);
+
+/**
+ * 获取宿主机在线处理器数。线程数超过处理器数时，持锁线程被换出会使公平锁的全部等待者各空转一个时间片。
+ * 
+ * @return 处理器数，至少为1。
+ */
+uintn host_cpu_count(void);
+
+#endif /*__AOS_KERNEL_TEST_HOST_HOST_H__*/
\ No newline at end of file
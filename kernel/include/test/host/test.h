@@ -0,0 +1,29 @@
+/**
+ * 内核宿主机测试集。
+ * @date 2026-10-18
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef __AOS_KERNEL_TEST_HOST_TEST_H__
+#define __AOS_KERNEL_TEST_HOST_TEST_H__
+
+#include <test/host/host.h>
+#include <test/utest.h>
+
+/**
+ * 线性区域管理测试。
+ * 
+ * @return 失败测试数。
+ */
+int32 vma_test(void);
+
+/**
+ * 同步原语测试。
+ * 
+ * @return 失败测试数。
+ */
+int32 sync_test(void);
+
+#endif /*__AOS_KERNEL_TEST_HOST_TEST_H__*/
\ No newline at end of file
@@ -7,9 +7,15 @@
  * SPDX-License-Identifier: MIT
  */
 #include <init/params.h>
-#include <memory/pool.h>
+#include <memory/page.h>
+#include <memory/reclaim.h>
+#include <support/format.h>
+#include <support/memory.h>
+#include <support/sync.h>
 #include <support/util.h>
 
+#include "memoryi.h"
+
 /**
  * EFI内存类型。
  */
@@ -44,45 +50,64 @@ typedef enum _efi_memory_type
 const static uintn BUDDY_MEMORY_BOUNDARY=SIZE_4GB;
 
 /**
- * 伙伴系统结点。
+ * 保留的低端内存大小。低1MB留给应用处理器启动代码等实模式数据，不交给伙伴系统管理。
  */
-typedef struct _buddy_node buddy_node;
+const static uintn BUDDY_RESERVED_LOW=SIZE_1MB;
 
-struct _buddy_node
-{
-    buddy_node* next; /*下一结点。*/
-    uintn       base; /*页框基址。*/
-};
+/**
+ * 伙伴系统阶数上限。
+ */
+const static uintn BUDDY_MAX_ORDER=52;
 
 /**
- * 伙伴系统元数据。
+ * 空页框号。
  */
-typedef struct _buddy_meta
-{
-    uint64      low_bitmap;  /*低区位图。*/
-    uint64      high_bitmap; /*高区位图。*/
-    buddy_node* low[52];     /*低区空闲链表。*/
-    buddy_node* high[52];    /*高区空闲链表。*/
-} buddy_meta;
+const static uint32 BUDDY_NULL_FRAME=UINT32_MAX;
 
 /**
- * 伙伴系统结点池。
+ * 页块阶数。页块为2MB，是迁移类型分组的单位，同一页块内的小块只属于一种迁移类型。
  */
-typedef struct _buddy_node_pool buddy_node_pool;
+const static uintn BUDDY_PAGEBLOCK_ORDER=9;
 
-struct _buddy_node_pool
+/**
+ * 整块认领阶数。借用其他迁移类型不低于该阶的空闲块时，把所在页块整体转为申请的迁移类型，
+ * 避免两种类型在同一页块内长期混杂。
+ */
+const static uintn BUDDY_CLAIM_ORDER=5;
+
+/**
+ * 伙伴系统区。空闲链表存放块首页框号，链接信息保存在页框描述符内。
+ * 低于页块阶数的空闲块按所在页块的迁移类型分链；不低于页块阶数的空闲块由整页块组成，
+ * 不区分迁移类型，统一记在不可移动类型下，切割到页块以下时才确定类型。
+ */
+typedef struct _buddy_zone
 {
-    buddy_node_pool* next;       /*下一池。*/
-    uint32           count;      /*空闲结点数量。*/
-    uint32           first;      /*第一个空闲结点索引。*/
-    uint8            bitmap[32]; /*位图。*/
-    buddy_node       node[253];  /*结点。*/
-};
+    uint64 bitmap[2];    /*各迁移类型位图。*/
+    uint32 lists[2][52]; /*各迁移类型空闲链表。*/
+    uint32 count[52];    /*各阶空闲块数。*/
+} buddy_zone;
+
+_Static_assert(sizeof(page_frame)==AOS_FRAME_DESCRIPTOR_SIZE,"Page frame descriptor size mismatch.");
+
+/**
+ * 伙伴系统低区与高区，按页框区编号索引。
+ */
+static buddy_zone zones[2];
+
+/**
+ * 页框描述符数组。
+ */
+static page_frame* frames=null;
+
+/**
+ * 页框描述符数目。
+ */
+static uintn frame_count=0;
 
 /**
- * 当前伙伴系统。
+ * 伙伴系统锁。
  */
-static buddy_meta buddy;
+static spinlock lock;
 
 /**
  * 当前初始化状态。
@@ -90,41 +115,247 @@ static buddy_meta buddy;
 static bool init_state=false;
 
 /**
- * 将结点推入到伙伴系统栈。
+ * 将块首页框推入到伙伴系统链表。
+ * 
+ * @param head  链表头。
+ * @param index 页框号。
+ * 
+ * @return 无返回值。
+ */
+static inline void buddy_list_push(uint32* head,uint32 index)
+{
+    frames[index].prev=BUDDY_NULL_FRAME;
+    frames[index].next=*head;
+    if(*head!=BUDDY_NULL_FRAME)
+    {
+        frames[*head].prev=index;
+    }
+    *head=index;
+}
+
+/**
+ * 将块首页框从伙伴系统链表中删除。
+ * 
+ * @param head  链表头。
+ * @param index 页框号。
+ * 
+ * @return 无返回值。
+ */
+static inline void buddy_list_remove(uint32* head,uint32 index)
+{
+    page_frame* frame=&frames[index];
+    if(frame->prev!=BUDDY_NULL_FRAME)
+    {
+        frames[frame->prev].next=frame->next;
+    }
+    else
+    {
+        *head=frame->next;
+    }
+    if(frame->next!=BUDDY_NULL_FRAME)
+    {
+        frames[frame->next].prev=frame->prev;
+    }
+}
+
+/**
+ * 判断块基址所在区是否为高区。
+ * 
+ * @param base 块基址。
+ * 
+ * @return 高区返回真。
+ */
+static inline bool buddy_is_high(uintn base)
+{
+    return base>=BUDDY_MEMORY_BOUNDARY;
+}
+
+/**
+ * 获取页框所在页块的首页框号。
+ * 
+ * @param index 页框号。
+ * 
+ * @return 页块首页框号。
+ */
+static inline uintn buddy_pageblock(uintn index)
+{
+    return index&~(((uintn)BIT0<<BUDDY_PAGEBLOCK_ORDER)-1);
+}
+
+/**
+ * 获取空闲块所在链表的迁移类型。
+ * 
+ * @param index 块首页框号。
+ * @param order 块阶数。
+ * 
+ * @return 迁移类型。不低于页块阶数的块返回不可移动类型。
+ */
+static inline uintn buddy_block_type(uintn index,uintn order)
+{
+    if(order>=BUDDY_PAGEBLOCK_ORDER)
+    {
+        return PAGE_TYPE_UNMOVABLE;
+    }
+    return (frames[buddy_pageblock(index)].flags&PAGE_FRAME_MOVABLE)?PAGE_TYPE_MOVABLE:PAGE_TYPE_UNMOVABLE;
+}
+
+/**
+ * 设置页框所在页块的迁移类型。
  * 
- * @param head 链表头。
- * @param node 链表结点。
+ * @param index 页框号。
+ * @param type  迁移类型。
  * 
  * @return 无返回值。
  */
-static inline void buddy_list_push(buddy_node** head,buddy_node* node)
+static inline void buddy_set_pageblock_type(uintn index,uintn type)
 {
-    if(*head!=null)
+    page_frame* frame=&frames[buddy_pageblock(index)];
+    if(type==PAGE_TYPE_MOVABLE)
     {
-        node->next=*head;
+        frame->flags|=PAGE_FRAME_MOVABLE;
     }
     else
     {
-        node->next=null;
+        frame->flags&=~PAGE_FRAME_MOVABLE;
     }
-    *head=node;
 }
 
 /**
- * 将结点从伙伴系统链表中推出。
+ * 把空闲块挂入区内指定迁移类型的链表，并更新位图与计数。
+ * 
+ * @param zone  伙伴系统区。
+ * @param type  迁移类型。
+ * @param index 块首页框号。
+ * @param order 块阶数。
+ * 
+ * @return 无返回值。
+ */
+static void buddy_link(buddy_zone* zone,uintn type,uint32 index,uintn order)
+{
+    buddy_list_push(&zone->lists[type][order],index);
+    zone->bitmap[type]|=(uint64)BIT0<<order;
+    zone->count[order]++;
+}
+
+/**
+ * 把空闲块从区内指定迁移类型的链表摘下，并更新位图与计数。
  * 
- * @param head 链表头。
+ * @param zone  伙伴系统区。
+ * @param type  迁移类型。
+ * @param index 块首页框号。
+ * @param order 块阶数。
  * 
- * @return 一个结点。
+ * @return 无返回值。
  */
-static inline buddy_node* buddy_list_pop(buddy_node** head)
+static void buddy_unlink(buddy_zone* zone,uintn type,uint32 index,uintn order)
 {
-    buddy_node* result=*head;
-    if(*head!=null)
+    buddy_list_remove(&zone->lists[type][order],index);
+    zone->count[order]--;
+    if(zone->lists[type][order]==BUDDY_NULL_FRAME)
     {
-        *head=result->next;
+        zone->bitmap[type]&=UINT64_MAX^((uint64)BIT0<<order);
     }
-    return result;
+}
+
+/**
+ * 将空闲块放入空闲链表，并更新对应区位图。链表由块所在区与迁移类型决定。
+ * 
+ * @param index 块首页框号。
+ * @param order 块阶数。
+ * 
+ * @return 无返回值。
+ */
+static void buddy_insert(uint32 index,uintn order)
+{
+    page_frame* frame=&frames[index];
+    uint8 zone=buddy_is_high((uintn)index<<12)?PAGE_ZONE_HIGH:PAGE_ZONE_LOW;
+    frame->order=(uint8)order;
+    frame->zone=zone;
+    frame->flags|=PAGE_FRAME_FREE;
+    buddy_link(&zones[zone],buddy_block_type(index,order),index,order);
+}
+
+/**
+ * 将空闲块移出空闲链表，并更新对应区位图。
+ * 
+ * @param index 块首页框号。
+ * 
+ * @return 无返回值。
+ */
+static void buddy_take(uint32 index)
+{
+    page_frame* frame=&frames[index];
+    frame->flags&=~PAGE_FRAME_FREE;
+    buddy_unlink(&zones[frame->zone],buddy_block_type(index,frame->order),index,frame->order);
+}
+
+/**
+ * 把页块整体转为给定迁移类型，页块内现有空闲块一并移到新类型的链表。
+ * 
+ * @param zone  伙伴系统区。
+ * @param index 页块内任一页框号。
+ * @param type  迁移类型。
+ * 
+ * @return 无返回值。
+ */
+static void buddy_claim_pageblock(buddy_zone* zone,uintn index,uintn type)
+{
+    uintn start=buddy_pageblock(index);
+    uintn end=min(start+((uintn)BIT0<<BUDDY_PAGEBLOCK_ORDER),frame_count);
+    uintn old=buddy_block_type(start,0);
+    if(old==type)
+    {
+        return;
+    }
+
+    uintn current=start;
+    while(current<end)
+    {
+        page_frame* frame=&frames[current];
+        if(frame->flags&PAGE_FRAME_FREE)
+        {
+            buddy_unlink(zone,old,(uint32)current,frame->order);
+            buddy_link(zone,type,(uint32)current,frame->order);
+            current+=(uintn)BIT0<<frame->order;
+        }
+        else
+        {
+            current++;
+        }
+    }
+    buddy_set_pageblock_type(start,type);
+}
+
+/**
+ * 释放一个对齐的块，并与空闲的伙伴块合并。合并不会跨越低区与高区的边界。
+ * 
+ * @param base  块基址。
+ * @param order 块阶数。
+ * 
+ * @return 无返回值。
+ */
+static void buddy_release(uintn base,uintn order)
+{
+    uintn index=base>>12;
+    while(order+1<BUDDY_MAX_ORDER)
+    {
+        uintn merged=index&~(((uintn)BIT0<<(order+1))-1);
+        if(!buddy_is_high(merged<<12)&&(merged<<12)+((uintn)SIZE_4KB<<(order+1))>BUDDY_MEMORY_BOUNDARY)
+        {
+            break;
+        }
+
+        /*伙伴块首页框号直接由位运算得到*/
+        uintn other=index^((uintn)BIT0<<order);
+        if(other>=frame_count||!(frames[other].flags&PAGE_FRAME_FREE)||frames[other].order!=order)
+        {
+            break;
+        }
+        buddy_take((uint32)other);
+        index=merged;
+        order++;
+    }
+    buddy_insert((uint32)index,order);
 }
 
 /**
@@ -133,30 +364,90 @@ static inline buddy_node* buddy_list_pop(buddy_node** head)
  * @param base  页框基址。
  * @param pages 页框页数。
  * 
- * @return 成功返回0，未成功返回未放回页数。
+ * @return 无返回值。
  */
-static uintn buddy_spilt(uintn base,uintn pages)
+static void buddy_spilt(uintn base,uintn pages)
 {
     while(pages>0)
     {
-        uintn exp=count_trailing_zeros(base)-12;
-        uintn block=1<<exp;
-        while(block>pages)
+        uintn exp=min(count_trailing_zeros(base)-12,BUDDY_MAX_ORDER-1);
+        while(((uint64)BIT0<<exp)>pages||
+            (!buddy_is_high(base)&&base+((uintn)SIZE_4KB<<exp)>BUDDY_MEMORY_BOUNDARY))
         {
             exp--;
-            block=1<<exp;
         }
-        buddy_node* node=pool_alloc(sizeof(buddy_node));
-        if(node==null)
+        buddy_release(base,exp);
+        base+=(uintn)SIZE_4KB<<exp;
+        pages-=(uint64)BIT0<<exp;
+    }
+}
+
+/**
+ * 从给定区取出一块不小于给定阶数的空闲块，并切割到给定阶数。
+ * 查找顺序为同类型页块内的小块、整页块组成的大块，最后借用另一类型的最大小块。
+ * 
+ * @param zone  伙伴系统区。
+ * @param order 块阶数。
+ * @param type  迁移类型。
+ * 
+ * @return 成功返回块基址，失败返回最大值。
+ */
+static uintn buddy_take_order(buddy_zone* zone,uintn order,uintn type)
+{
+    /*一次计数即可找到不小于目标阶数的最小非空链表*/
+    uint64 small=(((uint64)BIT0<<BUDDY_PAGEBLOCK_ORDER)-1)&(UINT64_MAX<<order);
+    uintn index=count_trailing_zeros(zone->bitmap[type]&small);
+    if(index>=BUDDY_MAX_ORDER)
+    {
+        index=count_trailing_zeros(zone->bitmap[PAGE_TYPE_UNMOVABLE]&~small&(UINT64_MAX<<order));
+    }
+    if(index>=BUDDY_MAX_ORDER)
+    {
+        /*借用另一类型时取最大块，减少被混入的页块数*/
+        uintn other=type^1;
+        uint64 bitmap=zone->bitmap[other]&small;
+        if(bitmap==0)
         {
-            break;
+            return UINTN_MAX;
+        }
+        index=63-count_leading_zeros(bitmap);
+        if(index>=BUDDY_CLAIM_ORDER)
+        {
+            buddy_claim_pageblock(zone,zone->lists[other][index],type);
+        }
+        else
+        {
+            type=other;
         }
-        node->base=base;
-        buddy_list_push(base>=BUDDY_MEMORY_BOUNDARY?&buddy.high[exp]:&buddy.low[exp],node);
-        base+=block<<12;
-        pages-=block;
     }
-    return pages;
+
+    uint32 head=zone->lists[index<BUDDY_PAGEBLOCK_ORDER?type:PAGE_TYPE_UNMOVABLE][index];
+    buddy_take(head);
+    if(index>=BUDDY_PAGEBLOCK_ORDER&&order<BUDDY_PAGEBLOCK_ORDER)
+    {
+        /*整页块切割到页块以下，页块归属申请的迁移类型*/
+        buddy_set_pageblock_type(head,type);
+    }
+    while(index>order)
+    {
+        index--;
+        buddy_insert(head+((uint32)BIT0<<index),index);
+    }
+    frames[head].order=(uint8)order;
+    return (uintn)head<<12;
+}
+
+/**
+ * 计算页数对应的块阶数。
+ * 
+ * @param pages 页数。
+ * 
+ * @return 块阶数。
+ */
+static inline uintn buddy_get_order(uintn pages)
+{
+    /*直接计算出最近2的幂指数*/
+    return pages<=1?0:sizeof(uintn)*8-count_leading_zeros(pages-1);
 }
 
 /**
@@ -164,37 +455,339 @@ static uintn buddy_spilt(uintn base,uintn pages)
  * 
  * @param params 启动参数。
  * 
- * @return 无返回值。
+ * @return 成功初始化返回真。
  */
 bool memory_buddy_init(aos_boot_params* params)
 {
-    return false;
+    if(init_state||params==null||params->minfo.memory_map==null||params->minfo.map_entry_size==0||
+        params->kinfo.fbase==0||params->minfo.frames==0||params->minfo.frames>UINT32_MAX)
+    {
+        return false;
+    }
+    else
+    {
+        init_state=true;
+    }
+    for(uintn zone=0;zone<2;zone++)
+    {
+        memory_set(zones[zone].lists,UINT8_MAX,sizeof(zones[zone].lists));
+        zones[zone].bitmap[PAGE_TYPE_UNMOVABLE]=0;
+        zones[zone].bitmap[PAGE_TYPE_MOVABLE]=0;
+        memory_zero(zones[zone].count,sizeof(zones[zone].count));
+    }
+    spinlock_init(&lock);
+
+    /*所有页框先视为保留，随后只有可用内存块会放回伙伴系统*/
+    frames=(page_frame*)params->kinfo.fbase;
+    frame_count=params->minfo.frames;
+    memory_zero(frames,frame_count*sizeof(page_frame));
+
+    uintn entry=(uintn)params->minfo.memory_map;
+    uintn end=entry+params->minfo.map_length;
+    for(;entry+params->minfo.map_entry_size<=end;entry+=params->minfo.map_entry_size)
+    {
+        aos_efi_memory_descriptor* desc=(aos_efi_memory_descriptor*)entry;
+        switch(desc->type)
+        {
+            case EFI_CONVENTIONAL_MEMORY:
+            case EFI_BOOT_SERVICES_CODE:
+            case EFI_BOOT_SERVICES_DATA:
+                break;
+            default:
+                continue;
+        }
+
+        uintn base=desc->pstart;
+        uintn limit=min(desc->pstart+(desc->pages<<12),(frame_count<<12));
+        if(base<BUDDY_RESERVED_LOW)
+        {
+            base=BUDDY_RESERVED_LOW;
+        }
+        if(base<limit)
+        {
+            buddy_spilt(base,(limit-base)>>12);
+        }
+    }
+    return true;
+}
+
+/**
+ * 获取物理地址对应的页框描述符。
+ * 
+ * @param base 物理地址。
+ * 
+ * @return 页框描述符。超出范围返回空指针。
+ */
+page_frame* buddy_get_frame(uintn base)
+{
+    return (base>>12)<frame_count?&frames[base>>12]:null;
 }
 
 /**
- * 从伙伴系统申请页面。
+ * 按迁移类型申请页面。优先使用高区，高区无法满足时才使用低区。
  * 
  * @param pages 页数。
+ * @param type  迁移类型。
  * 
  * @return 申请成功返回基址，申请失败返回最大值。
  */
-uintn buddy_allow(uintn pages)
+static uintn buddy_alloc_type(uintn pages,uintn type)
 {
-    /*直接计算出最近2的幂指数*/
-    uintn start=sizeof(uintn)*8-count_leading_zeros(pages-1);
-    if(start>=52)
+    uintn order=buddy_get_order(pages);
+    if(pages==0||order>=BUDDY_MAX_ORDER)
     {
         return UINTN_MAX;
     }
 
-    uintn index=count_trailing_zeros(buddy.high_bitmap&(UINT64_MAX<<start));
-    if(index==64)
+    spinlock_lock(&lock);
+    uintn base=buddy_take_order(&zones[PAGE_ZONE_HIGH],order,type);
+    if(base==UINTN_MAX)
     {
+        base=buddy_take_order(&zones[PAGE_ZONE_LOW],order,type);
+    }
+    spinlock_unlock(&lock);
+    return base;
+}
+
+/**
+ * 从伙伴系统申请不可移动页面。页数按2的幂向上取整，优先使用高区，高区无法满足时才使用低区。
+ * 
+ * @param pages 页数。
+ * 
+ * @return 申请成功返回基址，申请失败返回最大值。
+ */
+uintn buddy_alloc(uintn pages)
+{
+    return buddy_alloc_type(pages,PAGE_TYPE_UNMOVABLE);
+}
 
+/**
+ * 从伙伴系统申请可移动页面。页数按2的幂向上取整，优先使用高区，高区无法满足时才使用低区。
+ * 
+ * @param pages 页数。
+ * 
+ * @return 申请成功返回基址，申请失败返回最大值。
+ */
+uintn buddy_alloc_movable(uintn pages)
+{
+    return buddy_alloc_type(pages,PAGE_TYPE_MOVABLE);
+}
+
+/**
+ * 从伙伴系统低区申请页面。页数按2的幂向上取整。
+ * 
+ * @param pages 页数。
+ * 
+ * @return 申请成功返回基址，申请失败返回最大值。
+ */
+uintn buddy_alloc_low(uintn pages)
+{
+    uintn order=buddy_get_order(pages);
+    if(pages==0||order>=BUDDY_MAX_ORDER)
+    {
+        return UINTN_MAX;
     }
-    else
+
+    spinlock_lock(&lock);
+    uintn base=buddy_take_order(&zones[PAGE_ZONE_LOW],order,PAGE_TYPE_UNMOVABLE);
+    spinlock_unlock(&lock);
+    return base;
+}
+
+/**
+ * 向伙伴系统释放页面。页数需与申请时一致。
+ * 
+ * @param base  页框基址。
+ * @param pages 页数。
+ * 
+ * @return 无返回值。
+ */
+void buddy_free(uintn base,uintn pages)
+{
+    uintn order=buddy_get_order(pages);
+    if(pages==0||order>=BUDDY_MAX_ORDER||!is_aligned(base,(uintn)SIZE_4KB<<order)||
+        (base>>12)+((uintn)BIT0<<order)>frame_count)
+    {
+        return;
+    }
+
+    spinlock_lock(&lock);
+    buddy_release(base,order);
+    spinlock_unlock(&lock);
+}
+
+/**
+ * 申请一块物理大页。大页由整页块组成，物理基址按大页大小对齐，可以直接用大页映射。
+ * 首次申请失败时触发一次内存回收后重试。
+ * 
+ * @param order 大页阶数，只接受PAGE_ORDER_2MB与PAGE_ORDER_1GB。
+ * 
+ * @return 申请成功返回大页物理基址，申请失败返回0。
+ */
+uintn alloc_huge_page(uintn order)
+{
+    if(order!=PAGE_ORDER_2MB&&order!=PAGE_ORDER_1GB)
+    {
+        return 0;
+    }
+
+    uintn base=buddy_alloc((uintn)BIT0<<order);
+    if(base==UINTN_MAX&&memory_reclaim()!=0)
+    {
+        base=buddy_alloc((uintn)BIT0<<order);
+    }
+    return base==UINTN_MAX?0:base;
+}
+
+/**
+ * 释放一块物理大页。
+ * 
+ * @param base  大页物理基址。
+ * @param order 申请时的大页阶数。
+ * 
+ * @return 无返回值。
+ */
+void free_huge_page(uintn base,uintn order)
+{
+    if(order==PAGE_ORDER_2MB||order==PAGE_ORDER_1GB)
+    {
+        buddy_free(base,(uintn)BIT0<<order);
+    }
+}
+
+/**
+ * 获取伙伴系统空闲页数。
+ * 
+ * @return 两区空闲页总数。
+ */
+uintn buddy_get_free_pages(void)
+{
+    uintn pages=0;
+    spinlock_lock(&lock);
+    for(uintn order=0;order<BUDDY_MAX_ORDER;order++)
     {
-        uintn block=1<<index;
-        uintn result=
+        pages+=((uintn)zones[PAGE_ZONE_LOW].count[order]+zones[PAGE_ZONE_HIGH].count[order])<<order;
     }
+    spinlock_unlock(&lock);
+    return pages;
+}
+
+/**
+ * 从伙伴系统批量申请单页。整批只获取一次锁，优先使用高区。
+ * 
+ * @param bases 页面基址数组。
+ * @param count 期望页数。
+ * 
+ * @return 实际申请到的页数。
+ */
+uintn buddy_alloc_batch(uintn* bases,uintn count)
+{
+    uintn index=0;
+    spinlock_lock(&lock);
+    while(index<count)
+    {
+        uintn base=buddy_take_order(&zones[PAGE_ZONE_HIGH],0,PAGE_TYPE_UNMOVABLE);
+        if(base==UINTN_MAX)
+        {
+            base=buddy_take_order(&zones[PAGE_ZONE_LOW],0,PAGE_TYPE_UNMOVABLE);
+            if(base==UINTN_MAX)
+            {
+                break;
+            }
+        }
+        bases[index++]=base;
+    }
+    spinlock_unlock(&lock);
+    return index;
+}
+
+/**
+ * 向伙伴系统批量释放单页。整批只获取一次锁。
+ * 
+ * @param bases 页面基址数组。
+ * @param count 页数。
+ * 
+ * @return 无返回值。
+ */
+void buddy_free_batch(const uintn* bases,uintn count)
+{
+    spinlock_lock(&lock);
+    for(uintn index=0;index<count;index++)
+    {
+        if(is_aligned(bases[index],SIZE_4KB)&&(bases[index]>>12)<frame_count)
+        {
+            buddy_release(bases[index],0);
+        }
+    }
+    spinlock_unlock(&lock);
+}
+
+/**
+ * 输出一个区的伙伴系统统计。
+ * 
+ * @param handle 输入输出句柄。
+ * @param name   区名称。
+ * @param counts 各阶空闲块数。
+ * 
+ * @return 无返回值。
+ */
+static void buddy_dump_zone(io_handle* handle,const char8* name,const uint32* counts)
+{
+    uintn pages=0;
+    uintn largest=BUDDY_MAX_ORDER;
+    for(uintn order=0;order<BUDDY_MAX_ORDER;order++)
+    {
+        if(counts[order]!=0)
+        {
+            pages+=(uintn)counts[order]<<order;
+            largest=order;
+        }
+    }
+
+    if(largest==BUDDY_MAX_ORDER)
+    {
+        format_print(handle,"[aos.kernel.memory] Buddy %s zone: no free pages.\n",name);
+        return;
+    }
+    format_print(handle,"[aos.kernel.memory] Buddy %s zone: %N free pages, largest block order %N.\n",
+        name,pages,largest);
+    for(uintn order=0;order<=largest;order++)
+    {
+        if(counts[order]!=0)
+        {
+            format_print(handle,"[aos.kernel.memory]   Order %2N: %u blocks.\n",order,counts[order]);
+        }
+    }
+}
+
+/**
+ * 输出伙伴系统统计，包括各区各阶空闲块数与最大空闲块。
+ * 
+ * @param handle 输入输出句柄。
+ * 
+ * @return 无返回值。
+ */
+void buddy_dump_stats(io_handle* handle)
+{
+    uint32 low_count[52];
+    uint32 high_count[52];
+    spinlock_lock(&lock);
+    memory_copy(low_count,zones[PAGE_ZONE_LOW].count,sizeof(low_count));
+    memory_copy(high_count,zones[PAGE_ZONE_HIGH].count,sizeof(high_count));
+    spinlock_unlock(&lock);
+
+    buddy_dump_zone(handle,"low",low_count);
+    buddy_dump_zone(handle,"high",high_count);
+}
+
+/**
+ * 获取物理地址在直接映射区中的线性地址。启动阶段已建立全部物理内存的直接映射，包括伙伴系统不管理的低1MB。
+ * 
+ * @param base 物理地址。
+ * 
+ * @return 线性地址。
+ */
+void* page_address(uintn base)
+{
+    return memory_phys_to_virt(base);
 }
\ No newline at end of file
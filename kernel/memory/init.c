@@ -6,8 +6,11 @@
  * 
  * SPDX-License-Identifier: MIT
  */
+#include <cpu/rcu.h>
 #include <init/params.h>
 
+#include "memoryi.h"
+
 /**
  * 内核内存池参考基址。
  */
@@ -22,5 +25,33 @@ const uintn KERNEL_POOL_BASE=-5*SIZE_512GB;
  */
 void kernel_memory_init(aos_boot_params* params)
 {
-    
+    memory_pool_init((void*)params->kinfo.pbase,params->minfo.fblock_pages[2]);
+    memory_buddy_init(params);
+    /*启动阶段已建立全部物理内存的直接映射，内存池可以直接向伙伴系统扩展*/
+    memory_pool_attach_page_allocator();
+    memory_per_cpu_init();
+    memory_tlb_init();
+    memory_ptp_init();
+    memory_ptm_init(params);
+    memory_slab_init();
+    memory_vma_init(params);
+    /*模块初始化不处于读临界区，报告静止状态以处理初始化期间提交的延迟回调*/
+    rcu_quiescent_state();
+}
+
+/**
+ * 当前CPU加入内存管理模块：启用页表控制位，建立每CPU页池并加入TLB击落。
+ * 应用处理器在使用内核映射前调用一次，引导处理器已在模块初始化时完成。
+ * 
+ * @return 成功加入返回真。失败时该CPU未加入TLB击落，不能再使用内核映射。
+ */
+bool kernel_memory_cpu_init(void)
+{
+    memory_ptm_cpu_init();
+    /*每CPU页池建立失败时不加入击落，调用者停机该CPU，其他CPU击落时不会等待它*/
+    if(!memory_per_cpu_init())
+    {
+        return false;
+    }
+    return memory_tlb_init();
 }
\ No newline at end of file
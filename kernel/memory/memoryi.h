@@ -9,7 +9,126 @@
 #ifndef __AOS_KERNEL_MEMORY_MEMORY_INTERNAL_H__
 #define __AOS_KERNEL_MEMORY_MEMORY_INTERNAL_H__
 
-#include <support/type.h>
+#include <init/params.h>
+#include <support/handle.h>
+#include <support/control.h>
+#include <support/io.h>
+
+/**
+ * 页框描述符。每个物理页框对应一项，按32字节紧凑排列，两项恰好占满一条缓存行。
+ */
+typedef struct _page_frame
+{
+    uint32 prev;  /*空闲链表前一页框号。*/
+    uint32 next;  /*空闲链表后一页框号。*/
+    uint8  order; /*块阶数。仅块首页框有效。*/
+    uint8  zone;  /*所属区。*/
+    uint16 flags; /*页框标志。*/
+    uint32 count; /*引用计数。*/
+    uintn  owner; /*所有者数据。*/
+    uintn  data;  /*所有者附加数据。*/
+} page_frame;
+
+/**
+ * 页框低区，物理地址低于4GB。
+ */
+#define PAGE_ZONE_LOW 0
+
+/**
+ * 页框高区，物理地址不低于4GB。
+ */
+#define PAGE_ZONE_HIGH 1
+
+/**
+ * 页框为伙伴系统空闲块首页框。
+ */
+#define PAGE_FRAME_FREE BIT0
+
+/**
+ * 页框所在页块为可移动类型。仅页块首页框有效。
+ */
+#define PAGE_FRAME_MOVABLE BIT1
+
+/**
+ * 不可移动页面，如内核数据结构。
+ */
+#define PAGE_TYPE_UNMOVABLE 0
+
+/**
+ * 可移动页面，其内容可以迁移到其他页框。
+ */
+#define PAGE_TYPE_MOVABLE 1
+
+#ifdef AOS_KERNEL_HOST
+/**
+ * 宿主机基准测试中模拟物理内存的映射基址，由宿主程序提供。
+ */
+extern uintn memory_host_map_base;
+
+/**
+ * 直接映射区基址。宿主机上指向模拟物理内存。
+ */
+#define MEMORY_DIRECT_MAP_BASE memory_host_map_base
+#else
+/**
+ * 直接映射区基址。物理地址加上该偏移即为内核可直接访问的线性地址。
+ */
+#define MEMORY_DIRECT_MAP_BASE ((uintn)(-10*SIZE_512GB))
+#endif
+
+/**
+ * 物理地址转换为直接映射区线性地址。
+ * 
+ * @param paddr 物理地址。
+ * 
+ * @return 线性地址。
+ */
+static inline void* memory_phys_to_virt(uintn paddr)
+{
+    return (void*)(paddr+MEMORY_DIRECT_MAP_BASE);
+}
+
+/**
+ * 直接映射区线性地址转换为物理地址。
+ * 
+ * @param vaddr 线性地址。
+ * 
+ * @return 物理地址。
+ */
+static inline uintn memory_virt_to_phys(const void* vaddr)
+{
+    return (uintn)vaddr-MEMORY_DIRECT_MAP_BASE;
+}
+
+/**
+ * 关闭中断，保证访问每CPU数据期间不被同一CPU上的中断打断。
+ * 
+ * @return 关闭前的标志寄存器。
+ */
+static inline uintn memory_irq_save(void)
+{
+    uintn flags=x86_read_flags();
+#ifndef AOS_KERNEL_HOST
+    x86_disable_interrupts();
+#endif
+    return flags;
+}
+
+/**
+ * 恢复中断状态。
+ * 
+ * @param flags 关闭前的标志寄存器。
+ * 
+ * @return 无返回值。
+ */
+static inline void memory_irq_restore(uintn flags)
+{
+#ifndef AOS_KERNEL_HOST
+    x86_write_flags(flags);
+#else
+    (void)flags;
+#endif
+}
 
 /**
  * 初始化内核内存池。
@@ -28,4 +147,252 @@ bool memory_pool_init(void* pool,uintn pages);
  */
 void memory_pool_attach_page_allocator(void);
 
+/**
+ * 初始化伙伴系统。
+ * 
+ * @param params 启动参数。
+ * 
+ * @return 成功初始化返回真。
+ */
+bool memory_buddy_init(aos_boot_params* params);
+
+/**
+ * 获取物理地址对应的页框描述符。
+ * 
+ * @param base 物理地址。
+ * 
+ * @return 页框描述符。超出范围返回空指针。
+ */
+page_frame* buddy_get_frame(uintn base);
+
+/**
+ * 从伙伴系统申请不可移动页面。页数按2的幂向上取整，优先使用高区，高区无法满足时才使用低区。
+ * 
+ * @param pages 页数。
+ * 
+ * @return 申请成功返回基址，申请失败返回最大值。
+ */
+uintn buddy_alloc(uintn pages);
+
+/**
+ * 从伙伴系统申请可移动页面。页数按2的幂向上取整，优先使用高区，高区无法满足时才使用低区。
+ * 
+ * @param pages 页数。
+ * 
+ * @return 申请成功返回基址，申请失败返回最大值。
+ */
+uintn buddy_alloc_movable(uintn pages);
+
+/**
+ * 从伙伴系统低区申请页面。页数按2的幂向上取整。
+ * 
+ * @param pages 页数。
+ * 
+ * @return 申请成功返回基址，申请失败返回最大值。
+ */
+uintn buddy_alloc_low(uintn pages);
+
+/**
+ * 向伙伴系统释放页面。页数需与申请时一致。
+ * 
+ * @param base  页框基址。
+ * @param pages 页数。
+ * 
+ * @return 无返回值。
+ */
+void buddy_free(uintn base,uintn pages);
+
+/**
+ * 获取伙伴系统空闲页数。
+ * 
+ * @return 两区空闲页总数。
+ */
+uintn buddy_get_free_pages(void);
+
+/**
+ * 从伙伴系统批量申请单页。整批只获取一次锁，优先使用高区。
+ * 
+ * @param bases 页面基址数组。
+ * @param count 期望页数。
+ * 
+ * @return 实际申请到的页数。
+ */
+uintn buddy_alloc_batch(uintn* bases,uintn count);
+
+/**
+ * 向伙伴系统批量释放单页。整批只获取一次锁。
+ * 
+ * @param bases 页面基址数组。
+ * @param count 页数。
+ * 
+ * @return 无返回值。
+ */
+void buddy_free_batch(const uintn* bases,uintn count);
+
+/**
+ * 初始化当前CPU的每CPU页池。每个CPU在使用单页接口前调用一次。
+ * 
+ * @return 初始化成功返回真。
+ */
+bool memory_per_cpu_init(void);
+
+/**
+ * 把全部CPU每CPU页池中的页面归还伙伴系统，包括已清零页。池锁正被持有的CPU跳过。
+ * 
+ * @return 归还的页数。
+ */
+uintn per_cpu_drain(void);
+
+/**
+ * 初始化对象缓存的通用大小类。
+ * 
+ * @return 初始化成功返回真。
+ */
+bool memory_slab_init(void);
+
+/**
+ * 初始化内核线性区域管理，导入启动阶段建立的线性区域链表。
+ * 
+ * @param params 启动参数。
+ * 
+ * @return 初始化成功返回真。
+ */
+bool memory_vma_init(aos_boot_params* params);
+
+/**
+ * 初始化页表管理系统，接管启动阶段建立的内核页表。
+ * 
+ * @param params 启动参数。
+ * 
+ * @return 无返回值。
+ */
+void memory_ptm_init(aos_boot_params* params);
+
+/**
+ * 当前CPU启用页表管理系统所需的控制位。支持时开启CR4.PCIDE，每个CPU调用一次。
+ * 
+ * @return 无返回值。
+ */
+void memory_ptm_cpu_init(void);
+
+/**
+ * 初始化页表页分配器，预先填满全局储备。在页表管理系统初始化前调用。
+ * 
+ * @return 无返回值。
+ */
+void memory_ptp_init(void);
+
+/**
+ * 申请一页已清零的页表页。依次取自当前CPU、全局储备，都为空时才向页管理器申请。
+ * 
+ * @param level 页表层级。
+ * 
+ * @return 申请成功返回物理地址，失败返回0。
+ */
+uintn ptp_alloc(uintn level);
+
+/**
+ * 释放一页已清空的页表页。页面要等全部无锁遍历者离开后才复用，调用者应已完成TLB击落。
+ * 
+ * @param page  页表页物理地址。
+ * @param level 页表层级。
+ * 
+ * @return 无返回值。
+ */
+void ptp_free(uintn page,uintn level);
+
+/**
+ * 当前CPU开始无锁遍历页表。期间读到的页表页不会被复用，可以嵌套，遍历中不能睡眠。
+ * 
+ * @return 无返回值。
+ */
+void ptp_read_lock(void);
+
+/**
+ * 当前CPU结束无锁遍历页表。
+ * 
+ * @return 无返回值。
+ */
+void ptp_read_unlock(void);
+
+/**
+ * 在空闲时补充页表页储备。先回收宽限期已过的页面，再用已清零页补满全局储备与当前CPU，
+ * 使映射突发不必落到页管理器。
+ * 
+ * @param budget 本次最多补充的页数。
+ * 
+ * @return 实际补充的页数。
+ */
+uintn ptp_fill_idle(uintn budget);
+
+/**
+ * 当前CPU加入TLB击落。每个CPU在修改或使用内核映射前调用一次。
+ * 
+ * @return 成功加入返回真。
+ */
+bool memory_tlb_init(void);
+
+/**
+ * 设置INVPCID支持状态。
+ * 
+ * @param enable 支持INVPCID。
+ * 
+ * @return 无返回值。
+ */
+void memory_tlb_set_invpcid(bool enable);
+
+/**
+ * 输出伙伴系统统计，包括各区各阶空闲块数与最大空闲块。
+ * 
+ * @param handle 输入输出句柄。
+ * 
+ * @return 无返回值。
+ */
+void buddy_dump_stats(io_handle* handle);
+
+/**
+ * 输出每CPU页池统计。
+ * 
+ * @param handle 输入输出句柄。
+ * 
+ * @return 无返回值。
+ */
+void per_cpu_dump_stats(io_handle* handle);
+
+/**
+ * 输出内存池统计。
+ * 
+ * @param handle 输入输出句柄。
+ * 
+ * @return 无返回值。
+ */
+void pool_dump_stats(io_handle* handle);
+
+/**
+ * 输出页表页统计。
+ * 
+ * @param handle 输入输出句柄。
+ * 
+ * @return 无返回值。
+ */
+void ptp_dump_stats(io_handle* handle);
+
+/**
+ * 输出TLB击落统计。
+ * 
+ * @param handle 输入输出句柄。
+ * 
+ * @return 无返回值。
+ */
+void tlb_dump_stats(io_handle* handle);
+
+/**
+ * 输出对象缓存统计。
+ * 
+ * @param handle 输入输出句柄。
+ * 
+ * @return 无返回值。
+ */
+void slab_dump_stats(io_handle* handle);
+
 #endif /*__AOS_KERNEL_MEMORY_MEMORY_INTERNAL_H__*/
\ No newline at end of file
@@ -6,8 +6,16 @@
  * 
  * SPDX-License-Identifier: MIT
  */
+#include <cpu/info.h>
+#include <cpu/per_cpu_vars.h>
+#include <memory/pool.h>
+#include <memory/reclaim.h>
+#include <support/atomic.h>
+#include <support/format.h>
 #include <support/memory.h>
+#include <support/sync.h>
 #include <support/util.h>
+#include "memoryi.h"
 
 /**
  * 内存池空闲链表结点最小值。
@@ -88,8 +96,8 @@ struct _pool_tlsf_node
 {
     uintn           psize; /*前一物理连续结点大小。*/
     uintn           csize; /*当前结点大小。*/
-    pool_tlsf_node* prev;  /*链表前一结点。*/
-    pool_tlsf_node* next;  /*链表下一结点。*/
+    pool_tlsf_node* prev;  /*链表前一结点。已分配块存放所属内存池区域。*/
+    pool_tlsf_node* next;  /*链表下一结点。远程释放时串联远程释放链表。*/
 };
 
 /**
@@ -97,14 +105,59 @@ struct _pool_tlsf_node
  */
 typedef struct _pool_tlsf_meta
 {
-    uint32          fl_bitmap;        /*第一级位图。*/
-    uint8           sl_bitmap[32];    /*第二级位图。*/
-    pool_tlsf_node* free_head[32][8]; /*空闲块链表头。*/
-    pool_tlsf_node* free_tail[32][8]; /*空闲块链表尾。*/
-    pool_tlsf_node* allow_head;       /*已分配块链表头。*/
-    pool_tlsf_node* allow_tail;       /*已分配块链表尾。*/
+    uint32          fl_bitmap;         /*第一级位图。*/
+    uint8           sl_bitmap[32];     /*第二级位图。*/
+    pool_tlsf_node* free_head[32][8];  /*空闲块链表头。*/
+    pool_tlsf_node* free_tail[32][8];  /*空闲块链表尾。*/
+    uint32          free_count[32][8]; /*空闲块数目。*/
 } pool_tlsf_meta;
 
+/**
+ * 内存池扩展块。位于向页管理器申请的每段内存首部，其后紧跟扩展块的首个结点。
+ */
+typedef struct _pool_extension pool_extension;
+
+struct _pool_extension
+{
+    pool_extension* prev;  /*链表前一扩展块。*/
+    pool_extension* next;  /*链表下一扩展块。*/
+    uintn           pages; /*扩展块页数。*/
+    uintn           idle;  /*扩展块完全空闲时为1。*/
+};
+
+/**
+ * 区域内完全空闲扩展块页数高水位。超过后开始归还页管理器。
+ */
+const static uintn POOL_IDLE_HIGH_PAGES=64;
+
+/**
+ * 区域内完全空闲扩展块页数低水位。归还到不高于该值为止，留存部分避免反复申请释放。
+ */
+const static uintn POOL_IDLE_LOW_PAGES=16;
+
+/**
+ * 扩展块最小页数。
+ */
+const static uintn POOL_EXTENSION_MIN_PAGES=16;
+
+/**
+ * 内存池区域。每个CPU独占一个区域，区域锁几乎只由所属CPU获取，没有竞争。
+ * 其他CPU释放的块经无锁远程释放链表交还，由所属CPU在下次申请时统一回收；
+ * 所属CPU不再申请时，由低内存回收在其他CPU上尝试获取区域锁后代为回收。
+ */
+typedef struct _pool_arena
+{
+    spinlock                 lock;       /*区域锁。*/
+    pool_tlsf_meta           meta;       /*TLSF元数据。*/
+    _Atomic(pool_tlsf_node*) remote;     /*远程释放链表。*/
+    pool_extension*          extensions; /*扩展块链表。*/
+    uintn                    idle_pages; /*完全空闲扩展块总页数。*/
+    uintn                    allocs[32]; /*各第一级大小类申请次数。*/
+    uintn                    frees[32];  /*各第一级大小类释放次数。*/
+    uintn                    in_use;     /*已分配字节数，含结点头。*/
+    uintn                    peak;       /*已分配字节数峰值。*/
+} pool_arena;
+
 /**
  * 获取结点大小对应的第一级索引。小于64统一归为0，大于等于128GB的统一归为31。
  * 
@@ -258,43 +311,122 @@ static inline bool pool_is_free(uintn packed)
     return packed&BIT0?true:false;
 }
 
-/**
- * 当前内存池元数据。
- */
-static pool_tlsf_meta pool_meta;
 
 /**
  * 根据第一级索引和第二级索引更新映射。
  * 
+ * @param meta     内存池元数据。
  * @param fl_index 第一级索引。
  * @param sl_index 第二级索引。
  * 
  * @return 无返回值。
  */
-static void pool_update_bitmap(uintn fl_index,uintn sl_index)
+static void pool_update_bitmap(pool_tlsf_meta* meta,uintn fl_index,uintn sl_index)
 {
-    if(pool_meta.free_head[fl_index][sl_index]!=null)
+    if(meta->free_head[fl_index][sl_index]!=null)
     {
-        pool_meta.fl_bitmap|=1<<fl_index;
-        pool_meta.sl_bitmap[fl_index]|=1<<sl_index;
+        meta->fl_bitmap|=1<<fl_index;
+        meta->sl_bitmap[fl_index]|=1<<sl_index;
     }
     else
     {
-        pool_meta.sl_bitmap[fl_index]&=UINT8_MAX^(1<<sl_index);
-        if(pool_meta.sl_bitmap[fl_index]==0)
+        meta->sl_bitmap[fl_index]&=UINT8_MAX^(1<<sl_index);
+        if(meta->sl_bitmap[fl_index]==0)
         {
-            pool_meta.fl_bitmap&=UINT32_MAX^(1<<fl_index);
+            meta->fl_bitmap&=UINT32_MAX^(1<<fl_index);
         }
     }
 }
 
+/**
+ * 向空闲块链表加入一个块。
+ * 
+ * @param meta  内存池元数据。
+ * @param block 空闲块。
+ * 
+ * @return 无返回值。
+ */
+static void pool_insert_free(pool_tlsf_meta* meta,pool_tlsf_node* block)
+{
+    uintn fl_index=pool_get_fl_index(pool_get_size(block->csize));
+    uintn sl_index=pool_get_sl_index(pool_get_size(block->csize),fl_index);
+    pool_list_add(&meta->free_head[fl_index][sl_index],&meta->free_tail[fl_index][sl_index],block);
+    pool_update_bitmap(meta,fl_index,sl_index);
+    meta->free_count[fl_index][sl_index]++;
+}
+
+/**
+ * 从空闲块链表移除一个块。
+ * 
+ * @param meta  内存池元数据。
+ * @param block 空闲块。
+ * 
+ * @return 无返回值。
+ */
+static void pool_remove_free(pool_tlsf_meta* meta,pool_tlsf_node* block)
+{
+    uintn fl_index=pool_get_fl_index(pool_get_size(block->csize));
+    uintn sl_index=pool_get_sl_index(pool_get_size(block->csize),fl_index);
+    pool_list_remove(&meta->free_head[fl_index][sl_index],&meta->free_tail[fl_index][sl_index],block);
+    pool_update_bitmap(meta,fl_index,sl_index);
+    meta->free_count[fl_index][sl_index]--;
+}
+
 /**
  * 当前初始化状态。
  */
 static bool init_state=false;
 
 /**
- * 初始化内核内存池。
+ * 内存池新增页面申请。
+ * 
+ * @param pages 申请页数。
+ * 
+ * @return 申请成功返回一个非零线性地址。
+ */
+static void* (*pool_page_alloc)(uintn pages)=null;
+
+/**
+ * 内存池释放申请页面。
+ * 
+ * @param base  释放页面线性基址。
+ * @param pages 释放页数。
+ * 
+ * @return 无返回值。
+ */
+static void (*pool_page_free)(void* base,uintn pages)=null;
+
+/**
+ * 在一段内存上建立内存池区域。区域元数据位于内存首部，其余部分作为首个空闲块。
+ * 首块前驱大小记为已分配，因此该段内存不会被当作扩展块归还。
+ * 
+ * @param base 内存基址。
+ * @param size 内存大小。
+ * 
+ * @return 内存池区域。
+ */
+static pool_arena* pool_arena_setup(void* base,uintn size)
+{
+    pool_arena* arena=(pool_arena*)base;
+    memory_zero(arena,sizeof(pool_arena));
+    atomic_init(&arena->remote,null);
+
+    uintn offset=align_up(sizeof(pool_arena),8);
+    pool_tlsf_node* block=(pool_tlsf_node*)((uintn)base+offset);
+    block->psize=pool_pack_size(0,false);
+    block->csize=pool_pack_size(size-offset-sizeof(pool_tlsf_node),true);
+    pool_insert_free(&arena->meta,block);
+
+    pool_tlsf_node* sentinel=(pool_tlsf_node*)((uintn)block+pool_get_size(block->csize));
+    sentinel->psize=block->csize;
+    sentinel->csize=pool_pack_size(sizeof(pool_tlsf_node),false);
+    sentinel->prev=(pool_tlsf_node*)arena;
+
+    return arena;
+}
+
+/**
+ * 初始化内核内存池。给定内存成为当前CPU（引导处理器）的内存池区域。
  * 
  * @param pool  内核内存池基址。
  * @param pages 内存块页数。
@@ -311,110 +443,218 @@ bool memory_pool_init(void* pool,uintn pages)
     {
         init_state=true;
     }
-    memory_zero(&pool_meta,sizeof(pool_tlsf_meta));
 
-    pool_tlsf_node* block=(pool_tlsf_node*)pool;
-    block->psize=pool_pack_size(0,false);
-    block->csize=pool_pack_size(
-        (pages<<12)-align_up(sizeof(pool_tlsf_meta),8)-sizeof(pool_tlsf_node),true);
-    uintn fl_index=pool_get_fl_index(block->csize);
-    uintn sl_index=pool_get_sl_index(block->csize,fl_index);
-    pool_list_add(&pool_meta.free_head[fl_index][sl_index],&pool_meta.free_tail[fl_index][sl_index],
-        block);
-    pool_update_bitmap(fl_index,sl_index);
+    set_per_cpu_variable(PER_CPU_POOL,(uint64)pool_arena_setup(pool,pages<<12));
+    return true;
+}
 
-    pool_tlsf_node* sentinel=(pool_tlsf_node*)((uintn)block+pool_get_size(block->csize));
-    sentinel->psize=block->csize;
-    sentinel->csize=pool_pack_size(sizeof(pool_tlsf_node),false);
-    pool_list_add(&pool_meta.allow_head,&pool_meta.allow_tail,sentinel);
+/**
+ * 获取当前CPU的内存池区域，首次使用时向页管理器申请一段内存建立。需关闭中断。
+ * 
+ * @return 内存池区域，无法建立时返回空指针。
+ */
+static pool_arena* pool_get_arena(void)
+{
+    pool_arena* arena=(pool_arena*)get_per_cpu_variable(PER_CPU_POOL);
+    if(arena==null&&init_state&&pool_page_alloc!=null)
+    {
+        /*页数取2的幂，伙伴系统取整多出的页面也交给区域使用*/
+        uintn pages=(align_up(sizeof(pool_arena),SIZE_4KB)+SIZE_64KB)>>12;
+        pages=(uintn)1<<(sizeof(uintn)*8-count_leading_zeros(pages-1));
+        void* base=pool_page_alloc(pages);
+        if(base!=null)
+        {
+            arena=pool_arena_setup(base,pages<<12);
+            set_per_cpu_variable(PER_CPU_POOL,(uint64)arena);
+        }
+    }
+    return arena;
+}
 
-    return true;
+/**
+ * 把已分配块标记为属于指定区域，并更新后一块的前驱大小。
+ * 
+ * @param arena 内存池区域。
+ * @param block 已分配块。
+ * @param size  块大小。
+ * 
+ * @return 无返回值。
+ */
+static inline void pool_mark_used(pool_arena* arena,pool_tlsf_node* block,uintn size)
+{
+    block->csize=pool_pack_size(size,false);
+    block->prev=(pool_tlsf_node*)arena;
+    block->next=null;
+    ((pool_tlsf_node*)((uintn)block+size))->psize=block->csize;
 }
 
 /**
- * 内存池新增页面申请。
+ * 切分已取出的块，剩余部分足够大时作为空闲块放回。
  * 
- * @param pages 申请页数。
+ * @param arena 内存池区域。
+ * @param block 已取出的块。
+ * @param size  需要的大小。
  * 
- * @return 申请成功返回一个非零线性地址。
+ * @return 无返回值。
  */
-static void* (*pool_page_alloc)(uintn pages)=null;
+static void pool_split(pool_arena* arena,pool_tlsf_node* block,uintn size)
+{
+    uintn space=pool_get_size(block->csize)-size;
+    if(space>=64)
+    {
+        pool_mark_used(arena,block,size);
+        pool_tlsf_node* free_block=(pool_tlsf_node*)((uintn)block+size);
+        free_block->csize=pool_pack_size(space,true);
+        ((pool_tlsf_node*)((uintn)free_block+space))->psize=free_block->csize;
+        pool_insert_free(&arena->meta,free_block);
+    }
+    else
+    {
+        pool_mark_used(arena,block,pool_get_size(block->csize));
+    }
+}
+
+/**
+ * 获取扩展块首个结点所属的扩展块。
+ * 
+ * @param block 扩展块首个结点。
+ * 
+ * @return 扩展块。
+ */
+static inline pool_extension* pool_get_extension(pool_tlsf_node* block)
+{
+    return (pool_extension*)((uintn)block-sizeof(pool_extension));
+}
+
+/**
+ * 检查空闲块是否占满整个扩展块。
+ * 
+ * @param block 空闲块。
+ * 
+ * @return 占满返回真。
+ */
+static inline bool pool_is_whole_extension(pool_tlsf_node* block)
+{
+    pool_tlsf_node* next=(pool_tlsf_node*)((uintn)block+pool_get_size(block->csize));
+    return block->psize==pool_pack_size(0,true)&&next->csize==sizeof(pool_tlsf_node);
+}
+
+/**
+ * 把完全空闲的扩展块归还页管理器，直到空闲扩展块页数不高于目标值。
+ * 
+ * @param arena  内存池区域。
+ * @param target 目标空闲页数。
+ * 
+ * @return 归还的页数。
+ */
+static uintn pool_arena_release(pool_arena* arena,uintn target)
+{
+    uintn released=0;
+    pool_extension* extension=arena->extensions;
+    while(extension!=null&&arena->idle_pages>target)
+    {
+        pool_extension* next=extension->next;
+        if(extension->idle)
+        {
+            pool_remove_free(&arena->meta,(pool_tlsf_node*)((uintn)extension+sizeof(pool_extension)));
+            if(extension->prev!=null)
+            {
+                extension->prev->next=next;
+            }
+            else
+            {
+                arena->extensions=next;
+            }
+            if(next!=null)
+            {
+                next->prev=extension->prev;
+            }
+            arena->idle_pages-=extension->pages;
+            released+=extension->pages;
+            pool_page_free(extension,extension->pages);
+        }
+        extension=next;
+    }
+    return released;
+}
 
 /**
  * 尝试添加一块足够大的页框来申请一块内核内存池的内存。
  * 
- * @param size 经过调整的申请大小。
+ * @param arena 内存池区域。
+ * @param size  经过调整的申请大小。
  * 
  * @return 成功申请返回一个非空指针。
  */
-static void* pool_alloc_new(uintn size)
+static void* pool_arena_alloc_new(pool_arena* arena,uintn size)
 {
     if(pool_page_alloc==null)
     {
         return null;
     }
 
-    /*保证申请块除了能容纳申请内存外还能接受一个哨兵块*/
-    uintn block_size=align_up(size+sizeof(pool_tlsf_node),SIZE_4KB);
-    pool_tlsf_node* block=(pool_tlsf_node*)pool_page_alloc(block_size>>12);
-    if(block==null)
+    /*保证申请块除了能容纳扩展块首部与申请内存外还能接受一个哨兵块*/
+    /*页数取2的幂，与伙伴系统的分配粒度一致，不浪费取整部分*/
+    uintn pages=align_up(sizeof(pool_extension)+size+sizeof(pool_tlsf_node),SIZE_4KB)>>12;
+    pages=max(pages,POOL_EXTENSION_MIN_PAGES);
+    pages=(uintn)1<<(sizeof(uintn)*8-count_leading_zeros(pages-1));
+    pool_extension* extension=(pool_extension*)pool_page_alloc(pages);
+    if(extension==null)
+    {
+        /*区域尚未改动，回收期间放开区域锁，使回收也能整理本区域*/
+        spinlock_unlock(&arena->lock);
+        uintn reclaimed=memory_reclaim();
+        spinlock_lock(&arena->lock);
+        if(reclaimed!=0)
+        {
+            extension=(pool_extension*)pool_page_alloc(pages);
+        }
+    }
+    if(extension==null)
     {
         return null;
     }
+    extension->prev=null;
+    extension->next=arena->extensions;
+    extension->pages=pages;
+    extension->idle=0;
+    if(arena->extensions!=null)
+    {
+        arena->extensions->prev=extension;
+    }
+    arena->extensions=extension;
+
+    pool_tlsf_node* block=(pool_tlsf_node*)((uintn)extension+sizeof(pool_extension));
     block->psize=pool_pack_size(0,true);
-    block_size-=sizeof(pool_tlsf_node);
+    uintn block_size=(pages<<12)-sizeof(pool_extension)-sizeof(pool_tlsf_node);
+    block->csize=pool_pack_size(block_size,true);
 
     pool_tlsf_node* sentinel=(pool_tlsf_node*)((uintn)block+block_size);
     sentinel->csize=pool_pack_size(sizeof(pool_tlsf_node),false);
-    pool_list_add(&pool_meta.allow_head,&pool_meta.allow_tail,sentinel);
-    pool_list_add(&pool_meta.allow_head,&pool_meta.allow_tail,block);
-
-    uintn space=block_size-size;
-    if(space>=64)
-    {
-        pool_tlsf_node* free_block=(pool_tlsf_node*)((uintn)block+size);
-        block->csize=pool_pack_size(size,false);
-        free_block->psize=block->csize;
-        free_block->csize=pool_pack_size(space,true);
-        sentinel->psize=free_block->csize;
-
-        uintn fl_index=pool_get_fl_index(space);
-        uintn sl_index=pool_get_sl_index(space,fl_index);
-        pool_list_add(&pool_meta.free_head[fl_index][sl_index],&pool_meta.free_tail[fl_index][sl_index],
-            free_block);
-        pool_update_bitmap(fl_index,sl_index);
-    }
-    else
-    {
-        block->csize=pool_pack_size(block_size,false);
-        sentinel->psize=block->csize;
-    }
+    sentinel->prev=(pool_tlsf_node*)arena;
 
+    pool_split(arena,block,size);
     return (void*)((uintn)block+sizeof(pool_tlsf_node));
 }
 
 /**
- * 申请一块内核内存池的内存。
+ * 从区域申请一块内存。
  * 
- * @param size 申请大小。
+ * @param arena 内存池区域。
+ * @param size  经过调整的申请大小。
  * 
  * @return 成功申请返回一个非空指针。
  */
-void* pool_alloc(uintn size)
+static void* pool_arena_alloc(pool_arena* arena,uintn size)
 {
-    if(size==0)
-    {
-        return null;
-    }
-
-    size=max(align_up(sizeof(pool_tlsf_node)+size,8),64);
+    pool_tlsf_meta* meta=&arena->meta;
     uintn fl_index,sl_index;
     pool_get_alloc_index(size,&fl_index,&sl_index);
 
     pool_tlsf_node* block=null;
     if(fl_index==31)
     {
-        pool_tlsf_node* node=pool_meta.free_head[31][0];
+        pool_tlsf_node* node=meta->free_head[31][0];
         while(node!=null)
         {
             if(pool_get_size(node->csize)>=size)
@@ -426,30 +666,30 @@ void* pool_alloc(uintn size)
         }
         if(block==null)
         {
-            return pool_alloc_new(size);
+            return pool_arena_alloc_new(arena,size);
         }
     }
     else
     {
-        uintn free_fl=count_trailing_zeros(pool_meta.fl_bitmap&(UINT32_MAX<<fl_index));
+        uintn free_fl=count_trailing_zeros(meta->fl_bitmap&(UINT32_MAX<<fl_index));
         if(free_fl>31)
         {
-            return pool_alloc_new(size);
+            return pool_arena_alloc_new(arena,size);
         }
         else if(free_fl==fl_index)
         {
-            uintn free_sl=count_trailing_zeros((uint8)(pool_meta.sl_bitmap[fl_index]&(UINT8_MAX<<sl_index)));
+            uintn free_sl=count_trailing_zeros((uint8)(meta->sl_bitmap[fl_index]&(UINT8_MAX<<sl_index)));
             if(free_sl>7)
             {
-                free_fl=count_trailing_zeros(pool_meta.fl_bitmap&(UINT32_MAX<<(fl_index+1)));
+                free_fl=count_trailing_zeros(meta->fl_bitmap&(UINT32_MAX<<(fl_index+1)));
                 if(free_fl>31)
                 {
-                    return pool_alloc_new(size);
+                    return pool_arena_alloc_new(arena,size);
                 }
                 else
                 {
                     fl_index=free_fl;
-                    sl_index=count_trailing_zeros(pool_meta.sl_bitmap[fl_index]);
+                    sl_index=count_trailing_zeros(meta->sl_bitmap[fl_index]);
                 }
             }
             else
@@ -460,130 +700,393 @@ void* pool_alloc(uintn size)
         else
         {
             fl_index=free_fl;
-            sl_index=count_trailing_zeros(pool_meta.sl_bitmap[fl_index]);
+            sl_index=count_trailing_zeros(meta->sl_bitmap[fl_index]);
         }
     
-        block=pool_meta.free_head[fl_index][sl_index];
+        block=meta->free_head[fl_index][sl_index];
     }
     
-    pool_list_remove(&pool_meta.free_head[fl_index][sl_index],&pool_meta.free_tail[fl_index][sl_index],
-        block);
-    pool_update_bitmap(fl_index,sl_index);
-    pool_list_add(&pool_meta.allow_head,&pool_meta.allow_tail,block);
-
-    uintn space=pool_get_size(block->csize)-size;
-    if(space>=64)
+    pool_remove_free(meta,block);
+    if(pool_is_whole_extension(block))
     {
-        pool_tlsf_node* free_block=(pool_tlsf_node*)((uintn)block+size);
-        block->csize=pool_pack_size(size,false);
-        free_block->psize=block->csize;
-        free_block->csize=pool_pack_size(space,true);
-        pool_tlsf_node* next=(pool_tlsf_node*)((uintn)free_block+space);
-        next->psize=free_block->csize;
+        pool_extension* extension=pool_get_extension(block);
+        extension->idle=0;
+        arena->idle_pages-=extension->pages;
+    }
+    pool_split(arena,block,size);
+    return (void*)((uintn)block+sizeof(pool_tlsf_node));
+}
 
-        fl_index=pool_get_fl_index(space);
-        sl_index=pool_get_sl_index(space,fl_index);
-        pool_list_add(&pool_meta.free_head[fl_index][sl_index],&pool_meta.free_tail[fl_index][sl_index],
-            free_block);
-        pool_update_bitmap(fl_index,sl_index);
+/**
+ * 向区域释放一块内存，与相邻空闲块合并。完全空闲的扩展块先留在区域内，
+ * 空闲扩展块总页数超过高水位时才归还页管理器，降到低水位为止。
+ * 
+ * @param arena 内存池区域。
+ * @param block 已分配块。
+ * 
+ * @return 无返回值。
+ */
+static void pool_arena_free(pool_arena* arena,pool_tlsf_node* block)
+{
+    pool_tlsf_meta* meta=&arena->meta;
+    if(pool_is_free(block->psize)&&pool_get_size(block->psize)>0)
+    {
+        pool_tlsf_node* prev=(pool_tlsf_node*)((uintn)block-pool_get_size(block->psize));
+        pool_remove_free(meta,prev);
+        prev->csize=pool_pack_size(pool_get_size(prev->csize)+pool_get_size(block->csize),
+            true);
+        block=prev;
     }
     else
     {
-        block->csize=pool_pack_size(block->csize,false);
+        block->csize=pool_pack_size(block->csize,true);
+    }
+
+    pool_tlsf_node* next=(pool_tlsf_node*)((uintn)block+pool_get_size(block->csize));
+    if(pool_is_free(next->csize))
+    {
+        pool_remove_free(meta,next);
+        block->csize=pool_pack_size(pool_get_size(block->csize)+pool_get_size(next->csize),
+            true);
+        next=(pool_tlsf_node*)((uintn)block+pool_get_size(block->csize));
     }
+    next->psize=block->csize;
+    pool_insert_free(meta,block);
 
-    return (void*)((uintn)block+sizeof(pool_tlsf_node));
+    if(pool_is_whole_extension(block))
+    {
+        pool_extension* extension=pool_get_extension(block);
+        extension->idle=1;
+        arena->idle_pages+=extension->pages;
+        if(arena->idle_pages>POOL_IDLE_HIGH_PAGES&&pool_page_free!=null)
+        {
+            pool_arena_release(arena,POOL_IDLE_LOW_PAGES);
+        }
+    }
 }
 
 /**
- * 内存池释放申请页面。
+ * 记录一次申请。
  * 
- * @param base  释放页面线性基址。
- * @param pages 释放页数。
+ * @param arena 内存池区域。
+ * @param ptr   申请得到的内存指针。
  * 
  * @return 无返回值。
  */
-static void (*pool_page_free)(void* base,uintn pages)=null;
+static inline void pool_stat_alloc(pool_arena* arena,void* ptr)
+{
+    uintn size=pool_get_size(((pool_tlsf_node*)((uintn)ptr-sizeof(pool_tlsf_node)))->csize);
+    arena->allocs[pool_get_fl_index(size)]++;
+    arena->in_use+=size;
+    arena->peak=max(arena->peak,arena->in_use);
+}
 
 /**
- * 释放一块内核内存池的内存。
+ * 记录一次释放。
  * 
- * @param ptr 申请内存指针基址。
+ * @param arena 内存池区域。
+ * @param block 待释放块。
  * 
  * @return 无返回值。
  */
-void pool_free(void* ptr)
+static inline void pool_stat_free(pool_arena* arena,pool_tlsf_node* block)
 {
-    if(ptr==null||(uintn)ptr%8!=0)
+    uintn size=pool_get_size(block->csize);
+    arena->frees[pool_get_fl_index(size)]++;
+    arena->in_use-=size;
+}
+
+/**
+ * 回收其他CPU经远程释放链表交还的块。需持有区域锁。
+ * 
+ * @param arena 内存池区域。
+ * 
+ * @return 无返回值。
+ */
+static void pool_arena_drain(pool_arena* arena)
+{
+    if(atomic_load_explicit(&arena->remote,MEMORY_ORDER_RELAXED)==null)
     {
         return;
     }
-    pool_tlsf_node* block=(pool_tlsf_node*)((uintn)ptr-sizeof(pool_tlsf_node));
-    if(pool_is_free(block->csize)||pool_get_size(block->csize)<64)
+
+    pool_tlsf_node* block=atomic_exchange_explicit(&arena->remote,null,MEMORY_ORDER_ACQUIRE);
+    while(block!=null)
     {
-        return;
+        pool_tlsf_node* next=block->next;
+        pool_stat_free(arena,block);
+        pool_arena_free(arena,block);
+        block=next;
     }
-    pool_list_remove(&pool_meta.allow_head,&pool_meta.allow_tail,block);
+}
 
-    if(pool_is_free(block->psize)&&pool_get_size(block->psize)>0)
+/**
+ * 申请一块内核内存池的内存。
+ * 
+ * @param size 申请大小。
+ * 
+ * @return 成功申请返回一个非空指针。
+ */
+void* pool_alloc(uintn size)
+{
+    if(size==0)
     {
-        pool_tlsf_node* prev=(pool_tlsf_node*)((uintn)block-pool_get_size(block->psize));
-        uintn fl_index=pool_get_fl_index(pool_get_size(prev->csize));
-        uintn sl_index=pool_get_sl_index(pool_get_size(prev->csize),fl_index);
-        pool_list_remove(&pool_meta.free_head[fl_index][sl_index],&pool_meta.free_tail[fl_index][sl_index],
-            prev);
-        pool_update_bitmap(fl_index,sl_index);
+        return null;
+    }
 
-        prev->csize=pool_pack_size(pool_get_size(prev->csize)+pool_get_size(block->csize),
-            true);
-        block=prev;
+    void* result=null;
+    uintn flags=memory_irq_save();
+    pool_arena* arena=pool_get_arena();
+    if(arena!=null)
+    {
+        spinlock_lock(&arena->lock);
+        pool_arena_drain(arena);
+        result=pool_arena_alloc(arena,max(align_up(sizeof(pool_tlsf_node)+size,8),64));
+        if(result!=null)
+        {
+            pool_stat_alloc(arena,result);
+        }
+        spinlock_unlock(&arena->lock);
     }
-    else
+    memory_irq_restore(flags);
+    return result;
+}
+
+/**
+ * 申请一块按指定对齐的内核内存池的内存。对齐前后多出的空间会切分为独立块并归还内存池。
+ * 
+ * @param size  申请大小。
+ * @param align 对齐要求，必须是2的幂。
+ * 
+ * @return 成功申请返回一个非空指针。
+ */
+void* pool_alloc_aligned(uintn size,uintn align)
+{
+    if(size==0||(align&(align-1))!=0)
     {
-        block->csize=pool_pack_size(block->csize,true);
+        return null;
+    }
+    else if(align<=8)
+    {
+        return pool_alloc(size);
     }
 
-    pool_tlsf_node* next=(pool_tlsf_node*)((uintn)block+pool_get_size(block->csize));
-    if(pool_is_free(next->csize))
+    uintn flags=memory_irq_save();
+    pool_arena* arena=pool_get_arena();
+    if(arena==null)
     {
-        uintn fl_index=pool_get_fl_index(pool_get_size(next->csize));
-        uintn sl_index=pool_get_sl_index(pool_get_size(next->csize),fl_index);
-        pool_list_remove(&pool_meta.free_head[fl_index][sl_index],&pool_meta.free_tail[fl_index][sl_index],
-            next);
-        pool_update_bitmap(fl_index,sl_index);
+        memory_irq_restore(flags);
+        return null;
+    }
+    spinlock_lock(&arena->lock);
+    pool_arena_drain(arena);
 
-        block->csize=pool_pack_size(pool_get_size(block->csize)+pool_get_size(next->csize),
-            true);
-        next=(pool_tlsf_node*)((uintn)block+pool_get_size(block->csize));
-        next->psize=block->csize;
+    /*前部间隙要么为0，要么至少能容纳一个最小块，因此额外预留对齐量与最小块大小*/
+    uintn used=max(align_up(sizeof(pool_tlsf_node)+size,8),64);
+    uintn ptr=(uintn)pool_arena_alloc(arena,align_up(sizeof(pool_tlsf_node)+used+align+64,8));
+    if(ptr==0)
+    {
+        spinlock_unlock(&arena->lock);
+        memory_irq_restore(flags);
+        return null;
     }
-    else
+    uintn aligned=align_up(ptr,align);
+    if(aligned!=ptr&&aligned-ptr<64)
     {
-        next->psize=block->csize;
+        aligned=align_up(ptr+64,align);
     }
 
-    if(block->psize==pool_pack_size(0,true)&&next->csize==sizeof(pool_tlsf_node))
+    pool_tlsf_node* block=(pool_tlsf_node*)(ptr-sizeof(pool_tlsf_node));
+    uintn total=pool_get_size(block->csize);
+    if(aligned!=ptr)
     {
-        uintn size=(pool_get_size(block->csize)+sizeof(pool_tlsf_node));
-        pool_list_remove(&pool_meta.allow_head,&pool_meta.allow_tail,next);
-        pool_page_free(block,size>>12);
+        /*前部间隙切为独立的已分配块，再经释放流程与前方空闲块合并*/
+        pool_tlsf_node* front=block;
+        uintn gap=aligned-ptr;
+        block=(pool_tlsf_node*)(aligned-sizeof(pool_tlsf_node));
+        total-=gap;
+        pool_mark_used(arena,block,total);
+        pool_mark_used(arena,front,gap);
+        pool_arena_free(arena,front);
+    }
+
+    if(total-used>=64)
+    {
+        /*尾部剩余同样切分后释放，与后方空闲块合并*/
+        pool_tlsf_node* rest=(pool_tlsf_node*)((uintn)block+used);
+        pool_mark_used(arena,rest,total-used);
+        pool_mark_used(arena,block,used);
+        pool_arena_free(arena,rest);
+    }
+
+    pool_stat_alloc(arena,(void*)aligned);
+    spinlock_unlock(&arena->lock);
+    memory_irq_restore(flags);
+    return (void*)aligned;
+}
+
+/**
+ * 释放一块内核内存池的内存。属于其他CPU区域的块经远程释放链表交还所属CPU。
+ * 
+ * @param ptr 申请内存指针基址。
+ * 
+ * @return 无返回值。
+ */
+void pool_free(void* ptr)
+{
+    if(ptr==null||(uintn)ptr%8!=0)
+    {
+        return;
+    }
+    pool_tlsf_node* block=(pool_tlsf_node*)((uintn)ptr-sizeof(pool_tlsf_node));
+    pool_arena* owner=(pool_arena*)block->prev;
+    if(pool_is_free(block->csize)||pool_get_size(block->csize)<64||owner==null)
+    {
+        return;
+    }
+
+    uintn flags=memory_irq_save();
+    if(owner==(pool_arena*)get_per_cpu_variable(PER_CPU_POOL))
+    {
+        spinlock_lock(&owner->lock);
+        pool_stat_free(owner,block);
+        pool_arena_free(owner,block);
+        spinlock_unlock(&owner->lock);
     }
     else
     {
-        uintn fl_index=pool_get_fl_index(pool_get_size(block->csize));
-        uintn sl_index=pool_get_sl_index(pool_get_size(block->csize),fl_index);
-        pool_list_add(&pool_meta.free_head[fl_index][sl_index],&pool_meta.free_tail[fl_index][sl_index],
-            block);
-        pool_update_bitmap(fl_index,sl_index);
+        pool_tlsf_node* head=atomic_load_explicit(&owner->remote,MEMORY_ORDER_RELAXED);
+        do
+        {
+            block->next=head;
+        }
+        while(!atomic_compare_exchange_weak_explicit(&owner->remote,&head,block,MEMORY_ORDER_RELEASE,
+            MEMORY_ORDER_RELAXED));
+    }
+    memory_irq_restore(flags);
+}
+
+/**
+ * 代为回收全部CPU区域的远程释放链表，并把各区域内完全空闲的扩展块全部归还页管理器。
+ * 区域锁正被持有的区域跳过，所属CPU在下次申请时自行回收。
+ * 
+ * @return 归还的页数。
+ */
+uintn pool_trim(void)
+{
+    uintn released=0;
+    uintn flags=memory_irq_save();
+    for(uint32 id=0;id<CPU_ID_LIMIT;id++)
+    {
+        pool_arena* arena=(pool_arena*)get_per_cpu_variable_by_id(id,PER_CPU_POOL);
+        if(arena==null||!spinlock_try_lock(&arena->lock))
+        {
+            continue;
+        }
+        pool_arena_drain(arena);
+        if(pool_page_free!=null)
+        {
+            released+=pool_arena_release(arena,0);
+        }
+        spinlock_unlock(&arena->lock);
     }
+    memory_irq_restore(flags);
+    return released;
 }
 
 /**
- * 内核内存池接入页管理器。
+ * 输出内存池统计。逐个CPU区域输出已分配量与峰值、各大小类申请释放次数、
+ * 各二级桶的空闲块数以及最大空闲块所在桶的下界。其他CPU区域的计数为无锁读取，可能略有过时。
+ * 
+ * @param handle 输入输出句柄。
  * 
  * @return 无返回值。
  */
-void memory_pool_attach_page_allocator(void)
+void pool_dump_stats(io_handle* handle)
+{
+    for(uint32 id=0;id<CPU_ID_LIMIT;id++)
+    {
+        pool_arena* arena=(pool_arena*)get_per_cpu_variable_by_id(id,PER_CPU_POOL);
+        if(arena==null)
+        {
+            continue;
+        }
+
+        format_print(handle,"[aos.kernel.memory] Pool arena CPU %u: %N bytes in use, peak %N bytes, "
+            "%N idle extension pages.\n",id,arena->in_use,arena->peak,arena->idle_pages);
+        uint32 fl_bitmap=arena->meta.fl_bitmap;
+        if(fl_bitmap!=0)
+        {
+            uintn fl=31-count_leading_zeros(fl_bitmap);
+            uintn sl=7-count_leading_zeros(arena->meta.sl_bitmap[fl]);
+            format_print(handle,"[aos.kernel.memory]   Largest free block: at least %N bytes.\n",
+                POOL_FREE_MIN[fl][sl]);
+        }
+        for(uintn fl=0;fl<32;fl++)
+        {
+            if(arena->allocs[fl]!=0||arena->frees[fl]!=0)
+            {
+                format_print(handle,"[aos.kernel.memory]   Class [%N,%N): %N allocs, %N frees.\n",
+                    (uintn)BIT6<<fl,(uintn)BIT7<<fl,arena->allocs[fl],arena->frees[fl]);
+            }
+        }
+        for(uintn fl=0;fl<32;fl++)
+        {
+            for(uintn sl=0;sl<8;sl++)
+            {
+                if(arena->meta.free_count[fl][sl]!=0)
+                {
+                    format_print(handle,"[aos.kernel.memory]   Free bucket (%N,%N) from %N bytes: %u blocks.\n",
+                        fl,sl,POOL_FREE_MIN[fl][sl],arena->meta.free_count[fl][sl]);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * 内存池低内存回调结点。
+ */
+static low_memory_callback_node pool_reclaim_node={null,null,pool_trim};
+
+/**
+ * 从伙伴系统申请内存池扩展页面。
+ * 
+ * @param pages 申请页数。
+ * 
+ * @return 申请成功返回直接映射区线性地址。
+ */
+static void* pool_buddy_alloc(uintn pages)
+{
+    uintn base=buddy_alloc(pages);
+    return base==UINTN_MAX?null:memory_phys_to_virt(base);
+}
+
+/**
+ * 向伙伴系统释放内存池扩展页面。
+ * 
+ * @param base  直接映射区线性地址。
+ * @param pages 释放页数。
+ * 
+ * @return 无返回值。
+ */
+static void pool_buddy_free(void* base,uintn pages)
 {
+    buddy_free(memory_virt_to_phys(base),pages);
+}
 
+/**
+ * 内核内存池接入页管理器。扩展页面取自伙伴系统，经直接映射区访问。
+ * 
+ * @return 无返回值。
+ */
+void memory_pool_attach_page_allocator(void)
+{
+    if(pool_page_alloc!=null)
+    {
+        return;
+    }
+    pool_page_alloc=pool_buddy_alloc;
+    pool_page_free=pool_buddy_free;
+    register_low_memory_callback(&pool_reclaim_node);
 }
\ No newline at end of file
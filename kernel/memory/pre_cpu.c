@@ -6,134 +6,418 @@
  * 
  * SPDX-License-Identifier: MIT
  */
+#include <cpu/info.h>
+#include <cpu/per_cpu_vars.h>
+#include <memory/page.h>
+#include <memory/pool.h>
+#include <memory/reclaim.h>
+#include <support/atomic.h>
+#include <support/format.h>
+#include <support/memory.h>
+#include <support/sync.h>
 #include <support/util.h>
+#include "memoryi.h"
 
 /**
- * 每CPU池位图。
+ * 每CPU池容量。
  */
-static uint64 bitmap[8];
+#define PER_CPU_CAPACITY 512
 
 /**
- * 每CPU池。固定容量。
+ * 每CPU已清零页栈容量。
  */
-static uintn pool[512];
+#define PER_CPU_ZEROED_CAPACITY 16
 
 /**
- * 当前池内页面总数。
+ * 共用已清零页栈容量。
  */
-static uintn total=0;
+#define ZEROED_CAPACITY 256
 
 /**
- * 重新平衡每CPU池到一个阈值。
+ * 空闲清零一次从伙伴系统取出的页数。
+ */
+#define ZERO_BATCH 8
+
+/**
+ * 每CPU池与伙伴系统之间一次搬运的页数。
+ */
+const static uintn PER_CPU_BATCH=32;
+
+/**
+ * 每CPU池低水位。池内页数低于该值时批量补充。
+ */
+const static uintn PER_CPU_LOW_WATERMARK=8;
+
+/**
+ * 每CPU池高水位。池内页数高于该值时批量归还。
+ */
+const static uintn PER_CPU_HIGH_WATERMARK=256;
+
+/**
+ * 每CPU已清零页栈从共用栈一次补充的页数。
+ */
+const static uintn PER_CPU_ZEROED_BATCH=8;
+
+/**
+ * 每CPU池。页面以栈方式存取，最近释放的页面最先被复用，缓存更热。
+ * 已清零页另成小栈，空时从共用已清零页栈整批补充，清零页申请不必每次获取共用锁。
+ * 池锁几乎只由所属CPU获取，低内存回收在其他CPU上尝试获取后代为归还。
+ */
+typedef struct _per_cpu_pool
+{
+    spinlock lock;                            /*池锁。*/
+    uintn    count;                           /*当前池内页数。*/
+    uintn    allocs;                          /*申请次数。*/
+    uintn    frees;                           /*释放次数。*/
+    uintn    refills;                         /*从伙伴系统批量补充次数。*/
+    uintn    drains;                          /*向伙伴系统批量归还次数。*/
+    uintn    zeroed_count;                    /*已清零页数。*/
+    uintn    zeroed_hits;                     /*清零页申请命中已清零页的次数。*/
+    uintn    zeroed_misses;                   /*清零页申请同步清零的次数。*/
+    uintn    pages[PER_CPU_CAPACITY];         /*页面基址栈。*/
+    uintn    zeroed[PER_CPU_ZEROED_CAPACITY]; /*已清零页面基址栈。*/
+} per_cpu_pool;
+
+/**
+ * 共用已清零页面基址栈。由空闲CPU清零补充，各CPU整批取到自己的已清零页栈。
+ */
+static uintn zeroed[ZEROED_CAPACITY];
+
+/**
+ * 已清零页数。
+ */
+static uintn zeroed_count=0;
+
+/**
+ * 共用已清零页栈锁。与池锁同时持有时后获取。
+ */
+static spinlock zeroed_lock;
+
+/**
+ * 空闲时清零的总页数。
+ */
+static atomic_uint64 zeroed_total;
+
+/**
+ * 获取当前CPU的每CPU池。
  * 
- * @return 成功填充就返回真。
+ * @return 每CPU池，未初始化返回空指针。
  */
-bool per_cpu_rebalance(void)
+static inline per_cpu_pool* per_cpu_get_pool(void)
 {
-    /*需要伙伴系统支持*/
-    return false;
+    return (per_cpu_pool*)get_per_cpu_variable(PER_CPU_PAGE);
 }
 
 /**
- * 初始化每CPU池。
+ * 从共用已清零页栈取出若干页。调用时已关中断。
  * 
- * @return 初始化成功返回真。
+ * @param pages 页面基址输出数组。
+ * @param count 最多取出的页数。
+ * 
+ * @return 实际取出的页数。
  */
-bool memory_pre_cpu_init(void)
+static uintn zeroed_take(uintn* pages,uintn count)
 {
-    uintn index=0;
-    while(index<512)
-    {
-        pool[index]=0;
-        pool[index+1]=0;
-        pool[index+2]=0;
-        pool[index+3]=0;
-        pool[index+4]=0;
-        pool[index+5]=0;
-        pool[index+6]=0;
-        pool[index+7]=0;
-        index+=8;
-    }
-    bitmap[0]=0;
-    bitmap[1]=0;
-    bitmap[2]=0;
-    bitmap[3]=0;
-    bitmap[4]=0;
-    bitmap[5]=0;
-    bitmap[6]=0;
-    bitmap[7]=0;
-
-    return true;
+    spinlock_lock(&zeroed_lock);
+    count=min(count,zeroed_count);
+    zeroed_count-=count;
+    memory_copy(pages,&zeroed[zeroed_count],count*sizeof(uintn));
+    spinlock_unlock(&zeroed_lock);
+    return count;
 }
 
 /**
- * 向每CPU池申请一块4kB物理页。
+ * 重新平衡每CPU池到水位之间。补充与归还均整批进行，每批只获取一次伙伴系统锁。需持有池锁。
  * 
- * @return 有物理页返回页面基址，物理内存消耗到阈值返回0。
+ * @param pool 每CPU池。
+ * 
+ * @return 池内有可用页面返回真。
  */
-uintn per_cpu_allow(void)
+static bool per_cpu_rebalance(per_cpu_pool* pool)
 {
-    if(total==0&&!per_cpu_rebalance())
+    if(pool->count<PER_CPU_LOW_WATERMARK)
+    {
+        pool->count+=buddy_alloc_batch(&pool->pages[pool->count],PER_CPU_BATCH);
+        pool->refills++;
+    }
+    else if(pool->count>PER_CPU_HIGH_WATERMARK)
     {
-        return 0;
+        pool->count-=PER_CPU_BATCH;
+        pool->drains++;
+        buddy_free_batch(&pool->pages[pool->count],PER_CPU_BATCH);
     }
+    return pool->count!=0;
+}
 
-    uintn index=0;
-    uintn n=0;
-    for(;n<8;n++)
+/**
+ * 把全部CPU每CPU页池中的页面与已清零页归还伙伴系统。池锁正被持有的CPU跳过。
+ * 
+ * @return 归还的页数。
+ */
+uintn per_cpu_drain(void)
+{
+    uintn flags=memory_irq_save();
+    spinlock_lock(&zeroed_lock);
+    uintn pages=zeroed_count;
+    buddy_free_batch(zeroed,zeroed_count);
+    zeroed_count=0;
+    spinlock_unlock(&zeroed_lock);
+    for(uint32 id=0;id<CPU_ID_LIMIT;id++)
     {
-        index=count_trailing_zeros(bitmap[n]);
-        if(index<64)
+        per_cpu_pool* pool=(per_cpu_pool*)get_per_cpu_variable_by_id(id,PER_CPU_PAGE);
+        if(pool==null||!spinlock_try_lock(&pool->lock))
         {
-            break;
+            continue;
         }
+        pages+=pool->count+pool->zeroed_count;
+        buddy_free_batch(pool->pages,pool->count);
+        buddy_free_batch(pool->zeroed,pool->zeroed_count);
+        pool->count=0;
+        pool->zeroed_count=0;
+        spinlock_unlock(&pool->lock);
     }
+    memory_irq_restore(flags);
+    return pages;
+}
 
-    uintn result=pool[index+(n<<6)];
-    pool[index+(n<<6)]=0;
-    bitmap[n]&=~(((uint64)1)<<index);
-    total--;
+/**
+ * 每CPU页池低内存回调结点。
+ */
+static low_memory_callback_node per_cpu_reclaim_node={null,null,per_cpu_drain};
 
+/**
+ * 低内存回调注册状态。
+ */
+static atomic_flag per_cpu_reclaim_registered=ATOMIC_FLAG_INIT;
+
+/**
+ * 初始化当前CPU的每CPU页池。每个CPU在使用单页接口前调用一次。
+ * 
+ * @return 初始化成功返回真。
+ */
+bool memory_per_cpu_init(void)
+{
+    if(per_cpu_get_pool()!=null)
+    {
+        return true;
+    }
+
+    per_cpu_pool* pool=(per_cpu_pool*)pool_alloc(sizeof(per_cpu_pool));
+    if(pool==null)
+    {
+        return false;
+    }
+    memory_zero(pool,sizeof(per_cpu_pool));
+    set_per_cpu_variable(PER_CPU_PAGE,(uint64)pool);
+    if(!atomic_flag_test_and_set(&per_cpu_reclaim_registered))
+    {
+        register_low_memory_callback(&per_cpu_reclaim_node);
+    }
+    return true;
+}
+
+/**
+ * 从当前CPU的每CPU页池取出一页，池空时从伙伴系统批量补充。
+ * 
+ * @return 申请成功返回页面物理基址，申请失败返回0。
+ */
+static uintn per_cpu_take(void)
+{
+    uintn result=0;
+    uintn flags=memory_irq_save();
+    per_cpu_pool* pool=per_cpu_get_pool();
+    if(pool==null)
+    {
+        /*该CPU尚未建立每CPU池，直接使用伙伴系统*/
+        result=buddy_alloc(1);
+        result=result==UINTN_MAX?0:result;
+    }
+    else
+    {
+        spinlock_lock(&pool->lock);
+        if(pool->count>=PER_CPU_LOW_WATERMARK||per_cpu_rebalance(pool))
+        {
+            result=pool->pages[--pool->count];
+            pool->allocs++;
+        }
+        spinlock_unlock(&pool->lock);
+    }
+    memory_irq_restore(flags);
     return result;
 }
 
 /**
- * 向每CPU池释放一块4kB物理页。
+ * 申请一块4kB物理页。优先从当前CPU的每CPU页池取出，快速路径不获取伙伴系统锁。
+ * 伙伴系统也无法满足时触发低内存回收后再尝试一次。
  * 
- * @param addr 要释放的页面基址。
+ * @return 申请成功返回页面物理基址，申请失败返回0。
+ */
+uintn alloc_page(void)
+{
+    uintn result=per_cpu_take();
+    if(result==0&&memory_reclaim()!=0)
+    {
+        result=per_cpu_take();
+    }
+    return result;
+}
+
+/**
+ * 申请一块已清零的4kB物理页。优先取出空闲时清零好的页面，没有时取普通页面同步清零。
+ * 已清零页先从当前CPU的已清零页栈取，栈空时才获取共用锁整批补充。
  * 
- * @return 无返回值。
+ * @return 申请成功返回页面物理基址，申请失败返回0。
  */
-void per_cpu_free(uintn addr)
+uintn alloc_zeroed_page(void)
 {
-    if(addr==0)
+    uintn result=0;
+    uintn flags=memory_irq_save();
+    per_cpu_pool* pool=per_cpu_get_pool();
+    if(pool==null)
     {
-        return;
+        zeroed_take(&result,1);
+    }
+    else
+    {
+        spinlock_lock(&pool->lock);
+        if(pool->zeroed_count==0)
+        {
+            pool->zeroed_count=zeroed_take(pool->zeroed,PER_CPU_ZEROED_BATCH);
+        }
+        if(pool->zeroed_count!=0)
+        {
+            result=pool->zeroed[--pool->zeroed_count];
+            pool->zeroed_hits++;
+        }
+        else
+        {
+            pool->zeroed_misses++;
+        }
+        spinlock_unlock(&pool->lock);
+    }
+    memory_irq_restore(flags);
+    if(result!=0)
+    {
+        return result;
     }
 
-    uintn n=0;
-    for(;n<8;n++)
+    /*马上就要使用，普通存储清零使页面留在缓存中*/
+    result=alloc_page();
+    if(result!=0)
+    {
+        memory_zero(memory_phys_to_virt(result),SIZE_4KB);
+    }
+    return result;
+}
+
+/**
+ * 在空闲时清零页面，补充已清零页栈。页面直接取自伙伴系统，不打乱每CPU池中的热页面；
+ * 使用非临时存储避免污染缓存。由空闲CPU调用，目前是等待中的应用处理器。
+ * 
+ * @param budget 本次最多清零的页数。
+ * 
+ * @return 实际清零的页数。
+ */
+uintn zero_idle_pages(uintn budget)
+{
+    uintn done=0;
+    while(done<budget)
     {
-        if(bitmap[n]!=UINT64_MAX)
+        uintn flags=memory_irq_save();
+        spinlock_lock(&zeroed_lock);
+        uintn room=ZEROED_CAPACITY-zeroed_count;
+        spinlock_unlock(&zeroed_lock);
+        memory_irq_restore(flags);
+        if(room==0)
         {
             break;
         }
+
+        uintn pages[ZERO_BATCH];
+        uintn count=buddy_alloc_batch(pages,min(min(room,budget-done),ZERO_BATCH));
+        if(count==0)
+        {
+            break;
+        }
+        for(uintn index=0;index<count;index++)
+        {
+            memory_zero_nontemporal(memory_phys_to_virt(pages[index]),SIZE_4KB);
+        }
+
+        /*期间其他CPU可能已补满，放不下的页面归还伙伴系统*/
+        flags=memory_irq_save();
+        spinlock_lock(&zeroed_lock);
+        uintn index=0;
+        while(index<count&&zeroed_count<ZEROED_CAPACITY)
+        {
+            zeroed[zeroed_count++]=pages[index++];
+        }
+        spinlock_unlock(&zeroed_lock);
+        memory_irq_restore(flags);
+        atomic_fetch_add_explicit(&zeroed_total,index,MEMORY_ORDER_RELAXED);
+        if(index<count)
+        {
+            buddy_free_batch(&pages[index],count-index);
+        }
+        done+=count;
     }
+    return done;
+}
 
-    if(n<8)
+/**
+ * 释放一块4kB物理页。优先放回当前CPU的每CPU页池，快速路径不获取伙伴系统锁。
+ * 
+ * @param base 页面物理基址。
+ * 
+ * @return 无返回值。
+ */
+void free_page(uintn base)
+{
+    if(base==0)
     {
-        uintn index=count_trailing_zeros(~bitmap[n]);;
-        pool[(n<<6)+index]=addr;
-        bitmap[n]|=((uint64)1)<<index;
-        total++;
+        return;
+    }
+
+    uintn flags=memory_irq_save();
+    per_cpu_pool* pool=per_cpu_get_pool();
+    if(pool==null)
+    {
+        buddy_free(base,1);
     }
     else
     {
-        /*应该直接释放到伙伴系统*/
+        spinlock_lock(&pool->lock);
+        pool->pages[pool->count++]=base;
+        pool->frees++;
+        if(pool->count>PER_CPU_HIGH_WATERMARK)
+        {
+            per_cpu_rebalance(pool);
+        }
+        spinlock_unlock(&pool->lock);
     }
+    memory_irq_restore(flags);
+}
 
-    if(total>500)
+/**
+ * 输出每CPU页池统计。其他CPU的计数为无锁读取，可能略有过时。
+ * 
+ * @param handle 输入输出句柄。
+ * 
+ * @return 无返回值。
+ */
+void per_cpu_dump_stats(io_handle* handle)
+{
+    for(uint32 id=0;id<CPU_ID_LIMIT;id++)
     {
-        per_cpu_rebalance();
+        per_cpu_pool* pool=(per_cpu_pool*)get_per_cpu_variable_by_id(id,PER_CPU_PAGE);
+        if(pool!=null)
+        {
+            format_print(handle,"[aos.kernel.memory] Page cache CPU %u: %N pages, %N allocs, %N frees, "
+                "%N refills, %N drains, %N zeroed pages, %N zeroed hits, %N zeroed misses.\n",id,pool->count,
+                pool->allocs,pool->frees,pool->refills,pool->drains,pool->zeroed_count,pool->zeroed_hits,
+                pool->zeroed_misses);
+        }
     }
+    format_print(handle,"[aos.kernel.memory] Zeroed pages: %N shared, %U zeroed while idle.\n",zeroed_count,
+        atomic_load(&zeroed_total));
 }
\ No newline at end of file
@@ -6,10 +6,34 @@
  * 
  * SPDX-License-Identifier: MIT
  */
+#include <cpu/info.h>
+#include <memory/page.h>
+#include <memory/pool.h>
+#include <memory/ptm.h>
+#include <memory/tlb.h>
 #include <memory/vma.h>
-#include <support/asm.h>
+#include <support/cache.h>
+#include <support/control.h>
+#include <support/format.h>
+#include <support/sync.h>
 #include <support/type.h>
 #include <support/util.h>
+#include "memoryi.h"
+
+/**
+ * 一次刷新批次最多逐条刷新的TLB条目数，超过后改为刷新全部TLB。
+ */
+#define PTM_FLUSH_ENTRIES 32
+
+/**
+ * 一次刷新批次最多暂存的待释放页表页数。
+ */
+#define PTM_FLUSH_TABLES 16
+
+/**
+ * 每CPU分配给用户地址空间的PCID数。PCID 0固定给内核地址空间。
+ */
+#define PTM_ASID_COUNT 6
 
 /**
  * 页表项地址掩码。
@@ -17,48 +41,322 @@
 const uintn PTM_ADDR_MASK=0x000FFFFFFFFFF000ULL;
 
 /**
- * 页表体系高半核映射偏移。
+ * 页表项存在位。
+ */
+const static uint64 PTM_PTE_P=BIT0;
+
+/**
+ * 大页位。仅页目录项与页目录指针项有效，页表项同一位为PAT位。
+ */
+const static uint64 PTM_PTE_PS=BIT7;
+
+/**
+ * 全局位。
+ */
+const static uint64 PTM_PTE_G=BIT8;
+
+/**
+ * 大页PAT位。
+ */
+const static uint64 PTM_PDE_PAT=BIT12;
+
+/**
+ * 非叶页表项标志。权限由叶项决定，中间项全部放开。
+ */
+const static uint64 PTM_TABLE_FLAGS=BIT0|BIT1|BIT2;
+
+/**
+ * 建立映射操作。
+ */
+const static uintn PTM_OP_MAP=0;
+
+/**
+ * 解除映射操作。
+ */
+const static uintn PTM_OP_UNMAP=1;
+
+/**
+ * 修改权限操作。
+ */
+const static uintn PTM_OP_PROTECT=2;
+
+/**
+ * CR3不刷新位。启用PCID时置位则装载CR3不刷新新PCID的TLB。
+ */
+const static uintn PTM_CR3_NOFLUSH=BIT63;
+
+/**
+ * CR4.PCIDE位。
  */
-const uintn PTM_PAGE_TABLE_OFFSET=-10*SIZE_512GB;
+const static uintn PTM_CR4_PCIDE=BIT17;
 
 /**
- * 位图。
+ * TLB刷新批次。修改页表时先收集需要刷新的地址，结束后统一刷新，
+ * 被清空的页表页在刷新后才释放，避免其他路径通过分页结构缓存访问已复用的页面。
  */
-static uint64 bitmap[8];
+typedef struct _ptm_flush
+{
+    ptm_space* space;                     /*地址空间，空指针表示内核地址空间。*/
+    uintn      count;                     /*已收集的地址数。*/
+    uintn      start;                     /*被修改范围起始地址。*/
+    uintn      end;                       /*被修改范围结束地址。*/
+    uintn      table_count;               /*待释放页表页数。*/
+    bool       all;                       /*需要刷新全部TLB。*/
+    bool       global;                    /*涉及全局页。*/
+    uintn      vaddrs[PTM_FLUSH_ENTRIES]; /*待刷新地址。*/
+    uintn      tables[PTM_FLUSH_TABLES];  /*待释放页表页物理地址。*/
+    uintn      levels[PTM_FLUSH_TABLES];  /*待释放页表页层级。*/
+} ptm_flush;
 
 /**
- * 页面缓存池。
+ * CPU上的一个PCID槽位。
  */
-static uint64 pool[512];
+typedef struct _ptm_asid
+{
+    uint64 id;         /*占用的地址空间编号，0表示空闲。*/
+    uint64 generation; /*TLB与之同步的映射代数。*/
+    uint64 used;       /*最近使用时刻，用于淘汰。*/
+} ptm_asid;
+
+/**
+ * 单个CPU的地址空间状态。只由该CPU自己访问。
+ */
+typedef struct _ptm_cpu
+{
+    alignas(64) ptm_space* current;               /*当前地址空间，空指针表示内核地址空间。*/
+    uint64                 clock;                 /*切换计数。*/
+    ptm_asid               asids[PTM_ASID_COUNT]; /*PCID槽位，下标加1为PCID。*/
+} ptm_cpu;
 
 /**
  * 不可执行位功能状态。
  */
 static bool nx_status=false;
 
+/**
+ * 1GB大页功能状态。
+ */
+static bool page1gb_status=false;
+
 /**
  * 五级分页状态。
  */
 static bool pml5_status=false;
 
+/**
+ * PCID功能状态。
+ */
+static bool pcid_status=false;
+
+/**
+ * INVPCID功能状态。
+ */
+static bool invpcid_status=false;
+
+/**
+ * 用户地址空间功能状态。内核根页表上半部各项全部建立后才能创建用户地址空间。
+ */
+static bool space_status=false;
+
+/**
+ * 内核根页表物理地址。
+ */
+static uintn kernel_root=0;
+
 /**
  * 内核根页表。
  */
 static uint64* kernel_pml=null;
 
 /**
- * 检查在4级分页下映射一块线性区域需要多少页来构建页表。
+ * 页表锁。
+ */
+static spinlock lock;
+
+/**
+ * 下一个地址空间编号。
+ */
+static uint64 next_space_id=1;
+
+/**
+ * 每CPU地址空间状态。按CPU编号索引。
+ */
+static ptm_cpu ptm_cpus[CPU_ID_LIMIT];
+
+/**
+ * 初始化刷新批次。
+ * 
+ * @param flush 刷新批次。
+ * 
+ * @return 无返回值。
+ */
+static inline void ptm_flush_init(ptm_flush* flush,ptm_space* space)
+{
+    flush->space=space;
+    flush->count=0;
+    flush->start=UINTN_MAX;
+    flush->end=0;
+    flush->table_count=0;
+    flush->all=false;
+    flush->global=false;
+}
+
+/**
+ * 向刷新批次加入一个被修改的叶项。大页只需刷新一次。
+ * 
+ * @param flush 刷新批次。
+ * @param vaddr 叶项映射的线性基址。
+ * @param size  叶项映射大小。
+ * @param entry 修改前的叶项。
+ * 
+ * @return 无返回值。
+ */
+static void ptm_flush_add(ptm_flush* flush,uintn vaddr,uintn size,uint64 entry)
+{
+    flush->start=min(flush->start,vaddr);
+    /*地址空间最高处的叶项结束地址会回绕，按最大值记录*/
+    flush->end=max(flush->end,vaddr+size==0?UINTN_MAX:vaddr+size);
+    if(entry&PTM_PTE_G)
+    {
+        flush->global=true;
+    }
+    else if(flush->space==null&&pcid_status)
+    {
+        /*内核非全局页可能缓存在每个用户PCID中，只能刷新全部PCID*/
+        flush->all=true;
+        flush->global=true;
+    }
+    if(flush->all)
+    {
+        return;
+    }
+    if(flush->count==PTM_FLUSH_ENTRIES)
+    {
+        flush->all=true;
+        return;
+    }
+    flush->vaddrs[flush->count++]=vaddr;
+}
+
+/**
+ * 查找CPU上分配给地址空间的PCID槽位。
+ * 
+ * @param cpu   地址空间状态。
+ * @param space 地址空间。
+ * 
+ * @return 槽位下标，不存在返回PTM_ASID_COUNT。
+ */
+static uintn ptm_asid_find(ptm_cpu* cpu,ptm_space* space)
+{
+    for(uintn index=0;index<PTM_ASID_COUNT;index++)
+    {
+        if(cpu->asids[index].id==space->id)
+        {
+            return index;
+        }
+    }
+    return PTM_ASID_COUNT;
+}
+
+/**
+ * 执行刷新批次，先刷新当前CPU，再击落其他CPU，全部完成后才释放暂存的页表页。
+ * 用户地址空间不在当前CPU上使用时，若其PCID仍与映射代数同步，则用INVPCID定向刷新并保持同步，
+ * 否则依靠代数递增在切换回来时刷新。
  * 
- * @param pml4   四级分页的PML4页表。
- * @param vaddr  线性区域基址。
- * @param paddr  物理区域基址。
- * @param pages  区域页数。
+ * @param flush 刷新批次。
  * 
- * @return 返回所需页数。
+ * @return 无返回值。
  */
-static uintn ptm_calculate_pml4_required_pages(uint64* pml4,uintn vaddr,uintn paddr,uintn pages)
+static void ptm_flush_finish(ptm_flush* flush)
 {
+    ptm_space* space=flush->space;
+    uint32 id=get_current_cpu_id();
+    ptm_cpu* cpu=id<CPU_ID_LIMIT?&ptm_cpus[id]:null;
+    bool local=space==null||(cpu!=null&&cpu->current==space);
+    uintn slot=PTM_ASID_COUNT;
+    if(space!=null&&pcid_status&&cpu!=null)
+    {
+        slot=ptm_asid_find(cpu,space);
+        if(slot<PTM_ASID_COUNT&&cpu->asids[slot].generation!=atomic_load(&space->tlb.generation))
+        {
+            slot=PTM_ASID_COUNT;
+        }
+        if(!local&&!invpcid_status)
+        {
+            slot=PTM_ASID_COUNT;
+        }
+    }
+
+    if(local)
+    {
+        if(flush->all)
+        {
+            tlb_flush_all(flush->global);
+        }
+        else
+        {
+            for(uintn index=0;index<flush->count;index++)
+            {
+                x86_flush_single_tlb(flush->vaddrs[index]);
+            }
+        }
+    }
+    else if(slot<PTM_ASID_COUNT)
+    {
+        if(flush->all)
+        {
+            x86_invpcid(X86_INVPCID_CONTEXT,slot+1,0);
+        }
+        else
+        {
+            for(uintn index=0;index<flush->count;index++)
+            {
+                x86_invpcid(X86_INVPCID_ADDRESS,slot+1,flush->vaddrs[index]);
+            }
+        }
+    }
+
+    if(flush->start<flush->end)
+    {
+        tlb_space* tlb=space==null?null:&space->tlb;
+        if(flush->all)
+        {
+            tlb_shootdown(tlb,0,UINTN_MAX,flush->global,flush->table_count!=0);
+        }
+        else
+        {
+            tlb_shootdown(tlb,flush->start,flush->end,flush->global,flush->table_count!=0);
+        }
+        if(slot<PTM_ASID_COUNT)
+        {
+            /*修改在页表锁内串行，代数只被本次击落递增，当前CPU已刷新过*/
+            cpu->asids[slot].generation=atomic_load(&space->tlb.generation);
+        }
+    }
+    for(uintn index=0;index<flush->table_count;index++)
+    {
+        ptp_free(flush->tables[index],flush->levels[index]);
+    }
+    ptm_flush_init(flush,space);
+}
 
+/**
+ * 暂存一页被清空的页表页，待刷新后释放。暂存区满时提前执行刷新。
+ * 
+ * @param flush 刷新批次。
+ * @param page  页表页物理地址。
+ * @param level 页表页层级。
+ * 
+ * @return 无返回值。
+ */
+static void ptm_flush_free_table(ptm_flush* flush,uintn page,uintn level)
+{
+    if(flush->table_count==PTM_FLUSH_TABLES)
+    {
+        ptm_flush_finish(flush);
+    }
+    flush->tables[flush->table_count]=page;
+    flush->levels[flush->table_count++]=level;
 }
 
 /**
@@ -183,83 +481,785 @@ static bool ptm_pt_is_empty(uint64* pt)
 }
 
 /**
- * 将页表内指定线性地址解除映射。
+ * 获取层级一项覆盖的线性地址位移。层级1为页表，层级5为PML5。
  * 
- * @param pt    页表地址。
- * @param vaddr 映射起始地址。
- * @param pages 映射页数。
+ * @param level 页表层级。
  * 
- * @return 无返回值。
+ * @return 地址位移。
  */
-static void ptm_pte_unmap(uint64* pt,uintn vaddr,uintn pages)
+static inline uintn ptm_level_shift(uintn level)
 {
-    uintn index=(vaddr>>12)&0x1FF;
-    while(pages>0)
+    return 12+9*(level-1);
+}
+
+/**
+ * 判断页表项是否为叶项。
+ * 
+ * @param entry 存在的页表项。
+ * @param level 页表层级。
+ * 
+ * @return 为叶项返回真。
+ */
+static inline bool ptm_is_leaf(uint64 entry,uintn level)
+{
+    return level==1||(entry&PTM_PTE_PS);
+}
+
+/**
+ * 判断能否在层级直接建立叶项。页表总能建立，页目录需2MB对齐，页目录指针需1GB对齐且硬件支持。
+ * 
+ * @param level 页表层级。
+ * @param paddr 物理地址。
+ * 
+ * @return 能建立叶项返回真。
+ */
+static inline bool ptm_leaf_allowed(uintn level,uintn paddr)
+{
+    switch(level)
     {
-        pt[index]=0;
-        index++;
-        pages--;
+        case 1:
+            return true;
+        case 2:
+            return is_aligned(paddr,SIZE_2MB);
+        case 3:
+            return page1gb_status&&is_aligned(paddr,SIZE_1GB);
+        default:
+            return false;
     }
 }
 
 /**
- * 将页表内指定线性地址解除映射并清除对应TLB条目。
+ * 构造叶项。页表标志组同时带有两种PAT位，按层级保留其中一个。
  * 
- * @param pt    页表地址。
- * @param vaddr 映射起始地址。
- * @param pages 映射页数。
+ * @param paddr  物理地址。
+ * @param pflags 页表标志组。
+ * @param level  页表层级。
  * 
- * @return 无返回值。
+ * @return 叶项。
+ */
+static inline uint64 ptm_make_leaf(uintn paddr,uint64 pflags,uintn level)
+{
+    if(level==1)
+    {
+        return paddr|(pflags&~PTM_PDE_PAT)|PTM_PTE_P;
+    }
+    return paddr|pflags|PTM_PTE_PS|PTM_PTE_P;
+}
+
+/**
+ * 获取叶项的物理地址。
+ * 
+ * @param entry 叶项。
+ * @param level 页表层级。
+ * 
+ * @return 物理地址。
+ */
+static inline uintn ptm_leaf_paddr(uint64 entry,uintn level)
+{
+    return entry&PTM_ADDR_MASK&~(((uintn)1<<ptm_level_shift(level))-1);
+}
+
+/**
+ * 从叶项还原页表标志组。
+ * 
+ * @param entry 叶项。
+ * @param level 页表层级。
+ * 
+ * @return 页表标志组。
+ */
+static inline uint64 ptm_leaf_pflags(uint64 entry,uintn level)
+{
+    uint64 pflags=entry&~PTM_ADDR_MASK&~PTM_PTE_P;
+    if(level==1)
+    {
+        return (pflags&PTM_PTE_PS)?pflags|PTM_PDE_PAT:pflags;
+    }
+    pflags&=~PTM_PTE_PS;
+    return (entry&PTM_PDE_PAT)?pflags|PTM_PDE_PAT|PTM_PTE_PS:pflags;
+}
+
+/**
+ * 把大页拆分为下一层级的页表，保持原有映射不变。
+ * 
+ * @param table 页表。
+ * @param index 大页所在项下标。
+ * @param level 页表层级。
+ * @param vaddr 大页线性基址。
+ * @param flush 刷新批次。
+ * 
+ * @return 成功拆分返回真，内存不足返回假。
+ */
+static bool ptm_split(uint64* table,uintn index,uintn level,uintn vaddr,ptm_flush* flush)
+{
+    uintn page=ptp_alloc(level-1);
+    if(page==0)
+    {
+        return false;
+    }
+    uint64 entry=table[index];
+    uint64* child=(uint64*)memory_phys_to_virt(page);
+    uintn paddr=ptm_leaf_paddr(entry,level);
+    uint64 pflags=ptm_leaf_pflags(entry,level);
+    uintn step=(uintn)1<<ptm_level_shift(level-1);
+    for(uintn slot=0;slot<512;slot++)
+    {
+        child[slot]=ptm_make_leaf(paddr+slot*step,pflags,level-1);
+    }
+    table[index]=page|PTM_TABLE_FLAGS;
+
+    /*页大小改变后旧的大页TLB条目需要刷新*/
+    ptm_flush_add(flush,vaddr,step*512,entry);
+    return true;
+}
+
+/**
+ * 在一级页表内执行映射操作，遇到非叶项时递归进入下一级。
+ * 
+ * @param table  页表。
+ * @param level  页表层级。
+ * @param vaddr  线性起始地址。
+ * @param paddr  物理起始地址，仅建立映射时有效。
+ * @param pages  页数。
+ * @param pflags 页表标志组，解除映射时无效。
+ * @param op     映射操作。
+ * @param flush  刷新批次。
+ * 
+ * @return 成功返回真，申请页表页失败返回假。
  */
-static void ptm_pte_unmap_flush(uint64* pt,uintn vaddr,uintn pages)
+static bool ptm_table_update(uint64* table,uintn level,uintn vaddr,uintn paddr,uintn pages,uint64 pflags,
+    uintn op,ptm_flush* flush)
 {
-    uintn index=(vaddr>>12)&0x1FF;
+    uintn shift=ptm_level_shift(level);
+    uintn span=(uintn)1<<(shift-12);
     while(pages>0)
     {
-        pt[index]=0;
-        flush_single_tlb(vaddr);
-        index++;
-        vaddr+=SIZE_4KB;
-        pages--;
+        uintn index=(vaddr>>shift)&0x1FF;
+        uintn block=min(span-((vaddr>>12)&(span-1)),pages);
+        uint64 entry=table[index];
+
+        /*整项被覆盖时直接改写叶项，建立映射还需满足大页对齐*/
+        bool whole=block==span&&(op!=PTM_OP_MAP||ptm_leaf_allowed(level,paddr));
+        bool descend=true;
+        if(!(entry&PTM_PTE_P))
+        {
+            if(op!=PTM_OP_MAP)
+            {
+                descend=false;
+            }
+            else if(whole)
+            {
+                table[index]=ptm_make_leaf(paddr,pflags,level);
+                descend=false;
+            }
+            else
+            {
+                uintn page=ptp_alloc(level-1);
+                if(page==0)
+                {
+                    return false;
+                }
+                table[index]=page|PTM_TABLE_FLAGS;
+            }
+        }
+        else if(ptm_is_leaf(entry,level))
+        {
+            if(whole)
+            {
+                if(op==PTM_OP_UNMAP)
+                {
+                    table[index]=0;
+                }
+                else
+                {
+                    uintn base=op==PTM_OP_MAP?paddr:ptm_leaf_paddr(entry,level);
+                    table[index]=ptm_make_leaf(base,pflags,level);
+                }
+                ptm_flush_add(flush,vaddr&~((span<<12)-1),span<<12,entry);
+                descend=false;
+            }
+            else if(!ptm_split(table,index,level,vaddr&~((span<<12)-1),flush))
+            {
+                return false;
+            }
+        }
+
+        if(descend)
+        {
+            uintn page=table[index]&PTM_ADDR_MASK;
+            uint64* child=(uint64*)memory_phys_to_virt(page);
+            if(!ptm_table_update(child,level-1,vaddr,paddr,block,pflags,op,flush))
+            {
+                return false;
+            }
+            /*内核根页表上半部的项被用户地址空间共享，不能回收*/
+            if(op==PTM_OP_UNMAP&&(table!=kernel_pml||index<256)&&ptm_pt_is_empty(child))
+            {
+                table[index]=0;
+                ptm_flush_free_table(flush,page,level-1);
+            }
+        }
+        pages-=block;
+        vaddr+=block<<12;
+        paddr+=block<<12;
+    }
+    return true;
+}
+
+/**
+ * 检查映射范围。用户地址空间只能使用下半部。
+ * 
+ * @param space 地址空间。
+ * @param vaddr 线性起始地址。
+ * @param pages 页数。
+ * 
+ * @return 范围合法返回真。
+ */
+static inline bool ptm_range_valid(ptm_space* space,uintn vaddr,uintn pages)
+{
+    if(kernel_pml==null||pages==0||!is_aligned(vaddr,SIZE_4KB)||pages-1>(UINTN_MAX-vaddr)>>12)
+    {
+        return false;
     }
+    uintn half=(uintn)1<<(pml5_status?56:47);
+    return space==null||(vaddr<half&&pages<=(half-vaddr)>>12);
 }
 
 /**
- * 将页目录内指定线性地址解除映射。
+ * 在页表中执行一次映射操作并刷新TLB。
  * 
- * @param pd    页目录地址。
- * @param vaddr 映射起始地址。
- * @param pages 映射页数。
+ * @param space  地址空间。
+ * @param vaddr  线性起始地址。
+ * @param paddr  物理起始地址。
+ * @param pages  页数。
+ * @param pflags 页表标志组。
+ * @param op     映射操作。
  * 
- * @return 无返回值。
+ * @return 成功返回真。
+ */
+static bool ptm_update(ptm_space* space,uintn vaddr,uintn paddr,uintn pages,uint64 pflags,uintn op)
+{
+    ptm_flush flush;
+    ptm_flush_init(&flush,space);
+    uintn level=pml5_status?5:4;
+    uint64* root=space==null?kernel_pml:(uint64*)memory_phys_to_virt(space->root);
+
+    spinlock_lock(&lock);
+    bool result=ptm_table_update(root,level,vaddr,paddr,pages,pflags,op,&flush);
+    if(!result&&op==PTM_OP_MAP)
+    {
+        /*解除映射只会拆分已被部分覆盖的大页，建立映射中途失败时不会再失败*/
+        ptm_table_update(root,level,vaddr,0,pages,0,PTM_OP_UNMAP,&flush);
+    }
+    ptm_flush_finish(&flush);
+    spinlock_unlock(&lock);
+    return result;
+}
+
+/**
+ * 在页表中建立映射。对齐允许时自动使用2MB与1GB大页，已有映射会被覆盖。
+ * 
+ * @param space 地址空间，空指针表示内核地址空间。用户地址空间只能映射下半部。
+ * @param vaddr 线性起始地址，需按4KB对齐。
+ * @param paddr 物理起始地址，需按4KB对齐。
+ * @param pages 页数。
+ * @param flags VMA标志组，决定权限与内存类型。
+ * 
+ * @return 成功映射返回真。失败时范围内映射全部解除。
+ */
+bool ptm_map(ptm_space* space,uintn vaddr,uintn paddr,uintn pages,uint64 flags)
+{
+    if(!ptm_range_valid(space,vaddr,pages)||!is_aligned(paddr,SIZE_4KB))
+    {
+        return false;
+    }
+    if((flags&VMA_FLAG_HUGEPAGE)&&!(is_aligned(vaddr,SIZE_2MB)&&is_aligned(paddr,SIZE_2MB)&&(pages&0x1FF)==0))
+    {
+        /*要求大页但对齐不允许*/
+        return false;
+    }
+    uint64 pflags=ptm_vflags_to_pflags(flags);
+    if(pflags==UINT64_MAX)
+    {
+        return false;
+    }
+    return ptm_update(space,vaddr,paddr,pages,pflags,PTM_OP_MAP);
+}
+
+/**
+ * 解除页表中的映射。只覆盖部分大页时会先拆分大页。
+ * 
+ * @param space 地址空间，空指针表示内核地址空间。
+ * @param vaddr 线性起始地址，需按4KB对齐。
+ * @param pages 页数。
+ * 
+ * @return 成功解除返回真，拆分大页内存不足返回假。
+ */
+bool ptm_unmap(ptm_space* space,uintn vaddr,uintn pages)
+{
+    if(!ptm_range_valid(space,vaddr,pages))
+    {
+        return false;
+    }
+    return ptm_update(space,vaddr,0,pages,0,PTM_OP_UNMAP);
+}
+
+/**
+ * 修改页表中已有映射的权限与内存类型，未映射的部分保持不变。
+ * 
+ * @param space 地址空间，空指针表示内核地址空间。
+ * @param vaddr 线性起始地址，需按4KB对齐。
+ * @param pages 页数。
+ * @param flags VMA标志组。
+ * 
+ * @return 成功修改返回真。
+ */
+bool ptm_protect(ptm_space* space,uintn vaddr,uintn pages,uint64 flags)
+{
+    uint64 pflags=ptm_vflags_to_pflags(flags);
+    if(!ptm_range_valid(space,vaddr,pages)||pflags==UINT64_MAX)
+    {
+        return false;
+    }
+    return ptm_update(space,vaddr,0,pages,pflags,PTM_OP_PROTECT);
+}
+
+/**
+ * 从页表标志组还原VMA标志组。按PAT设置还原内存类型，写保护类型没有对应的VMA类型，记为保留。
+ * 
+ * @param pflags 页表标志组。
+ * 
+ * @return VMA标志组。
+ */
+static uint64 ptm_pflags_to_vflags(uint64 pflags)
+{
+    uint64 flags=VMA_FLAG_READ;
+    if(pflags&BIT1)
+    {
+        flags|=VMA_FLAG_WRITE;
+    }
+    if(!(pflags&BIT63))
+    {
+        flags|=VMA_FLAG_EXECUTE;
+    }
+    if(pflags&BIT2)
+    {
+        flags|=VMA_FLAG_USER;
+    }
+    if(pflags&PTM_PTE_G)
+    {
+        flags|=VMA_FLAG_GLOBAL;
+    }
+
+    /*PAT项依次为WB、WT、UC-、UC、WC、WP、UC-、UC*/
+    uintn index=((pflags>>3)&0x3)|((pflags&PTM_PDE_PAT)?0x4:0);
+    switch(index)
+    {
+        case 0:
+            return flags|VMA_TYPE_MEMORY;
+        case 1:
+            return flags|VMA_TYPE_READ_OPTIMIZED_DEVICE;
+        case 4:
+            return flags|VMA_TYPE_WRITE_OPTIMIZED_DEVICE;
+        case 5:
+            return flags|VMA_TYPE_RESERVED;
+        default:
+            return flags|VMA_TYPE_DEVICE;
+    }
+}
+
+/**
+ * 把一段叶项映射并入当前连续段。无法合并时先把当前连续段交给访问函数。
+ * 
+ * @param run     当前连续段。
+ * @param vaddr   线性起始地址。
+ * @param paddr   物理起始地址。
+ * @param pages   页数。
+ * @param size    页大小。
+ * @param flags   VMA标志组。
+ * @param visitor 访问函数。
+ * @param context 访问函数上下文。
+ * 
+ * @return 继续遍历返回真，访问函数要求停止返回假。
+ */
+static bool ptm_walk_emit(ptm_run* run,uintn vaddr,uintn paddr,uintn pages,uintn size,uint64 flags,
+    ptm_visitor visitor,void* context)
+{
+    if(run->pages!=0&&run->size==size&&run->flags==flags&&run->vaddr+(run->pages<<12)==vaddr&&
+        run->paddr+(run->pages<<12)==paddr)
+    {
+        run->pages+=pages;
+        return true;
+    }
+    if(run->pages!=0&&!visitor(run,context))
+    {
+        return false;
+    }
+    run->vaddr=vaddr;
+    run->paddr=paddr;
+    run->pages=pages;
+    run->size=size;
+    run->flags=flags;
+    return true;
+}
+
+/**
+ * 遍历一级页表中的叶项。
+ * 
+ * @param table   页表。
+ * @param level   页表层级。
+ * @param vaddr   线性起始地址。
+ * @param pages   页数。
+ * @param run     当前连续段。
+ * @param visitor 访问函数。
+ * @param context 访问函数上下文。
+ * 
+ * @return 继续遍历返回真，访问函数要求停止返回假。
  */
-static void ptm_pde_unmap(uint64* pd,uintn vaddr,uintn pages)
+static bool ptm_walk_table(uint64* table,uintn level,uintn vaddr,uintn pages,ptm_run* run,ptm_visitor visitor,
+    void* context)
 {
+    uintn shift=ptm_level_shift(level);
+    uintn span=(uintn)1<<(shift-12);
     while(pages>0)
     {
-        uintn index=(vaddr>>21)&0x1FF;
-        uintn block=0x200-((vaddr>>12)&0x1FF);
-        block=min(block,pages);
-        uint64 pde=pd[index];
-        if(pde&BIT0)
+        uintn index=(vaddr>>shift)&0x1FF;
+        uintn block=min(span-((vaddr>>12)&(span-1)),pages);
+        /*无锁读取，页表项只读一次*/
+        uint64 entry=((volatile uint64*)table)[index];
+        if(entry&PTM_PTE_P)
         {
-            /*大页PS位*/
-            if(pde&BIT7)
+            if(ptm_is_leaf(entry,level))
             {
-                pd[index]=0;
+                uintn paddr=ptm_leaf_paddr(entry,level)+(vaddr&((span<<12)-1));
+                uint64 flags=ptm_pflags_to_vflags(ptm_leaf_pflags(entry,level));
+                if(!ptm_walk_emit(run,vaddr,paddr,block,span<<12,flags,visitor,context))
+                {
+                    return false;
+                }
             }
             else
             {
-                uint64* pt=(uint64*)((pde&PTM_ADDR_MASK)+PTM_PAGE_TABLE_OFFSET);
-                ptm_pte_unmap(pt,vaddr,block);
-                if(ptm_pt_is_empty(pt))
+                uint64* child=(uint64*)memory_phys_to_virt(entry&PTM_ADDR_MASK);
+                if(!ptm_walk_table(child,level-1,vaddr,block,run,visitor,context))
                 {
-                    ptm_page_free(pt);
-                    pd[index]=0;
+                    return false;
                 }
             }
         }
         pages-=block;
         vaddr+=block<<12;
     }
+    return true;
+}
+
+/**
+ * 遍历页表中的映射，按连续段报告。线性与物理地址都连续且页大小与标志组相同的叶项合并为一段，
+ * 非规范地址空洞自动跳过。遍历不持有页表锁，期间释放的页表页不会被复用，但可能看到正在修改的映射。
+ * 访问函数在禁止复用页表页的区间内调用，不能睡眠。
+ * 
+ * @param space   地址空间，空指针表示内核地址空间。用户地址空间只遍历下半部。
+ * @param vaddr   线性起始地址，需按4KB对齐。
+ * @param pages   页数。
+ * @param visitor 访问函数。
+ * @param context 访问函数上下文。
+ * 
+ * @return 遍历完成返回真，参数不合法或访问函数要求停止返回假。
+ */
+bool ptm_walk(ptm_space* space,uintn vaddr,uintn pages,ptm_visitor visitor,void* context)
+{
+    if(kernel_pml==null||visitor==null||pages==0||!is_aligned(vaddr,SIZE_4KB)||pages-1>(UINTN_MAX-vaddr)>>12)
+    {
+        return false;
+    }
+    uintn level=pml5_status?5:4;
+    uintn half=(uintn)1<<(pml5_status?56:47);
+    uintn last=vaddr+((pages-1)<<12);
+    uint64* root=space==null?kernel_pml:(uint64*)memory_phys_to_virt(space->root);
+    ptm_run run={0};
+    bool result=true;
+
+    ptp_read_lock();
+    if(vaddr<half)
+    {
+        uintn lower=(half-vaddr)>>12;
+        result=ptm_walk_table(root,level,vaddr,min(pages,lower),&run,visitor,context);
+    }
+    if(result&&space==null&&last>=0-half)
+    {
+        uintn start=max(vaddr,0-half);
+        result=ptm_walk_table(root,level,start,((last-start)>>12)+1,&run,visitor,context);
+    }
+    if(result&&run.pages!=0)
+    {
+        result=visitor(&run,context);
+    }
+    ptp_read_unlock();
+    return result;
+}
+
+/**
+ * 页表输出上下文。
+ */
+typedef struct _ptm_dump_context
+{
+    io_handle* handle; /*输入输出句柄。*/
+    uintn      runs;   /*连续段数。*/
+    uintn      pages;  /*4KB页数。*/
+} ptm_dump_context;
+
+/**
+ * 输出一个连续段。
+ * 
+ * @param run     连续段。
+ * @param context 输出上下文。
+ * 
+ * @return 总是返回真。
+ */
+static bool ptm_dump_run(const ptm_run* run,void* context)
+{
+    ptm_dump_context* dump=(ptm_dump_context*)context;
+    const static char8* const TYPE_NAMES[]={"WP","WB","UC","WT","WC"};
+    uintn type=run->flags&VMA_TYPE_MASK;
+    const char8* size=run->size==SIZE_1GB?"1G":run->size==SIZE_2MB?"2M":"4K";
+    uintn count=(run->pages+(run->size>>12)-1)/(run->size>>12);
+    format_print(dump->handle,"[aos.kernel.memory]   %p-%p -> %p %s %c%c%c%c%c %s x%N\n",run->vaddr,
+        run->vaddr+(run->pages<<12)-1,run->paddr,size,
+        (run->flags&VMA_FLAG_READ)?'R':'-',(run->flags&VMA_FLAG_WRITE)?'W':'-',
+        (run->flags&VMA_FLAG_EXECUTE)?'X':'-',(run->flags&VMA_FLAG_USER)?'U':'-',
+        (run->flags&VMA_FLAG_GLOBAL)?'G':'-',type<5?TYPE_NAMES[type]:"??",count);
+    dump->runs++;
+    dump->pages+=run->pages;
+    return true;
+}
+
+/**
+ * 输出页表中的映射，每个连续段一行：线性范围、物理起始地址、页大小、权限、内存类型与页数。
+ * 可在恐慌路径与测试中使用。
+ * 
+ * @param handle 输入输出句柄。要求其可写能力。
+ * @param space  地址空间，空指针表示内核地址空间。
+ * @param vaddr  线性起始地址，需按4KB对齐。
+ * @param pages  页数。
+ * 
+ * @return 无返回值。
+ */
+void ptm_dump(io_handle* handle,ptm_space* space,uintn vaddr,uintn pages)
+{
+    if(handle==null)
+    {
+        return;
+    }
+    ptm_dump_context dump={handle,0,0};
+    format_print(handle,"[aos.kernel.memory] Page table mappings of %s space:\n",space==null?"kernel":"user");
+    ptm_walk(space,vaddr,pages,ptm_dump_run,&dump);
+    format_print(handle,"[aos.kernel.memory]   %N runs, %N 4KB pages mapped.\n",dump.runs,dump.pages);
+}
+
+/**
+ * 创建用户地址空间。根页表上半部复制内核根页表项。
+ * 
+ * @return 成功创建返回地址空间，失败返回空指针。
+ */
+ptm_space* ptm_space_create(void)
+{
+    if(!space_status)
+    {
+        return null;
+    }
+    ptm_space* space=(ptm_space*)pool_alloc(sizeof(ptm_space));
+    if(space==null)
+    {
+        return null;
+    }
+    tlb_space_init(&space->tlb);
+
+    spinlock_lock(&lock);
+    uintn root=ptp_alloc(pml5_status?5:4);
+    if(root==0)
+    {
+        spinlock_unlock(&lock);
+        pool_free(space);
+        return null;
+    }
+    /*内核上半部的根页表项在初始化时已全部建立，此后不变，复制一次即可*/
+    uint64* table=(uint64*)memory_phys_to_virt(root);
+    for(uintn index=256;index<512;index++)
+    {
+        table[index]=kernel_pml[index];
+    }
+    space->root=root;
+    space->id=next_space_id++;
+    spinlock_unlock(&lock);
+    return space;
+}
+
+/**
+ * 销毁用户地址空间，解除下半部全部映射并回收页表页。调用时不能有CPU正在使用它。
+ * 
+ * @param space 地址空间。
+ * 
+ * @return 无返回值。
+ */
+void ptm_space_destroy(ptm_space* space)
+{
+    if(space==null)
+    {
+        return;
+    }
+    uintn half=(uintn)1<<(pml5_status?56:47);
+    ptm_update(space,0,0,half>>12,0,PTM_OP_UNMAP);
+
+    /*编号不复用，各CPU残留的PCID槽位不会再命中，槽位被复用时才刷新*/
+    spinlock_lock(&lock);
+    uint64* table=(uint64*)memory_phys_to_virt(space->root);
+    for(uintn index=256;index<512;index++)
+    {
+        table[index]=0;
+    }
+    ptp_free(space->root,pml5_status?5:4);
+    spinlock_unlock(&lock);
+    pool_free(space);
+}
+
+/**
+ * 为地址空间分配当前CPU上的PCID并生成CR3的值。代数未变时保留TLB，
+ * 否则用INVPCID或不带不刷新位的CR3刷新该PCID。
+ * 
+ * @param cpu        地址空间状态。
+ * @param space      地址空间。
+ * @param generation 加入活跃掩码时的映射代数。
+ * 
+ * @return CR3的值。
+ */
+static uintn ptm_asid_load(ptm_cpu* cpu,ptm_space* space,uint64 generation)
+{
+    uintn slot=ptm_asid_find(cpu,space);
+    bool fresh=slot<PTM_ASID_COUNT&&cpu->asids[slot].generation==generation;
+    if(slot==PTM_ASID_COUNT)
+    {
+        /*淘汰最久未用的槽位*/
+        slot=0;
+        for(uintn index=1;index<PTM_ASID_COUNT;index++)
+        {
+            if(cpu->asids[index].used<cpu->asids[slot].used)
+            {
+                slot=index;
+            }
+        }
+        cpu->asids[slot].id=space->id;
+    }
+    cpu->asids[slot].generation=generation;
+    cpu->asids[slot].used=++cpu->clock;
+
+    uintn cr3=space->root|(slot+1);
+    if(fresh)
+    {
+        return cr3|PTM_CR3_NOFLUSH;
+    }
+    if(invpcid_status)
+    {
+        x86_invpcid(X86_INVPCID_CONTEXT,slot+1,0);
+        return cr3|PTM_CR3_NOFLUSH;
+    }
+    return cr3;
+}
+
+/**
+ * 当前CPU切换到地址空间。启用PCID时每个CPU为最近使用的地址空间保留PCID，
+ * 切换回来时若映射代数未变则保留其TLB，否则只刷新该PCID。
+ * 
+ * @param space 地址空间，空指针表示只使用内核地址空间。
+ * 
+ * @return 无返回值。
+ */
+void ptm_space_switch(ptm_space* space)
+{
+    uint32 id=get_current_cpu_id();
+    if(id>=CPU_ID_LIMIT||kernel_pml==null)
+    {
+        return;
+    }
+    ptm_cpu* cpu=&ptm_cpus[id];
+    uintn flags=memory_irq_save();
+    ptm_space* previous=cpu->current;
+    if(previous!=space)
+    {
+        uintn cr3;
+        if(space==null)
+        {
+            /*内核地址空间的击落发往全部在线CPU，PCID 0中的条目总是最新*/
+            cr3=kernel_root|(pcid_status?PTM_CR3_NOFLUSH:0);
+        }
+        else
+        {
+            uint64 generation=tlb_space_activate(&space->tlb);
+            cr3=pcid_status?ptm_asid_load(cpu,space,generation):space->root;
+        }
+        cpu->current=space;
+        x86_write_cr3(cr3);
+
+        /*装载新页表后才退出旧地址空间的活跃掩码，此前的击落仍会发到当前CPU*/
+        if(previous!=null)
+        {
+            tlb_space_deactivate(&previous->tlb);
+        }
+    }
+    memory_irq_restore(flags);
+}
+
+/**
+ * 初始化页表管理系统，接管启动阶段建立的内核页表。
+ * 
+ * @param params 启动参数。
+ * 
+ * @return 无返回值。
+ */
+void memory_ptm_init(aos_boot_params* params)
+{
+    spinlock_init(&lock);
+    nx_status=(params->features.features&AOS_FEATURES_NX)!=0;
+    page1gb_status=(params->features.features&AOS_FEATURES_PAGE1GB)!=0;
+    pml5_status=(params->state.state&AOS_STATE_LA57)!=0;
+    pcid_status=(params->features.features&AOS_FEATURES_PCID)!=0;
+    invpcid_status=pcid_status&&(params->features.features&AOS_FEATURES_INVPCID)!=0;
+    kernel_root=params->page_table&PTM_ADDR_MASK;
+    kernel_pml=(uint64*)memory_phys_to_virt(kernel_root);
+    memory_tlb_set_invpcid(invpcid_status);
+
+    /*预先建立内核上半部的全部根页表项，用户地址空间复制后内核映射的变化对其自动可见*/
+    space_status=true;
+    for(uintn index=256;index<512;index++)
+    {
+        if(!(kernel_pml[index]&PTM_PTE_P))
+        {
+            uintn page=ptp_alloc(pml5_status?4:3);
+            if(page==0)
+            {
+                space_status=false;
+                break;
+            }
+            kernel_pml[index]=page|PTM_TABLE_FLAGS;
+        }
+    }
+    /*根页表项用掉了页表页储备，启动时立即补满*/
+    ptp_fill_idle(UINTN_MAX);
+    memory_ptm_cpu_init();
+}
+
+/**
+ * 当前CPU启用页表管理系统所需的控制位。支持时开启CR4.PCIDE，每个CPU调用一次。
+ * 
+ * @return 无返回值。
+ */
+void memory_ptm_cpu_init(void)
+{
+    if(!pcid_status)
+    {
+        return;
+    }
+    uintn flags=memory_irq_save();
+    /*开启PCIDE时CR3低12位必须为0，内核地址空间使用PCID 0*/
+    x86_write_cr3(kernel_root);
+    x86_write_cr4(x86_read_cr4()|PTM_CR4_PCIDE);
+    memory_irq_restore(flags);
 }
\ No newline at end of file
@@ -0,0 +1,440 @@
+/**
+ * 内核页表页分配器。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#include <cpu/info.h>
+#include <memory/page.h>
+#include <memory/ptm.h>
+#include <support/atomic.h>
+#include <support/format.h>
+#include <support/sync.h>
+#include <support/util.h>
+#include "memoryi.h"
+
+/**
+ * 每CPU已清零页表页容量。
+ */
+#define PTP_CPU_CAPACITY 32
+
+/**
+ * 全局储备容量。
+ */
+#define PTP_RESERVE_CAPACITY 256
+
+/**
+ * 等待宽限期的页表页容量。
+ */
+#define PTP_PENDING_CAPACITY 256
+
+/**
+ * 每CPU与全局储备之间一次搬运的页数。
+ */
+const static uintn PTP_BATCH=16;
+
+/**
+ * 等待宽限期的页数达到该值时尝试回收。
+ */
+const static uintn PTP_RECLAIM_THRESHOLD=32;
+
+/**
+ * 单个CPU的页表页状态。
+ */
+typedef struct _ptp_cpu
+{
+    alignas(64) atomic_uint64 epoch;                   /*进入遍历时的纪元，0表示不在遍历。*/
+    uintn                     nesting;                 /*遍历嵌套层数。*/
+    uintn                     deferred;                /*遍历中推迟入队的页表页链表头物理地址。*/
+    uintn                     count;                   /*已清零页数。*/
+    uintn                     pages[PTP_CPU_CAPACITY]; /*已清零页表页物理地址栈。*/
+} ptp_cpu;
+
+/**
+ * 等待宽限期的页表页。
+ */
+typedef struct _ptp_pending
+{
+    uintn  page;  /*页表页物理地址。*/
+    uintn  level; /*页表层级。*/
+    uint64 epoch; /*释放时的纪元。*/
+} ptp_pending;
+
+/**
+ * 每CPU页表页状态。按CPU编号索引。
+ */
+static ptp_cpu ptp_cpus[CPU_ID_LIMIT];
+
+/**
+ * 全局储备。存放已清零的页表页，空闲时补满，供每CPU批量取用。
+ */
+static uintn reserve[PTP_RESERVE_CAPACITY];
+
+/**
+ * 全局储备页数。
+ */
+static uintn reserve_count=0;
+
+/**
+ * 等待宽限期的页表页环形队列。按纪元递增排列。
+ */
+static ptp_pending pending[PTP_PENDING_CAPACITY];
+
+/**
+ * 等待队列队首下标。
+ */
+static uintn pending_head=0;
+
+/**
+ * 等待队列长度。
+ */
+static uintn pending_count=0;
+
+/**
+ * 全局纪元。每释放一页页表页递增一次，从1开始。
+ */
+static atomic_uint64 epoch;
+
+/**
+ * 各层级在用页表页数。下标为页表层级。
+ */
+static atomic_uint64 levels[6];
+
+/**
+ * 储备与等待队列锁。各CPU补充与释放页表页时都会竞争，使用队列锁。
+ */
+static mcs_lock lock;
+
+/**
+ * 每CPU与全局储备都为空、直接向页管理器申请的次数。
+ */
+static atomic_uint64 fallbacks;
+
+/**
+ * 经宽限期后回收的页数。
+ */
+static atomic_uint64 reclaimed;
+
+/**
+ * 获取当前CPU的页表页状态。
+ * 
+ * @return 页表页状态，CPU编号超出范围返回空指针。
+ */
+static inline ptp_cpu* ptp_get_cpu(void)
+{
+    uint32 id=get_current_cpu_id();
+    return id<CPU_ID_LIMIT?&ptp_cpus[id]:null;
+}
+
+/**
+ * 回收宽限期已过的页表页。页表页释放时必为空，直接放回全局储备，储备满时还给页管理器。
+ * 调用时持有锁。
+ * 
+ * @return 回收的页数。
+ */
+static uintn ptp_reclaim_locked(void)
+{
+    /*仍在遍历的CPU中最早的纪元，此前释放的页面不会再被访问*/
+    uint64 oldest=UINT64_MAX;
+    for(uintn id=0;id<CPU_ID_LIMIT;id++)
+    {
+        uint64 value=atomic_load(&ptp_cpus[id].epoch);
+        if(value!=0)
+        {
+            oldest=min(oldest,value);
+        }
+    }
+
+    uintn count=0;
+    while(pending_count!=0&&pending[pending_head].epoch<oldest)
+    {
+        uintn page=pending[pending_head].page;
+        pending_head=(pending_head+1)%PTP_PENDING_CAPACITY;
+        pending_count--;
+        count++;
+        if(reserve_count<PTP_RESERVE_CAPACITY)
+        {
+            reserve[reserve_count++]=page;
+        }
+        else
+        {
+            free_page(page);
+        }
+    }
+    atomic_fetch_add_explicit(&reclaimed,count,MEMORY_ORDER_RELAXED);
+    return count;
+}
+
+/**
+ * 从全局储备补充当前CPU的已清零页。
+ * 
+ * @param cpu 页表页状态。
+ * 
+ * @return 无返回值。
+ */
+static void ptp_refill(ptp_cpu* cpu)
+{
+    mcs_node node;
+    mcs_lock_lock(&lock,&node);
+    if(reserve_count<PTP_BATCH&&pending_count!=0)
+    {
+        ptp_reclaim_locked();
+    }
+    uintn count=min(min(reserve_count,PTP_BATCH),PTP_CPU_CAPACITY-cpu->count);
+    reserve_count-=count;
+    for(uintn index=0;index<count;index++)
+    {
+        cpu->pages[cpu->count++]=reserve[reserve_count+index];
+    }
+    mcs_lock_unlock(&lock,&node);
+}
+
+/**
+ * 申请一页已清零的页表页。依次取自当前CPU、全局储备，都为空时才向页管理器申请。
+ * 
+ * @param level 页表层级。
+ * 
+ * @return 申请成功返回物理地址，失败返回0。
+ */
+uintn ptp_alloc(uintn level)
+{
+    uintn page=0;
+    uintn flags=memory_irq_save();
+    ptp_cpu* cpu=ptp_get_cpu();
+    if(cpu!=null)
+    {
+        if(cpu->count==0)
+        {
+            ptp_refill(cpu);
+        }
+        if(cpu->count!=0)
+        {
+            page=cpu->pages[--cpu->count];
+        }
+    }
+    memory_irq_restore(flags);
+
+    if(page==0)
+    {
+        atomic_fetch_add_explicit(&fallbacks,1,MEMORY_ORDER_RELAXED);
+        page=alloc_zeroed_page();
+    }
+    if(page!=0&&level<6)
+    {
+        atomic_fetch_add_explicit(&levels[level],1,MEMORY_ORDER_RELAXED);
+    }
+    return page;
+}
+
+/**
+ * 把一页已清空的页表页放入等待队列。队列已满且无法回收时，若当前CPU自己正在遍历，
+ * 等待会阻塞在自己的纪元上，改为挂到本CPU的推迟链表，结束遍历时再入队；
+ * 否则只需等其他CPU结束很短的遍历。
+ * 
+ * @param cpu   当前CPU页表页状态，可以为空指针。
+ * @param page  页表页物理地址。
+ * @param level 页表层级。
+ * 
+ * @return 无返回值。
+ */
+static void ptp_queue(ptp_cpu* cpu,uintn page,uintn level)
+{
+    mcs_node node;
+    uintn flags=memory_irq_save();
+    mcs_lock_lock(&lock,&node);
+    while(pending_count==PTP_PENDING_CAPACITY&&ptp_reclaim_locked()==0)
+    {
+        mcs_lock_unlock(&lock,&node);
+        if(cpu!=null&&cpu->nesting!=0)
+        {
+            /*页面已清空，链接写在首项，存在位为0，遍历者仍视为空项*/
+            ((volatile uint64*)memory_phys_to_virt(page))[0]=cpu->deferred|(level<<1);
+            cpu->deferred=page;
+            memory_irq_restore(flags);
+            return;
+        }
+        x86_cpu_pause();
+        mcs_lock_lock(&lock,&node);
+    }
+    uintn tail=(pending_head+pending_count)%PTP_PENDING_CAPACITY;
+    pending[tail].page=page;
+    pending[tail].level=level;
+    pending[tail].epoch=atomic_fetch_add(&epoch,1);
+    pending_count++;
+    if(pending_count>=PTP_RECLAIM_THRESHOLD)
+    {
+        ptp_reclaim_locked();
+    }
+    mcs_lock_unlock(&lock,&node);
+    memory_irq_restore(flags);
+}
+
+/**
+ * 释放一页已清空的页表页。页面要等全部无锁遍历者离开后才复用，调用者应已完成TLB击落。
+ * 可以在遍历中调用，等待队列满时不会等待当前CPU自己的遍历。
+ * 
+ * @param page  页表页物理地址。
+ * @param level 页表层级。
+ * 
+ * @return 无返回值。
+ */
+void ptp_free(uintn page,uintn level)
+{
+    if(page==0)
+    {
+        return;
+    }
+    if(level<6)
+    {
+        atomic_fetch_sub_explicit(&levels[level],1,MEMORY_ORDER_RELAXED);
+    }
+
+    uintn flags=memory_irq_save();
+    ptp_queue(ptp_get_cpu(),page,level);
+    memory_irq_restore(flags);
+}
+
+/**
+ * 当前CPU开始无锁遍历页表。期间读到的页表页不会被复用，可以嵌套，遍历中不能睡眠。
+ * 
+ * @return 无返回值。
+ */
+void ptp_read_lock(void)
+{
+    uintn flags=memory_irq_save();
+    ptp_cpu* cpu=ptp_get_cpu();
+    if(cpu!=null&&cpu->nesting++==0)
+    {
+        /*顺序一致存储带全屏障，之后读取页表不会被提前到公布纪元之前*/
+        atomic_store(&cpu->epoch,atomic_load(&epoch));
+    }
+    memory_irq_restore(flags);
+}
+
+/**
+ * 当前CPU结束无锁遍历页表。最外层结束时把遍历中推迟的页表页放入等待队列，
+ * 入队时取新纪元，不早于实际释放时刻，仍会等到当时的遍历者离开。
+ * 
+ * @return 无返回值。
+ */
+void ptp_read_unlock(void)
+{
+    uintn flags=memory_irq_save();
+    ptp_cpu* cpu=ptp_get_cpu();
+    if(cpu!=null&&--cpu->nesting==0)
+    {
+        atomic_store_explicit(&cpu->epoch,0,MEMORY_ORDER_RELEASE);
+        while(cpu->deferred!=0)
+        {
+            volatile uint64* link=(volatile uint64*)memory_phys_to_virt(cpu->deferred);
+            uintn page=cpu->deferred;
+            uintn level=(link[0]>>1)&7;
+            cpu->deferred=link[0]&~(uintn)(SIZE_4KB-1);
+            link[0]=0;
+            ptp_queue(cpu,page,level);
+        }
+    }
+    memory_irq_restore(flags);
+}
+
+/**
+ * 在空闲时补充页表页储备。先回收宽限期已过的页面，再用已清零页补满全局储备与当前CPU。
+ * 
+ * @param budget 本次最多补充的页数。
+ * 
+ * @return 实际补充的页数。
+ */
+uintn ptp_fill_idle(uintn budget)
+{
+    uintn done=0;
+    mcs_node node;
+    uintn flags=memory_irq_save();
+    mcs_lock_lock(&lock,&node);
+    ptp_reclaim_locked();
+    uintn room=PTP_RESERVE_CAPACITY-reserve_count;
+    mcs_lock_unlock(&lock,&node);
+    memory_irq_restore(flags);
+
+    while(done<budget&&room!=0)
+    {
+        uintn page=alloc_zeroed_page();
+        if(page==0)
+        {
+            break;
+        }
+        flags=memory_irq_save();
+        mcs_lock_lock(&lock,&node);
+        bool stored=reserve_count<PTP_RESERVE_CAPACITY;
+        if(stored)
+        {
+            reserve[reserve_count++]=page;
+        }
+        room=PTP_RESERVE_CAPACITY-reserve_count;
+        mcs_lock_unlock(&lock,&node);
+        memory_irq_restore(flags);
+        if(!stored)
+        {
+            free_page(page);
+            break;
+        }
+        done++;
+    }
+
+    flags=memory_irq_save();
+    ptp_cpu* cpu=ptp_get_cpu();
+    if(cpu!=null&&cpu->count<PTP_CPU_CAPACITY/2)
+    {
+        ptp_refill(cpu);
+    }
+    memory_irq_restore(flags);
+    return done;
+}
+
+/**
+ * 输出页表页统计。
+ * 
+ * @param handle 输入输出句柄。
+ * 
+ * @return 无返回值。
+ */
+void ptp_dump_stats(io_handle* handle)
+{
+    format_print(handle,"[aos.kernel.memory] Page tables: %U PML5, %U PML4, %U PDPT, %U PD, %U PT in use.\n",
+        atomic_load(&levels[5]),atomic_load(&levels[4]),atomic_load(&levels[3]),atomic_load(&levels[2]),
+        atomic_load(&levels[1]));
+    format_print(handle,"[aos.kernel.memory]   Table pages: %N reserved, %N awaiting grace period, "
+        "%U reclaimed, %U fallbacks.\n",reserve_count,pending_count,atomic_load(&reclaimed),
+        atomic_load(&fallbacks));
+}
+
+/**
+ * 初始化页表页分配器，预先填满全局储备。在页表管理系统初始化前调用。
+ * 
+ * @return 无返回值。
+ */
+void memory_ptp_init(void)
+{
+    mcs_lock_init(&lock);
+    atomic_init(&epoch,1);
+    atomic_init(&fallbacks,0);
+    atomic_init(&reclaimed,0);
+    for(uintn index=0;index<6;index++)
+    {
+        atomic_init(&levels[index],0);
+    }
+    for(uintn id=0;id<CPU_ID_LIMIT;id++)
+    {
+        atomic_init(&ptp_cpus[id].epoch,0);
+    }
+    while(reserve_count<PTP_RESERVE_CAPACITY)
+    {
+        uintn page=alloc_zeroed_page();
+        if(page==0)
+        {
+            break;
+        }
+        reserve[reserve_count++]=page;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+/**
+ * 内核低内存回收管理。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#include <memory/reclaim.h>
+#include <support/sync.h>
+
+/**
+ * 低内存回调链表头结点。
+ */
+static low_memory_callback_node* callback_head=null;
+
+/**
+ * 低内存回调链表锁。
+ */
+static spinlock lock;
+
+/**
+ * 注册一个低内存回调函数。
+ * 
+ * @param node 低内存回调结点。结点内存应该由各模块提供稳定内存区域。
+ * 
+ * @return 无返回值。
+ */
+void register_low_memory_callback(low_memory_callback_node* node)
+{
+    spinlock_lock(&lock);
+    node->prev=null;
+    node->next=callback_head;
+    if(callback_head!=null)
+    {
+        callback_head->prev=node;
+    }
+    callback_head=node;
+    spinlock_unlock(&lock);
+}
+
+/**
+ * 注销一个低内存回调函数。
+ * 
+ * @param node 低内存回调结点。结点内存应该由各模块提供稳定内存区域。
+ * 
+ * @return 无返回值。
+ */
+void unregister_low_memory_callback(low_memory_callback_node* node)
+{
+    spinlock_lock(&lock);
+    if(node->prev!=null)
+    {
+        node->prev->next=node->next;
+    }
+    else
+    {
+        callback_head=node->next;
+    }
+    if(node->next!=null)
+    {
+        node->next->prev=node->prev;
+    }
+    node->prev=null;
+    node->next=null;
+    spinlock_unlock(&lock);
+}
+
+/**
+ * 依次调用所有低内存回调回收内存。其他CPU正在回收时直接返回。
+ * 
+ * @return 回收的总页数。
+ */
+uintn memory_reclaim(void)
+{
+    /*回调内部再次触发回收时不能阻塞在自己持有的锁上*/
+    if(!spinlock_try_lock(&lock))
+    {
+        return 0;
+    }
+
+    uintn pages=0;
+    for(low_memory_callback_node* node=callback_head;node!=null;node=node->next)
+    {
+        pages+=node->callback();
+    }
+    spinlock_unlock(&lock);
+    return pages;
+}
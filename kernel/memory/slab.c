@@ -0,0 +1,607 @@
+/**
+ * 内核对象缓存分配器。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#include <cpu/info.h>
+#include <memory/pool.h>
+#include <memory/slab.h>
+#include <support/format.h>
+#include <support/memory.h>
+#include <support/sync.h>
+#include <support/util.h>
+#include "memoryi.h"
+
+/**
+ * 每CPU弹匣容量。
+ */
+#define SLAB_MAGAZINE_SIZE 32
+
+/**
+ * 大小类数目，覆盖16至2048字节。
+ */
+#define SLAB_CLASS_COUNT 8
+
+/**
+ * 弹匣与板块之间一次搬运的对象数。
+ */
+const static uintn SLAB_BATCH=16;
+
+/**
+ * 板块最少容纳的对象数。
+ */
+const static uintn SLAB_MIN_OBJECTS=8;
+
+/**
+ * 板块空闲链表结束标记。
+ */
+const static uint16 SLAB_END=UINT16_MAX;
+
+/**
+ * 最小大小类的位移。
+ */
+const static uintn SLAB_CLASS_SHIFT=4;
+
+/**
+ * 板块。位于板块首部，板块按自身大小对齐，对象地址掩去低位即得板块。
+ * 空闲对象通过首部之后的索引数组串联，对象本身不带头部，也不被链表覆盖构造状态。
+ */
+typedef struct _slab slab;
+
+struct _slab
+{
+    slab_cache* cache;       /*所属缓存。*/
+    slab*       prev;        /*链表前一板块。*/
+    slab*       next;        /*链表下一板块。*/
+    uint16      free;        /*首个空闲对象索引。*/
+    uint16      inuse;       /*已分配对象数。*/
+    uint16      next_free[]; /*空闲对象后继索引。*/
+};
+
+/**
+ * 每CPU弹匣。对象以栈方式存取。
+ */
+typedef struct _slab_magazine
+{
+    uintn count;                       /*当前对象数。*/
+    uintn allocs;                      /*本CPU申请次数。*/
+    uintn frees;                       /*本CPU释放次数。*/
+    void* objects[SLAB_MAGAZINE_SIZE]; /*对象栈。*/
+} slab_magazine;
+
+/**
+ * 对象缓存。
+ */
+struct _slab_cache
+{
+    slab_cache*      prev;                    /*缓存链表前一缓存。*/
+    slab_cache*      next;                    /*缓存链表后一缓存。*/
+    const char*      name;                    /*缓存名称。*/
+    uintn            size;                    /*对象跨度。*/
+    uintn            slab_size;               /*板块大小。*/
+    uintn            offset;                  /*首个对象在板块中的偏移。*/
+    uintn            total;                   /*每板块对象数。*/
+    uintn            slabs;                   /*板块数。*/
+    slab_constructor ctor;                    /*对象构造函数。*/
+    spinlock         lock;                    /*板块链表锁。*/
+    slab*            partial;                 /*部分分配板块链表。*/
+    slab*            full;                    /*全部分配板块链表。*/
+    slab*            empty;                   /*空板块链表。*/
+    slab_magazine*   magazines[CPU_ID_LIMIT]; /*每CPU弹匣。*/
+};
+
+/**
+ * 缓存链表头。
+ */
+static slab_cache* cache_head=null;
+
+/**
+ * 缓存链表锁。
+ */
+static spinlock cache_lock;
+
+/**
+ * 通用大小类缓存。
+ */
+static slab_cache* slab_classes[SLAB_CLASS_COUNT];
+
+/**
+ * 通用大小类名称。
+ */
+static const char* SLAB_CLASS_NAMES[SLAB_CLASS_COUNT]={
+    "slab-16","slab-32","slab-64","slab-128","slab-256","slab-512","slab-1024","slab-2048"
+};
+
+/**
+ * 板块链表添加板块。
+ * 
+ * @param head 链表头。
+ * @param node 待添加板块。
+ * 
+ * @return 无返回值。
+ */
+static inline void slab_list_add(slab** head,slab* node)
+{
+    node->prev=null;
+    node->next=*head;
+    if(*head!=null)
+    {
+        (*head)->prev=node;
+    }
+    *head=node;
+}
+
+/**
+ * 板块链表删除板块。
+ * 
+ * @param head 链表头。
+ * @param node 待删除板块。
+ * 
+ * @return 无返回值。
+ */
+static inline void slab_list_remove(slab** head,slab* node)
+{
+    if(node->prev!=null)
+    {
+        node->prev->next=node->next;
+    }
+    else
+    {
+        *head=node->next;
+    }
+    if(node->next!=null)
+    {
+        node->next->prev=node->prev;
+    }
+}
+
+/**
+ * 为缓存新建一个板块并构造其中所有对象。需持有缓存锁。
+ * 
+ * @param cache 对象缓存。
+ * 
+ * @return 成功返回真。
+ */
+static bool slab_grow(slab_cache* cache)
+{
+    slab* block=(slab*)pool_alloc_aligned(cache->slab_size,cache->slab_size);
+    if(block==null)
+    {
+        return false;
+    }
+
+    block->cache=cache;
+    block->free=0;
+    block->inuse=0;
+    for(uintn index=0;index<cache->total;index++)
+    {
+        block->next_free[index]=index+1<cache->total?(uint16)(index+1):SLAB_END;
+        if(cache->ctor!=null)
+        {
+            cache->ctor((void*)((uintn)block+cache->offset+index*cache->size));
+        }
+    }
+    slab_list_add(&cache->empty,block);
+    cache->slabs++;
+    return true;
+}
+
+/**
+ * 从板块取出一个对象。需持有缓存锁。
+ * 
+ * @param cache 对象缓存。
+ * 
+ * @return 成功返回对象指针，无可用板块且无法新建时返回空指针。
+ */
+static void* slab_take(slab_cache* cache)
+{
+    slab* block=cache->partial;
+    if(block==null)
+    {
+        if(cache->empty==null&&!slab_grow(cache))
+        {
+            return null;
+        }
+        block=cache->empty;
+        slab_list_remove(&cache->empty,block);
+        slab_list_add(&cache->partial,block);
+    }
+
+    uintn index=block->free;
+    block->free=block->next_free[index];
+    if(++block->inuse==cache->total)
+    {
+        slab_list_remove(&cache->partial,block);
+        slab_list_add(&cache->full,block);
+    }
+    return (void*)((uintn)block+cache->offset+index*cache->size);
+}
+
+/**
+ * 把一个对象放回所属板块。完全空闲的板块至多保留一个，其余归还内核内存池。需持有缓存锁。
+ * 
+ * @param cache  对象缓存。
+ * @param object 对象指针。
+ * 
+ * @return 无返回值。
+ */
+static void slab_put(slab_cache* cache,void* object)
+{
+    slab* block=(slab*)((uintn)object&~(cache->slab_size-1));
+    uintn index=((uintn)object-(uintn)block-cache->offset)/cache->size;
+    block->next_free[index]=block->free;
+    block->free=(uint16)index;
+
+    if(block->inuse--==cache->total)
+    {
+        slab_list_remove(&cache->full,block);
+        slab_list_add(&cache->partial,block);
+    }
+    if(block->inuse==0)
+    {
+        slab_list_remove(&cache->partial,block);
+        if(cache->empty!=null)
+        {
+            pool_free(block);
+            cache->slabs--;
+        }
+        else
+        {
+            slab_list_add(&cache->empty,block);
+        }
+    }
+}
+
+/**
+ * 获取当前CPU在缓存中的弹匣，首次使用时建立。需关闭中断。
+ * 
+ * @param cache 对象缓存。
+ * 
+ * @return 弹匣，无法建立时返回空指针。
+ */
+static slab_magazine* slab_get_magazine(slab_cache* cache)
+{
+    uint32 id=get_current_cpu_id();
+    if(id>=CPU_ID_LIMIT)
+    {
+        return null;
+    }
+
+    slab_magazine* magazine=cache->magazines[id];
+    if(magazine==null)
+    {
+        magazine=(slab_magazine*)pool_alloc(sizeof(slab_magazine));
+        if(magazine!=null)
+        {
+            magazine->count=0;
+            magazine->allocs=0;
+            magazine->frees=0;
+            cache->magazines[id]=magazine;
+        }
+    }
+    return magazine;
+}
+
+/**
+ * 把弹匣底部的若干对象放回板块。栈底对象最久未用，栈顶的热对象留在弹匣中。
+ * 
+ * @param cache    对象缓存。
+ * @param magazine 弹匣。
+ * @param count    放回对象数。
+ * 
+ * @return 无返回值。
+ */
+static void slab_flush(slab_cache* cache,slab_magazine* magazine,uintn count)
+{
+    spinlock_lock(&cache->lock);
+    for(uintn index=0;index<count;index++)
+    {
+        slab_put(cache,magazine->objects[index]);
+    }
+    spinlock_unlock(&cache->lock);
+
+    magazine->count-=count;
+    for(uintn index=0;index<magazine->count;index++)
+    {
+        magazine->objects[index]=magazine->objects[index+count];
+    }
+}
+
+/**
+ * 创建一个对象缓存。
+ * 
+ * @param name  缓存名称。
+ * @param size  对象大小。
+ * @param align 对象对齐，0表示按8字节对齐。
+ * @param ctor  对象构造函数，可为空。
+ * 
+ * @return 成功创建返回缓存，失败返回空指针。
+ */
+slab_cache* slab_cache_create(const char* name,uintn size,uintn align,slab_constructor ctor)
+{
+    align=align<8?8:align;
+    if(size==0||(align&(align-1))!=0||size>SIZE_1MB||align>SIZE_4KB)
+    {
+        return null;
+    }
+
+    slab_cache* cache=(slab_cache*)pool_alloc(sizeof(slab_cache));
+    if(cache==null)
+    {
+        return null;
+    }
+    memory_zero(cache,sizeof(slab_cache));
+    cache->name=name;
+    cache->size=align_up(size,align);
+    cache->ctor=ctor;
+    spinlock_init(&cache->lock);
+
+    /*板块取能容纳最少对象数的2的幂大小，不小于一页*/
+    uintn slab_size=SIZE_4KB;
+    while(slab_size<sizeof(slab)+SLAB_MIN_OBJECTS*(cache->size+sizeof(uint16))+align)
+    {
+        slab_size<<=1;
+    }
+    uintn total=min((slab_size-sizeof(slab))/(cache->size+sizeof(uint16)),(uintn)SLAB_END);
+    while(align_up(sizeof(slab)+total*sizeof(uint16),align)+total*cache->size>slab_size)
+    {
+        total--;
+    }
+    cache->slab_size=slab_size;
+    cache->total=total;
+    cache->offset=align_up(sizeof(slab)+total*sizeof(uint16),align);
+
+    spinlock_lock(&cache_lock);
+    cache->next=cache_head;
+    if(cache_head!=null)
+    {
+        cache_head->prev=cache;
+    }
+    cache_head=cache;
+    spinlock_unlock(&cache_lock);
+    return cache;
+}
+
+/**
+ * 销毁一个对象缓存。调用者需保证缓存中对象已全部释放。
+ * 
+ * @param cache 对象缓存。
+ * 
+ * @return 无返回值。
+ */
+void slab_cache_destroy(slab_cache* cache)
+{
+    if(cache==null)
+    {
+        return;
+    }
+
+    spinlock_lock(&cache_lock);
+    if(cache->prev!=null)
+    {
+        cache->prev->next=cache->next;
+    }
+    else
+    {
+        cache_head=cache->next;
+    }
+    if(cache->next!=null)
+    {
+        cache->next->prev=cache->prev;
+    }
+    spinlock_unlock(&cache_lock);
+
+    for(uintn id=0;id<CPU_ID_LIMIT;id++)
+    {
+        if(cache->magazines[id]!=null)
+        {
+            pool_free(cache->magazines[id]);
+        }
+    }
+
+    slab* lists[]={cache->partial,cache->full,cache->empty};
+    for(uintn index=0;index<sizeof(lists)/sizeof(slab*);index++)
+    {
+        slab* block=lists[index];
+        while(block!=null)
+        {
+            slab* next=block->next;
+            pool_free(block);
+            block=next;
+        }
+    }
+    pool_free(cache);
+}
+
+/**
+ * 从对象缓存申请一个对象。
+ * 
+ * @param cache 对象缓存。
+ * 
+ * @return 成功申请返回对象指针，失败返回空指针。
+ */
+void* slab_cache_alloc(slab_cache* cache)
+{
+    void* object=null;
+    uintn flags=memory_irq_save();
+    slab_magazine* magazine=slab_get_magazine(cache);
+    if(magazine==null)
+    {
+        spinlock_lock(&cache->lock);
+        object=slab_take(cache);
+        spinlock_unlock(&cache->lock);
+    }
+    else
+    {
+        if(magazine->count==0)
+        {
+            spinlock_lock(&cache->lock);
+            while(magazine->count<SLAB_BATCH)
+            {
+                void* taken=slab_take(cache);
+                if(taken==null)
+                {
+                    break;
+                }
+                magazine->objects[magazine->count++]=taken;
+            }
+            spinlock_unlock(&cache->lock);
+        }
+        if(magazine->count!=0)
+        {
+            object=magazine->objects[--magazine->count];
+            magazine->allocs++;
+        }
+    }
+    memory_irq_restore(flags);
+    return object;
+}
+
+/**
+ * 向对象缓存释放一个对象。对象应处于构造状态。
+ * 
+ * @param cache  对象缓存。
+ * @param object 对象指针。
+ * 
+ * @return 无返回值。
+ */
+void slab_cache_free(slab_cache* cache,void* object)
+{
+    if(cache==null||object==null)
+    {
+        return;
+    }
+
+    uintn flags=memory_irq_save();
+    slab_magazine* magazine=slab_get_magazine(cache);
+    if(magazine==null)
+    {
+        spinlock_lock(&cache->lock);
+        slab_put(cache,object);
+        spinlock_unlock(&cache->lock);
+    }
+    else
+    {
+        if(magazine->count==SLAB_MAGAZINE_SIZE)
+        {
+            slab_flush(cache,magazine,SLAB_BATCH);
+        }
+        magazine->objects[magazine->count++]=object;
+        magazine->frees++;
+    }
+    memory_irq_restore(flags);
+}
+
+/**
+ * 获取大小对应的大小类索引。
+ * 
+ * @param size 申请大小。
+ * 
+ * @return 大小类索引，超出范围返回大小类数目。
+ */
+static inline uintn slab_get_class(uintn size)
+{
+    if(size<=((uintn)1<<SLAB_CLASS_SHIFT))
+    {
+        return 0;
+    }
+    uintn index=sizeof(uintn)*8-count_leading_zeros(size-1)-SLAB_CLASS_SHIFT;
+    return index<SLAB_CLASS_COUNT?index:SLAB_CLASS_COUNT;
+}
+
+/**
+ * 输出对象缓存统计。逐个缓存输出对象与板块规格、板块数以及各CPU弹匣申请释放次数之和。
+ * 
+ * @param handle 输入输出句柄。
+ * 
+ * @return 无返回值。
+ */
+void slab_dump_stats(io_handle* handle)
+{
+    spinlock_lock(&cache_lock);
+    for(slab_cache* cache=cache_head;cache!=null;cache=cache->next)
+    {
+        uintn allocs=0,frees=0,cached=0;
+        for(uintn id=0;id<CPU_ID_LIMIT;id++)
+        {
+            slab_magazine* magazine=cache->magazines[id];
+            if(magazine!=null)
+            {
+                allocs+=magazine->allocs;
+                frees+=magazine->frees;
+                cached+=magazine->count;
+            }
+        }
+        format_print(handle,"[aos.kernel.memory] Slab %s: object %N bytes, slab %N bytes x %N objects, "
+            "%N slabs, %N allocs, %N frees, %N cached in magazines.\n",cache->name,cache->size,
+            cache->slab_size,cache->total,cache->slabs,allocs,frees,cached);
+    }
+    spinlock_unlock(&cache_lock);
+}
+
+/**
+ * 初始化对象缓存的通用大小类。
+ * 
+ * @return 初始化成功返回真。
+ */
+bool memory_slab_init(void)
+{
+    spinlock_init(&cache_lock);
+    for(uintn index=0;index<SLAB_CLASS_COUNT;index++)
+    {
+        slab_classes[index]=slab_cache_create(SLAB_CLASS_NAMES[index],
+            (uintn)1<<(index+SLAB_CLASS_SHIFT),0,null);
+        if(slab_classes[index]==null)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * 按大小类申请一块内存。16至2048字节由对象缓存提供，更大的请求转交内核内存池。
+ * 
+ * @param size 申请大小。
+ * 
+ * @return 成功申请返回一个非空指针。
+ */
+void* slab_alloc(uintn size)
+{
+    if(size==0)
+    {
+        return null;
+    }
+    uintn index=slab_get_class(size);
+    if(index==SLAB_CLASS_COUNT||slab_classes[index]==null)
+    {
+        return pool_alloc(size);
+    }
+    return slab_cache_alloc(slab_classes[index]);
+}
+
+/**
+ * 按大小类释放一块内存。
+ * 
+ * @param ptr  申请内存指针基址。
+ * @param size 申请时的大小。
+ * 
+ * @return 无返回值。
+ */
+void slab_free(void* ptr,uintn size)
+{
+    if(ptr==null||size==0)
+    {
+        return;
+    }
+    uintn index=slab_get_class(size);
+    if(index==SLAB_CLASS_COUNT||slab_classes[index]==null)
+    {
+        pool_free(ptr);
+        return;
+    }
+    slab_cache_free(slab_classes[index],ptr);
+}
@@ -0,0 +1,31 @@
+/**
+ * 内核内存分配器统计。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#include <memory/stats.h>
+#include "memoryi.h"
+
+/**
+ * 输出全部内存分配器统计：伙伴系统各区各阶空闲块、每CPU页池、内存池各区域、对象缓存、页表页以及TLB击落。
+ * 
+ * @param handle 输入输出句柄。要求其可写能力。
+ * 
+ * @return 无返回值。
+ */
+void memory_dump_stats(io_handle* handle)
+{
+    if(handle==null)
+    {
+        return;
+    }
+    buddy_dump_stats(handle);
+    per_cpu_dump_stats(handle);
+    pool_dump_stats(handle);
+    slab_dump_stats(handle);
+    ptp_dump_stats(handle);
+    tlb_dump_stats(handle);
+}
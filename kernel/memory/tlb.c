@@ -0,0 +1,444 @@
+/**
+ * 内核跨CPU TLB击落。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#include <cpu/apic.h>
+#include <cpu/interrupt.h>
+#include <memory/tlb.h>
+#include <support/cache.h>
+#include <support/format.h>
+#include <support/sync.h>
+#include <support/util.h>
+#include "memoryi.h"
+
+/**
+ * 逐页刷新的页数上限，超过后改为刷新全部TLB。
+ */
+const static uintn TLB_FLUSH_CEILING=32;
+
+/**
+ * 单个CPU的击落状态。发送方在锁内合并请求，接收方在锁内取走请求后再刷新。
+ */
+typedef struct _tlb_cpu
+{
+    alignas(64) spinlock lock;    /*状态锁。*/
+    bool          online;         /*已上线。*/
+    bool          pending;        /*有未处理请求，中断已发出。*/
+    bool          full;           /*待处理请求需要刷新全部TLB。*/
+    bool          global;         /*待处理请求含全局页。*/
+    bool          lazy;           /*处于惰性TLB模式。*/
+    bool          stale;          /*惰性期间错过了刷新。*/
+    bool          stale_global;   /*错过的刷新含全局页。*/
+    uintn         start;          /*待处理范围起始地址。*/
+    uintn         end;            /*待处理范围结束地址。*/
+    atomic_uint64 requested;      /*已提交的请求序号。*/
+    atomic_uint64 completed;      /*已完成的请求序号。*/
+    uint64        ipis;           /*收到的击落中断数。*/
+    uint64        merged;         /*被合并的请求数。*/
+    uint64        skipped;        /*因惰性模式免去的中断数。*/
+} tlb_cpu;
+
+/**
+ * 每CPU击落状态。按CPU编号索引。
+ */
+static tlb_cpu tlb_cpus[CPU_ID_LIMIT];
+
+/**
+ * 内核地址空间。所有在线CPU都使用内核映射。
+ */
+static tlb_space kernel_space;
+
+/**
+ * INVPCID支持状态。
+ */
+static bool invpcid_status=false;
+
+/**
+ * 在当前CPU上刷新一段范围。
+ * 
+ * @param start  范围起始地址。
+ * @param end    范围结束地址。
+ * @param full   刷新全部TLB。
+ * @param global 含全局页。
+ * 
+ * @return 无返回值。
+ */
+static void tlb_flush_local(uintn start,uintn end,bool full,bool global)
+{
+    if(full)
+    {
+        tlb_flush_all(global);
+        return;
+    }
+    uintn pages=(end-start-1)/SIZE_4KB+1;
+    for(uintn index=0;index<pages;index++)
+    {
+        x86_flush_single_tlb(start+index*SIZE_4KB);
+    }
+}
+
+/**
+ * 处理CPU上待处理的击落请求。
+ * 
+ * @param cpu 击落状态。
+ * 
+ * @return 无返回值。
+ */
+static void tlb_process(tlb_cpu* cpu)
+{
+    uintn flags=memory_irq_save();
+    spinlock_lock(&cpu->lock);
+    if(!cpu->pending)
+    {
+        spinlock_unlock(&cpu->lock);
+        memory_irq_restore(flags);
+        return;
+    }
+    uintn start=cpu->start;
+    uintn end=cpu->end;
+    bool full=cpu->full;
+    bool global=cpu->global;
+    uint64 sequence=atomic_load_explicit(&cpu->requested,MEMORY_ORDER_RELAXED);
+    cpu->pending=false;
+    spinlock_unlock(&cpu->lock);
+
+    tlb_flush_local(start,end,full,global);
+    atomic_store_explicit(&cpu->completed,sequence,MEMORY_ORDER_RELEASE);
+    memory_irq_restore(flags);
+}
+
+/**
+ * 向CPU提交击落请求。已有未处理请求时合并范围，不再重复发送中断。
+ * 
+ * @param id     目标CPU编号。
+ * @param start  范围起始地址。
+ * @param end    范围结束地址。
+ * @param global 含全局页。
+ * @param defer  允许惰性模式的目标推迟到退出惰性模式时刷新。
+ * 
+ * @return 需要等待目标完成返回真，目标被推迟返回假。
+ */
+static bool tlb_post(uint32 id,uintn start,uintn end,bool global,bool defer)
+{
+    tlb_cpu* cpu=&tlb_cpus[id];
+    spinlock_lock(&cpu->lock);
+    if(defer&&cpu->lazy)
+    {
+        cpu->stale=true;
+        cpu->stale_global|=global;
+        cpu->skipped++;
+        spinlock_unlock(&cpu->lock);
+        return false;
+    }
+
+    bool send=!cpu->pending;
+    if(send)
+    {
+        cpu->start=start;
+        cpu->end=end;
+        cpu->full=false;
+        cpu->global=global;
+        cpu->pending=true;
+    }
+    else
+    {
+        cpu->start=min(cpu->start,start);
+        cpu->end=max(cpu->end,end);
+        cpu->global|=global;
+        cpu->merged++;
+    }
+    if((cpu->end-cpu->start-1)/SIZE_4KB>=TLB_FLUSH_CEILING)
+    {
+        cpu->full=true;
+    }
+    atomic_fetch_add_explicit(&cpu->requested,1,MEMORY_ORDER_RELAXED);
+    spinlock_unlock(&cpu->lock);
+
+    if(send)
+    {
+        apic_send_ipi(id,INTERRUPT_VECTOR_TLB_SHOOTDOWN);
+    }
+    return true;
+}
+
+/**
+ * 初始化地址空间的TLB跟踪信息。
+ * 
+ * @param space 地址空间。
+ * 
+ * @return 无返回值。
+ */
+void tlb_space_init(tlb_space* space)
+{
+    for(uintn index=0;index<TLB_SPACE_WORDS;index++)
+    {
+        atomic_init(&space->active[index],0);
+    }
+    atomic_init(&space->generation,0);
+}
+
+/**
+ * 当前CPU开始使用地址空间。先加入活跃掩码再读代数，此后的击落必然发到当前CPU，
+ * 代数与上次记录相同说明切出期间没有错过刷新。
+ * 
+ * @param space 地址空间。
+ * 
+ * @return 加入时的映射代数。
+ */
+uint64 tlb_space_activate(tlb_space* space)
+{
+    uint32 id=get_current_cpu_id();
+    if(id<CPU_ID_LIMIT)
+    {
+        atomic_fetch_or(&space->active[id/64],(uint64)1<<(id%64));
+    }
+    return atomic_load(&space->generation);
+}
+
+/**
+ * 当前CPU停止使用地址空间。
+ * 
+ * @param space 地址空间。
+ * 
+ * @return 无返回值。
+ */
+void tlb_space_deactivate(tlb_space* space)
+{
+    uint32 id=get_current_cpu_id();
+    if(id<CPU_ID_LIMIT)
+    {
+        atomic_fetch_and(&space->active[id/64],~((uint64)1<<(id%64)));
+    }
+}
+
+/**
+ * 刷新当前CPU的全部TLB。
+ * 
+ * @param global 为真时一并刷新全局页与全部PCID，否则只刷新当前PCID的非全局页。
+ * 
+ * @return 无返回值。
+ */
+void tlb_flush_all(bool global)
+{
+    if(!global)
+    {
+        x86_flush_all_tlbs();
+    }
+    else if(invpcid_status)
+    {
+        x86_invpcid(X86_INVPCID_ALL_GLOBAL,0,0);
+    }
+    else
+    {
+        /*翻转CR4.PGE同时清空全部PCID*/
+        x86_flush_all_global_tlbs();
+    }
+}
+
+/**
+ * 让地址空间在其他活跃CPU上的一段线性范围TLB失效，返回时全部目标已完成刷新。
+ * 对同一CPU的并发请求合并为一个范围，只发送一次中断；用户地址空间的击落不打断处于惰性TLB模式的CPU，
+ * 改为在退出惰性模式时整体刷新。惰性CPU响应中断时仍使用内核映射，且可能缓存了被释放页表页的分页结构，
+ * 因此内核地址空间的击落与释放页表页的击落总是发送中断。当前CPU的TLB由调用者自行刷新。
+ * 
+ * @param space  地址空间，空指针表示内核地址空间，即全部在线CPU。
+ * @param start  范围起始地址。
+ * @param end    范围结束地址，不包含在范围内。
+ * @param global 范围内含全局页。
+ * @param tables 击落后将释放页表页。
+ * 
+ * @return 无返回值。
+ */
+void tlb_shootdown(tlb_space* space,uintn start,uintn end,bool global,bool tables)
+{
+    if(space==null)
+    {
+        space=&kernel_space;
+    }
+    start&=~(uintn)(SIZE_4KB-1);
+    if(end<=start)
+    {
+        return;
+    }
+    uint32 self=get_current_cpu_id();
+    bool defer=space!=&kernel_space&&!tables;
+
+    /*先递增代数再读掩码，与切换时先入掩码再读代数配对，两边至少有一边看到对方*/
+    atomic_fetch_add(&space->generation,1);
+
+    /*先向全部目标提交请求，再统一等待，使各目标并行刷新*/
+    uint64 waiting[TLB_SPACE_WORDS];
+    for(uintn word=0;word<TLB_SPACE_WORDS;word++)
+    {
+        uint64 mask=atomic_load(&space->active[word]);
+        waiting[word]=0;
+        while(mask!=0)
+        {
+            uintn bit=count_trailing_zeros(mask);
+            mask&=mask-1;
+            uint32 id=(uint32)(word*64+bit);
+            if(id!=self&&tlb_post(id,start,end,global,defer))
+            {
+                waiting[word]|=(uint64)1<<bit;
+            }
+        }
+    }
+
+    for(uintn word=0;word<TLB_SPACE_WORDS;word++)
+    {
+        while(waiting[word]!=0)
+        {
+            uintn bit=count_trailing_zeros(waiting[word]);
+            waiting[word]&=waiting[word]-1;
+            tlb_cpu* cpu=&tlb_cpus[word*64+bit];
+            uint64 sequence=atomic_load_explicit(&cpu->requested,MEMORY_ORDER_RELAXED);
+            while(atomic_load_explicit(&cpu->completed,MEMORY_ORDER_ACQUIRE)<sequence)
+            {
+                /*等待期间处理发给自己的请求，避免两个CPU关中断互相等待*/
+                if(self<CPU_ID_LIMIT)
+                {
+                    tlb_process(&tlb_cpus[self]);
+                }
+                x86_cpu_pause();
+            }
+        }
+    }
+}
+
+/**
+ * 当前CPU进入惰性TLB模式。空闲等不访问用户映射的场景调用，期间不再接收用户地址空间的击落中断。
+ * 
+ * @return 无返回值。
+ */
+void tlb_enter_lazy(void)
+{
+    uint32 id=get_current_cpu_id();
+    if(id>=CPU_ID_LIMIT)
+    {
+        return;
+    }
+    tlb_cpu* cpu=&tlb_cpus[id];
+    uintn flags=memory_irq_save();
+    spinlock_lock(&cpu->lock);
+    cpu->lazy=true;
+    spinlock_unlock(&cpu->lock);
+    memory_irq_restore(flags);
+}
+
+/**
+ * 当前CPU退出惰性TLB模式。惰性期间错过的刷新在此补做。
+ * 
+ * @return 无返回值。
+ */
+void tlb_leave_lazy(void)
+{
+    uint32 id=get_current_cpu_id();
+    if(id>=CPU_ID_LIMIT)
+    {
+        return;
+    }
+    tlb_cpu* cpu=&tlb_cpus[id];
+    uintn flags=memory_irq_save();
+    spinlock_lock(&cpu->lock);
+    bool stale=cpu->stale;
+    bool global=cpu->stale_global;
+    cpu->lazy=false;
+    cpu->stale=false;
+    cpu->stale_global=false;
+    spinlock_unlock(&cpu->lock);
+    if(stale)
+    {
+        tlb_flush_local(0,0,true,global);
+    }
+    memory_irq_restore(flags);
+}
+
+/**
+ * 处理发给当前CPU的击落请求。供不能接收击落中断的CPU在等待循环中轮询调用。
+ * 
+ * @return 无返回值。
+ */
+void tlb_poll(void)
+{
+    uint32 id=get_current_cpu_id();
+    if(id<CPU_ID_LIMIT)
+    {
+        tlb_process(&tlb_cpus[id]);
+    }
+}
+
+/**
+ * TLB击落中断处理。由INTERRUPT_VECTOR_TLB_SHOOTDOWN向量的中断入口调用。
+ * 
+ * @return 无返回值。
+ */
+void tlb_shootdown_interrupt(void)
+{
+    uint32 id=get_current_cpu_id();
+    if(id<CPU_ID_LIMIT)
+    {
+        tlb_cpus[id].ipis++;
+        tlb_process(&tlb_cpus[id]);
+    }
+    apic_eoi();
+}
+
+/**
+ * 输出TLB击落统计。
+ * 
+ * @param handle 输入输出句柄。
+ * 
+ * @return 无返回值。
+ */
+void tlb_dump_stats(io_handle* handle)
+{
+    for(uint32 id=0;id<CPU_ID_LIMIT;id++)
+    {
+        tlb_cpu* cpu=&tlb_cpus[id];
+        if(cpu->online)
+        {
+            format_print(handle,"[aos.kernel.memory] TLB shootdown CPU %u: %U requests, %U IPIs, %U merged, "
+                "%U skipped while lazy.\n",id,atomic_load(&cpu->requested),cpu->ipis,cpu->merged,cpu->skipped);
+        }
+    }
+}
+
+/**
+ * 设置INVPCID支持状态。
+ * 
+ * @param enable 支持INVPCID。
+ * 
+ * @return 无返回值。
+ */
+void memory_tlb_set_invpcid(bool enable)
+{
+    invpcid_status=enable;
+}
+
+/**
+ * 当前CPU加入TLB击落。每个CPU在修改或使用内核映射前调用一次。
+ * 
+ * @return 成功加入返回真。
+ */
+bool memory_tlb_init(void)
+{
+    uint32 id=get_current_cpu_id();
+    if(id>=CPU_ID_LIMIT)
+    {
+        return false;
+    }
+    tlb_cpu* cpu=&tlb_cpus[id];
+    if(!cpu->online)
+    {
+        spinlock_init(&cpu->lock);
+        atomic_init(&cpu->requested,0);
+        atomic_init(&cpu->completed,0);
+        cpu->online=true;
+    }
+    tlb_space_activate(&kernel_space);
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,892 @@
+/**
+ * 内核线性区域管理系统。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#include <memory/slab.h>
+#include <memory/vma.h>
+#include <support/sync.h>
+#include <support/util.h>
+#include "memoryi.h"
+
+/**
+ * 管理范围下界。
+ */
+const static uintn VMA_SPACE_LOW=0;
+
+/**
+ * 管理范围上界。最高一页不参与分配，使结束地址不会回绕。
+ */
+const static uintn VMA_SPACE_HIGH=0-(uintn)SIZE_4KB;
+
+/**
+ * 四级分页下低半区的结束地址。
+ */
+const static uintn VMA_CANONICAL_LA48=__UINT64_C(0x800000000000);
+
+/**
+ * 五级分页下低半区的结束地址。
+ */
+const static uintn VMA_CANONICAL_LA57=__UINT64_C(0x100000000000000);
+
+/**
+ * 无锁查找的步数上限。红黑树高度不超过节点数对数的两倍，超过上限说明读到了写者修改到一半的链接。
+ */
+const static uintn VMA_WALK_LIMIT=128;
+
+/**
+ * 红黑树根节点。
+ */
+static vma_node* root=null;
+
+/**
+ * 线性区域节点缓存。
+ */
+static slab_cache* vma_cache=null;
+
+/**
+ * 树内区域数。限制逐个检查空隙时的步数。
+ */
+static uintn vma_count=0;
+
+/**
+ * 线性区域锁。插入与移除在写者锁内进行，查找不加锁，读到修改中途的树时按序号重试，
+ * 移除的节点经宽限期后才释放。
+ */
+static seqlock lock;
+
+/**
+ * 获取子树最大空隙。
+ * 
+ * @param node 子树根节点。
+ * 
+ * @return 最大空隙，空树返回0。
+ */
+static inline uintn vma_subtree_gap(const vma_node* node)
+{
+    return node==null?0:node->max_gap;
+}
+
+/**
+ * 由节点自身与子节点重新计算子树最大空隙。
+ * 
+ * @param node 节点。
+ * 
+ * @return 无返回值。
+ */
+static inline void vma_update(vma_node* node)
+{
+    node->max_gap=max(node->gap,max(vma_subtree_gap(node->left),vma_subtree_gap(node->right)));
+}
+
+/**
+ * 从节点向上重新计算到根的全部最大空隙。
+ * 
+ * @param node 起始节点。
+ * 
+ * @return 无返回值。
+ */
+static void vma_propagate(vma_node* node)
+{
+    while(node!=null)
+    {
+        vma_update(node);
+        node=node->parent;
+    }
+}
+
+/**
+ * 用新子树替换父节点中指向旧子树的链接。
+ * 
+ * @param old  旧子树根节点。
+ * @param node 新子树根节点，可为空。
+ * 
+ * @return 无返回值。
+ */
+static void vma_replace(vma_node* old,vma_node* node)
+{
+    if(old->parent==null)
+    {
+        root=node;
+    }
+    else if(old==old->parent->left)
+    {
+        old->parent->left=node;
+    }
+    else
+    {
+        old->parent->right=node;
+    }
+    if(node!=null)
+    {
+        node->parent=old->parent;
+    }
+}
+
+/**
+ * 左旋。旋转只改变两个节点的子树，因此只需重算这两个节点。
+ * 
+ * @param node 旋转节点。
+ * 
+ * @return 无返回值。
+ */
+static void vma_rotate_left(vma_node* node)
+{
+    vma_node* right=node->right;
+    node->right=right->left;
+    if(right->left!=null)
+    {
+        right->left->parent=node;
+    }
+    vma_replace(node,right);
+    right->left=node;
+    node->parent=right;
+    vma_update(node);
+    vma_update(right);
+}
+
+/**
+ * 右旋。旋转只改变两个节点的子树，因此只需重算这两个节点。
+ * 
+ * @param node 旋转节点。
+ * 
+ * @return 无返回值。
+ */
+static void vma_rotate_right(vma_node* node)
+{
+    vma_node* left=node->left;
+    node->left=left->right;
+    if(left->right!=null)
+    {
+        left->right->parent=node;
+    }
+    vma_replace(node,left);
+    left->right=node;
+    node->parent=left;
+    vma_update(node);
+    vma_update(left);
+}
+
+/**
+ * 获取节点的中序前驱。
+ * 
+ * @param node 节点。
+ * 
+ * @return 前驱节点，不存在返回空指针。
+ */
+static vma_node* vma_prev(vma_node* node)
+{
+    if(node->left!=null)
+    {
+        node=node->left;
+        while(node->right!=null)
+        {
+            node=node->right;
+        }
+        return node;
+    }
+    while(node->parent!=null&&node==node->parent->left)
+    {
+        node=node->parent;
+    }
+    return node->parent;
+}
+
+/**
+ * 获取节点的中序后继。
+ * 
+ * @param node 节点。
+ * 
+ * @return 后继节点，不存在返回空指针。
+ */
+static vma_node* vma_next(vma_node* node)
+{
+    if(node->right!=null)
+    {
+        node=node->right;
+        while(node->left!=null)
+        {
+            node=node->left;
+        }
+        return node;
+    }
+    while(node->parent!=null&&node==node->parent->right)
+    {
+        node=node->parent;
+    }
+    return node->parent;
+}
+
+/**
+ * 重新计算节点与前驱之间的空隙并向上传播。
+ * 
+ * @param node 节点。
+ * @param prev 前驱节点，可为空。
+ * 
+ * @return 无返回值。
+ */
+static void vma_set_gap(vma_node* node,const vma_node* prev)
+{
+    uintn prev_end=prev==null?VMA_SPACE_LOW:prev->end;
+    node->gap=node->start>prev_end?node->start-prev_end:0;
+    vma_propagate(node);
+}
+
+/**
+ * 插入后修复红黑树性质。
+ * 
+ * @param node 新插入的红色节点。
+ * 
+ * @return 无返回值。
+ */
+static void vma_insert_fixup(vma_node* node)
+{
+    while(node->parent!=null&&node->parent->red)
+    {
+        vma_node* parent=node->parent;
+        vma_node* grand=parent->parent;
+        if(parent==grand->left)
+        {
+            vma_node* uncle=grand->right;
+            if(uncle!=null&&uncle->red)
+            {
+                parent->red=false;
+                uncle->red=false;
+                grand->red=true;
+                node=grand;
+                continue;
+            }
+            if(node==parent->right)
+            {
+                vma_rotate_left(parent);
+                node=parent;
+                parent=node->parent;
+            }
+            parent->red=false;
+            grand->red=true;
+            vma_rotate_right(grand);
+        }
+        else
+        {
+            vma_node* uncle=grand->left;
+            if(uncle!=null&&uncle->red)
+            {
+                parent->red=false;
+                uncle->red=false;
+                grand->red=true;
+                node=grand;
+                continue;
+            }
+            if(node==parent->left)
+            {
+                vma_rotate_right(parent);
+                node=parent;
+                parent=node->parent;
+            }
+            parent->red=false;
+            grand->red=true;
+            vma_rotate_left(grand);
+        }
+    }
+    root->red=false;
+}
+
+/**
+ * 删除后修复红黑树性质。
+ * 
+ * @param node   替代被删除位置的节点，可为空。
+ * @param parent 该节点的父节点。
+ * 
+ * @return 无返回值。
+ */
+static void vma_remove_fixup(vma_node* node,vma_node* parent)
+{
+    while(node!=root&&(node==null||!node->red))
+    {
+        if(node==parent->left)
+        {
+            vma_node* sibling=parent->right;
+            if(sibling->red)
+            {
+                sibling->red=false;
+                parent->red=true;
+                vma_rotate_left(parent);
+                sibling=parent->right;
+            }
+            if((sibling->left==null||!sibling->left->red)&&(sibling->right==null||!sibling->right->red))
+            {
+                sibling->red=true;
+                node=parent;
+                parent=node->parent;
+                continue;
+            }
+            if(sibling->right==null||!sibling->right->red)
+            {
+                sibling->left->red=false;
+                sibling->red=true;
+                vma_rotate_right(sibling);
+                sibling=parent->right;
+            }
+            sibling->red=parent->red;
+            parent->red=false;
+            sibling->right->red=false;
+            vma_rotate_left(parent);
+        }
+        else
+        {
+            vma_node* sibling=parent->left;
+            if(sibling->red)
+            {
+                sibling->red=false;
+                parent->red=true;
+                vma_rotate_right(parent);
+                sibling=parent->left;
+            }
+            if((sibling->left==null||!sibling->left->red)&&(sibling->right==null||!sibling->right->red))
+            {
+                sibling->red=true;
+                node=parent;
+                parent=node->parent;
+                continue;
+            }
+            if(sibling->left==null||!sibling->left->red)
+            {
+                sibling->right->red=false;
+                sibling->red=true;
+                vma_rotate_left(sibling);
+                sibling=parent->left;
+            }
+            sibling->red=parent->red;
+            parent->red=false;
+            sibling->left->red=false;
+            vma_rotate_right(parent);
+        }
+        node=root;
+    }
+    if(node!=null)
+    {
+        node->red=false;
+    }
+}
+
+/**
+ * 查找与范围重叠的区域。区域互不重叠且按地址有序，因此沿一条路径即可判定。
+ * 
+ * @param start 起始地址。
+ * @param end   结束地址。
+ * 
+ * @return 重叠区域，不存在或超过步数上限返回空指针。
+ */
+static vma_node* vma_search_overlap(uintn start,uintn end)
+{
+    vma_node* node=rcu_dereference(root);
+    for(uintn steps=0;node!=null&&steps<VMA_WALK_LIMIT;steps++)
+    {
+        if(node->end<=start)
+        {
+            node=rcu_dereference(node->right);
+        }
+        else if(node->start>=end)
+        {
+            node=rcu_dereference(node->left);
+        }
+        else
+        {
+            return node;
+        }
+    }
+    return null;
+}
+
+/**
+ * 检查范围是否位于管理范围内。
+ * 
+ * @param vaddr 起始地址。
+ * @param pages 页数。
+ * 
+ * @return 范围合法返回真。
+ */
+static inline bool vma_range_valid(uintn vaddr,uintn pages)
+{
+    return pages!=0&&vaddr<VMA_SPACE_HIGH&&pages<=(VMA_SPACE_HIGH-vaddr)/SIZE_4KB;
+}
+
+/**
+ * 把节点链入红黑树。调用者需保证范围不与已有区域重叠。
+ * 
+ * @param node 新节点。
+ * 
+ * @return 无返回值。
+ */
+static void vma_link(vma_node* node)
+{
+    vma_node* parent=null;
+    vma_node** link=&root;
+    while(*link!=null)
+    {
+        parent=*link;
+        link=node->start<parent->start?&parent->left:&parent->right;
+    }
+    node->parent=parent;
+    node->left=null;
+    node->right=null;
+    node->red=true;
+    *link=node;
+
+    vma_count++;
+    vma_set_gap(node,vma_prev(node));
+    vma_node* next=vma_next(node);
+    if(next!=null)
+    {
+        vma_set_gap(next,node);
+    }
+    vma_insert_fixup(node);
+}
+
+/**
+ * 把节点移出红黑树。
+ * 
+ * @param node 待移除节点。
+ * 
+ * @return 无返回值。
+ */
+static void vma_unlink(vma_node* node)
+{
+    vma_node* prev=vma_prev(node);
+    vma_node* next=vma_next(node);
+    vma_node* child;
+    vma_node* parent;
+    bool red=node->red;
+    vma_count--;
+    if(node->left==null)
+    {
+        child=node->right;
+        parent=node->parent;
+        vma_replace(node,child);
+    }
+    else if(node->right==null)
+    {
+        child=node->left;
+        parent=node->parent;
+        vma_replace(node,child);
+    }
+    else
+    {
+        /*双子节点时由后继接替位置，后继必无左子节点*/
+        red=next->red;
+        child=next->right;
+        if(next->parent==node)
+        {
+            parent=next;
+        }
+        else
+        {
+            parent=next->parent;
+            vma_replace(next,child);
+            next->right=node->right;
+            next->right->parent=next;
+        }
+        vma_replace(node,next);
+        next->left=node->left;
+        next->left->parent=next;
+        next->red=node->red;
+    }
+    vma_propagate(parent);
+    if(!red)
+    {
+        vma_remove_fixup(child,parent);
+    }
+    if(next!=null)
+    {
+        vma_set_gap(next,prev);
+    }
+}
+
+/**
+ * 检查空隙内能否放下对齐的范围。
+ * 
+ * @param gap_start 空隙起始地址。
+ * @param gap_end   空隙结束地址。
+ * @param length    范围长度。
+ * @param align     对齐。
+ * @param low       查找下界。
+ * @param high      查找上界。
+ * 
+ * @return 能放下返回起始地址，否则返回0。
+ */
+static uintn vma_fit(uintn gap_start,uintn gap_end,uintn length,uintn align,uintn low,uintn high)
+{
+    uintn start=align_up(max(gap_start,low),align);
+    uintn end=min(gap_end,high);
+    if(start<gap_start||start>end||end-start<length)
+    {
+        return 0;
+    }
+    return start;
+}
+
+/**
+ * 按地址顺序在树内查找第一个不小于门限且放得下对齐范围的空隙。按子树最大空隙是否达到门限剪枝，
+ * 门限不小于长度加对齐余量时查找沿至多两条根到叶路径进行。超过步数上限时放弃，由无锁调用者重试。
+ * 
+ * @param length 范围长度。
+ * @param align  对齐。
+ * @param low    查找下界。
+ * @param high   查找上界。
+ * @param need   空隙大小门限，不小于长度。
+ * @param limit  步数上限。
+ * @param start  输出找到的起始地址，没有找到时为0。
+ * 
+ * @return 查找完成返回真，超过步数上限返回假。
+ */
+static bool vma_search_gap(uintn length,uintn align,uintn low,uintn high,uintn need,uintn limit,uintn* start)
+{
+    vma_node* node=rcu_dereference(root);
+    bool down=true;
+    uintn steps=0;
+    *start=0;
+    if(node==null||node->max_gap<need)
+    {
+        return true;
+    }
+    while(node!=null&&steps++<limit)
+    {
+        /*无锁调用时链接可能被写者修改，每个链接只读取一次*/
+        vma_node* left=rcu_dereference(node->left);
+        vma_node* right=rcu_dereference(node->right);
+        uintn gap_start=node->start-node->gap;
+
+        /*左子树的空隙都在本节点空隙之前，全部低于下界时不必进入*/
+        if(down&&left!=null&&left->max_gap>=need&&gap_start>=low+length)
+        {
+            node=left;
+            continue;
+        }
+        if(gap_start>=high)
+        {
+            return true;
+        }
+        if(node->gap>=need)
+        {
+            *start=vma_fit(gap_start,node->start,length,align,low,high);
+            if(*start!=0)
+            {
+                return true;
+            }
+        }
+        if(right!=null&&right->max_gap>=need)
+        {
+            node=right;
+            down=true;
+            continue;
+        }
+
+        /*回溯到第一个从左子树返回的祖先，检查它自身的空隙*/
+        vma_node* parent=rcu_dereference(node->parent);
+        while(parent!=null&&node==rcu_dereference(parent->right)&&steps++<limit)
+        {
+            node=parent;
+            parent=rcu_dereference(node->parent);
+        }
+        node=parent;
+        down=false;
+    }
+    return node==null;
+}
+
+/**
+ * 按地址顺序查找第一个放得下范围的空隙。先只查不小于长度加对齐余量的空隙，它们必然放得下对齐的范围；
+ * 找不到时再逐个检查不小于长度的空隙，找出恰好放得下的对齐范围，例如按1GB对齐的1GB空隙；
+ * 最后检查最高区域之后的空隙。
+ * 
+ * @param length 范围长度。
+ * @param align  对齐。
+ * @param low    查找下界。
+ * @param high   查找上界。
+ * 
+ * @return 成功找到返回起始地址，失败返回0。
+ */
+static uintn vma_search_free(uintn length,uintn align,uintn low,uintn high)
+{
+    uintn need=length>UINTN_MAX-(align-SIZE_4KB)?UINTN_MAX:length+align-SIZE_4KB;
+    uintn start;
+    if(!vma_search_gap(length,align,low,high,need,VMA_WALK_LIMIT*4,&start)||start!=0)
+    {
+        return start;
+    }
+
+    /*逐个检查时每个节点至多经过三次：下行、检查自身空隙与回溯*/
+    if(need>length&&(!vma_search_gap(length,align,low,high,length,vma_count*3+VMA_WALK_LIMIT,&start)||start!=0))
+    {
+        return start;
+    }
+
+    /*最高区域之后的空隙不在树中记录*/
+    vma_node* last=rcu_dereference(root);
+    vma_node* right=last==null?null:rcu_dereference(last->right);
+    for(uintn steps=0;right!=null&&steps<VMA_WALK_LIMIT;steps++)
+    {
+        last=right;
+        right=rcu_dereference(last->right);
+    }
+    if(right!=null)
+    {
+        return 0;
+    }
+    return vma_fit(last==null?VMA_SPACE_LOW:last->end,VMA_SPACE_HIGH,length,align,low,high);
+}
+
+/**
+ * 宽限期结束后释放移除的节点。
+ * 
+ * @param head 节点的延迟回调结点。
+ * 
+ * @return 无返回值。
+ */
+static void vma_free_node(rcu_head* head)
+{
+    slab_cache_free(vma_cache,(uint8*)head-offset_of(vma_node,rcu));
+}
+
+/**
+ * 查找包含地址的线性区域。无锁查找，返回的区域只在调用者的读临界区内有效。
+ * 
+ * @param vaddr 线性地址。
+ * 
+ * @return 找到返回区域，否则返回空指针。
+ */
+const vma_node* vma_find(uintn vaddr)
+{
+    vma_node* node;
+    uint32 sequence;
+    rcu_read_lock();
+    do
+    {
+        sequence=seqlock_read_begin(&lock);
+        node=rcu_dereference(root);
+        for(uintn steps=0;node!=null&&steps<VMA_WALK_LIMIT;steps++)
+        {
+            if(vaddr<node->start)
+            {
+                node=rcu_dereference(node->left);
+            }
+            else if(vaddr>=node->end)
+            {
+                node=rcu_dereference(node->right);
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
+    while(seqlock_read_retry(&lock,sequence));
+    rcu_read_unlock();
+    return node;
+}
+
+/**
+ * 检查一段范围是否与已有线性区域重叠。
+ * 
+ * @param vaddr 起始地址。
+ * @param pages 页数。
+ * 
+ * @return 存在重叠或范围非法返回真。
+ */
+bool vma_overlaps(uintn vaddr,uintn pages)
+{
+    if(!vma_range_valid(vaddr,pages))
+    {
+        return true;
+    }
+    vma_node* node;
+    uint32 sequence;
+    rcu_read_lock();
+    do
+    {
+        sequence=seqlock_read_begin(&lock);
+        node=vma_search_overlap(vaddr,vaddr+pages*SIZE_4KB);
+    }
+    while(seqlock_read_retry(&lock,sequence));
+    rcu_read_unlock();
+    return node!=null;
+}
+
+/**
+ * 插入一个线性区域。
+ * 
+ * @param vaddr 起始地址，需按4KB对齐。
+ * @param pages 页数。
+ * @param flags 区域标志。
+ * 
+ * @return 成功插入返回区域，范围重叠或内存不足返回空指针。
+ */
+const vma_node* vma_insert(uintn vaddr,uintn pages,uint64 flags)
+{
+    if(!is_aligned(vaddr,SIZE_4KB)||!vma_range_valid(vaddr,pages))
+    {
+        return null;
+    }
+    vma_node* node=(vma_node*)slab_cache_alloc(vma_cache);
+    if(node==null)
+    {
+        return null;
+    }
+    node->start=vaddr;
+    node->end=vaddr+pages*SIZE_4KB;
+    node->flags=flags;
+
+    seqlock_write_lock(&lock);
+    if(vma_search_overlap(node->start,node->end)!=null)
+    {
+        seqlock_write_unlock(&lock);
+        slab_cache_free(vma_cache,node);
+        return null;
+    }
+    vma_link(node);
+    seqlock_write_unlock(&lock);
+    return node;
+}
+
+/**
+ * 移除起始于给定地址的线性区域。
+ * 
+ * @param vaddr 起始地址。
+ * 
+ * @return 成功移除返回真。
+ */
+bool vma_remove(uintn vaddr)
+{
+    seqlock_write_lock(&lock);
+    vma_node* node=root;
+    while(node!=null&&node->start!=vaddr)
+    {
+        node=vaddr<node->start?node->left:node->right;
+    }
+    if(node!=null)
+    {
+        vma_unlink(node);
+    }
+    seqlock_write_unlock(&lock);
+
+    if(node==null)
+    {
+        return false;
+    }
+    /*无锁查找者可能仍在访问该节点*/
+    call_rcu(&node->rcu,vma_free_node);
+    return true;
+}
+
+/**
+ * 在范围内查找满足对齐要求的空闲线性范围。优先取第一个不小于长度加对齐余量的空隙中最低的可用地址，
+ * 没有这样的空隙时取恰好放得下的最低地址。
+ * 
+ * @param pages 页数。
+ * @param align 对齐，需为不小于4KB的2的幂。
+ * @param low   范围下界。
+ * @param high  范围上界，不包含在范围内。
+ * 
+ * @return 成功找到返回起始地址，失败返回0。
+ */
+uintn vma_find_free(uintn pages,uintn align,uintn low,uintn high)
+{
+    if(align<SIZE_4KB||(align&(align-1))!=0)
+    {
+        return 0;
+    }
+    low=max(align_up(low,SIZE_4KB),max(VMA_SPACE_LOW,(uintn)SIZE_4KB));
+    high=min(high,VMA_SPACE_HIGH);
+    if(pages==0||low>=high||pages>(high-low)/SIZE_4KB||align>high-low)
+    {
+        return 0;
+    }
+
+    uintn start;
+    uint32 sequence;
+    rcu_read_lock();
+    do
+    {
+        sequence=seqlock_read_begin(&lock);
+        start=vma_search_free(pages*SIZE_4KB,align,low,high);
+    }
+    while(seqlock_read_retry(&lock,sequence));
+    rcu_read_unlock();
+    return start;
+}
+
+/**
+ * 把启动阶段线性区域的缓存类型转换为内核线性区域类型。两者都占用标志最低字节。
+ * 
+ * @param flags 启动阶段线性区域标志。
+ * 
+ * @return 内核线性区域类型。
+ */
+static uint64 vma_boot_type(uint64 flags)
+{
+    switch(flags&VMA_TYPE_MASK)
+    {
+        case AOS_BOOT_VMA_TYPE_WB:
+            return VMA_TYPE_MEMORY;
+        case AOS_BOOT_VMA_TYPE_UC:
+        case AOS_BOOT_VMA_TYPE_UCM:
+            return VMA_TYPE_DEVICE;
+        case AOS_BOOT_VMA_TYPE_WT:
+        case AOS_BOOT_VMA_TYPE_WP:
+            return VMA_TYPE_READ_OPTIMIZED_DEVICE;
+        case AOS_BOOT_VMA_TYPE_WC:
+            return VMA_TYPE_WRITE_OPTIMIZED_DEVICE;
+        default:
+            return VMA_TYPE_RESERVED;
+    }
+}
+
+/**
+ * 初始化内核线性区域管理，导入启动阶段建立的线性区域链表。
+ * 
+ * @param params 启动参数。
+ * 
+ * @return 初始化成功返回真。
+ */
+bool memory_vma_init(aos_boot_params* params)
+{
+    seqlock_init(&lock);
+    root=null;
+    vma_count=0;
+    vma_cache=slab_cache_create("vma",sizeof(vma_node),0,null);
+    if(vma_cache==null)
+    {
+        return false;
+    }
+
+    /*非规范地址空洞登记为保留区域，查找空闲范围时自然跳过*/
+    uintn canonical=(params->state.state&AOS_STATE_LA57)?VMA_CANONICAL_LA57:VMA_CANONICAL_LA48;
+    if(vma_insert(canonical,(0-canonical-canonical)/SIZE_4KB,VMA_TYPE_RESERVED)==null)
+    {
+        return false;
+    }
+
+    /*启动阶段的类型字节是缓存类型，已分配标志与大页标志位置也不同，都需要转换*/
+    bool result=true;
+    for(aos_boot_vma* boot=params->vma_head;boot!=null;boot=boot->next)
+    {
+        uint64 flags=vma_boot_type(boot->flags)|(boot->flags&(VMA_FLAG_READ|VMA_FLAG_WRITE|VMA_FLAG_EXECUTE|
+            VMA_FLAG_USER|VMA_FLAG_GLOBAL));
+        if(boot->flags&AOS_BOOT_VMA_ALLOCATED)
+        {
+            flags|=VMA_FLAG_ALLOCATED;
+        }
+        if(boot->flags&AOS_BOOT_VMA_HUGEPAGE)
+        {
+            flags|=VMA_FLAG_HUGEPAGE;
+        }
+        if(vma_insert(boot->start,(boot->end-boot->start)/SIZE_4KB,flags)==null)
+        {
+            result=false;
+        }
+    }
+    return result;
+}
\ No newline at end of file
@@ -8,7 +8,14 @@
  */
 #include <panic/callback.h>
 #include <panic/output.h>
+#include <cpu/rcu.h>
 #include <support/control.h>
+#include <support/sync.h>
+
+/**
+ * 回调与输出链表写者锁。恐慌时在读临界区内无锁遍历，注销的结点等宽限期结束后才可复用。零值即为未上锁状态。
+ */
+static spinlock lock;
 
 /**
  * 恐慌回调链表头结点。
@@ -29,20 +36,19 @@ static panic_callback_node* callback_tail=null;
  */
 void register_panic_callback(panic_callback_node* node)
 {
+    spinlock_lock(&lock);
+    node->prev=null;
+    node->next=callback_head;
     if(callback_head==null)
     {
-        callback_head=node;
         callback_tail=node;
-        node->prev=null;
-        node->next=null;
     }
     else
     {
-        node->next=callback_head;
         callback_head->prev=node;
-        callback_head=node;
-        callback_head->prev=null;
     }
+    rcu_assign_pointer(callback_head,node);
+    spinlock_unlock(&lock);
 }
 
 /**
@@ -55,22 +61,21 @@ void register_panic_callback(panic_callback_node* node)
  */
 void register_panic_callback_before(panic_callback_node* node,panic_callback_node* next)
 {
+    spinlock_lock(&lock);
     panic_callback_node* prev=next->prev;
 
+    node->prev=prev;
+    node->next=next;
+    next->prev=node;
     if(prev==null)
     {
-        node->next=next;
-        next->prev=node;
-        callback_head=node;
-        callback_head->prev=null;
+        rcu_assign_pointer(callback_head,node);
     }
     else
     {
-        prev->next=node;
-        next->prev=node;
-        node->prev=prev;
-        node->next=next;
+        rcu_assign_pointer(prev->next,node);
     }
+    spinlock_unlock(&lock);
 }
 
 /**
@@ -83,26 +88,25 @@ void register_panic_callback_before(panic_callback_node* node,panic_callback_nod
  */
 void register_panic_callback_after(panic_callback_node* node,panic_callback_node* prev)
 {
+    spinlock_lock(&lock);
     panic_callback_node* next=prev->next;
 
+    node->prev=prev;
+    node->next=next;
     if(next==null)
     {
-        node->prev=prev;
-        prev->next=node;
         callback_tail=node;
-        callback_tail->next=null;
     }
     else
     {
-        prev->next=node;
         next->prev=node;
-        node->prev=prev;
-        node->next=next;
     }
+    rcu_assign_pointer(prev->next,node);
+    spinlock_unlock(&lock);
 }
 
 /**
- * 注销一个恐慌回调函数。
+ * 注销一个恐慌回调函数。等待宽限期结束，返回后结点可以复用，不能在读临界区内调用。
  * 
  * @param node 恐慌回调结点。结点内存应该由各模块提供稳定内存区域。
  * 
@@ -110,33 +114,32 @@ void register_panic_callback_after(panic_callback_node* node,panic_callback_node
  */
 void unregister_panic_callback(panic_callback_node* node)
 {
+    spinlock_lock(&lock);
     panic_callback_node* prev=node->prev;
     panic_callback_node* next=node->next;
 
-    if(prev==null&&next==null)
+    if(prev==null)
     {
-        callback_head=null;
-        callback_tail=null;
+        rcu_assign_pointer(callback_head,next);
     }
-    else if(prev==null)
+    else
     {
-        callback_head=next;
-        callback_head->prev=null;
-        node->next=null;
+        rcu_assign_pointer(prev->next,next);
     }
-    else if(next==null)
+    if(next==null)
     {
         callback_tail=prev;
-        callback_tail->next=null;
-        node->prev=null;
     }
     else
     {
-        prev->next=next;
         next->prev=prev;
-        node->prev=null;
-        node->next=null;
     }
+    spinlock_unlock(&lock);
+
+    /*读者可能仍停在该结点上，等它们离开后才能断开结点的链接*/
+    synchronize_rcu();
+    node->prev=null;
+    node->next=null;
 }
 
 /**
@@ -158,24 +161,23 @@ static panic_output_node* output_tail=null;
  */
 void register_panic_output(panic_output_node* node)
 {
+    spinlock_lock(&lock);
+    node->prev=null;
+    node->next=output_head;
     if(output_head==null)
     {
-        output_head=node;
         output_tail=node;
-        node->prev=null;
-        node->next=null;
     }
     else
     {
-        node->next=output_head;
         output_head->prev=node;
-        output_head=node;
-        output_head->prev=null;
     }
+    rcu_assign_pointer(output_head,node);
+    spinlock_unlock(&lock);
 }
 
 /**
- * 注销一个恐慌输出函数。
+ * 注销一个恐慌输出函数。等待宽限期结束，返回后结点可以复用，不能在读临界区内调用。
  * 
  * @param node 恐慌输出结点。结点内存应该由各模块提供稳定内存区域。
  * 
@@ -183,33 +185,32 @@ void register_panic_output(panic_output_node* node)
  */
 void unregister_panic_output(panic_output_node* node)
 {
+    spinlock_lock(&lock);
     panic_output_node* prev=node->prev;
     panic_output_node* next=node->next;
 
-    if(prev==null&&next==null)
+    if(prev==null)
     {
-        output_head=null;
-        output_tail=null;
+        rcu_assign_pointer(output_head,next);
     }
-    else if(prev==null)
+    else
     {
-        output_head=next;
-        output_head->prev=null;
-        node->next=null;
+        rcu_assign_pointer(prev->next,next);
     }
-    else if(next==null)
+    if(next==null)
     {
         output_tail=prev;
-        output_tail->next=null;
-        node->prev=null;
     }
     else
     {
-        prev->next=next;
         next->prev=prev;
-        node->prev=null;
-        node->next=null;
     }
+    spinlock_unlock(&lock);
+
+    /*读者可能仍停在该结点上，等它们离开后才能断开结点的链接*/
+    synchronize_rcu();
+    node->prev=null;
+    node->next=null;
 }
 
 /**
@@ -242,14 +243,16 @@ void noreturn panic(const char8* format,...)
 
     /*多核通知恐慌，这里还未实现*/
 
-    panic_callback_node* callback=callback_head;
+    /*其他CPU可能正在注册或注销，读临界区内无锁遍历，持有写者锁的CPU停止或嵌套恐慌都不会阻塞*/
+    rcu_read_lock();
+    panic_callback_node* callback=rcu_dereference(callback_head);
     while(callback!=null)
     {
         callback->callback();
-        callback=callback->next;
+        callback=rcu_dereference(callback->next);
     }
 
-    panic_output_node* output=output_head;
+    panic_output_node* output=rcu_dereference(output_head);
     va_list args;
     va_start(args,format);
     while(output!=null)
@@ -258,8 +261,9 @@ void noreturn panic(const char8* format,...)
         va_copy(list,args);
         output->output(format,list);
         va_end(list);
-        output=output->next;
+        output=rcu_dereference(output->next);
     }
+    rcu_read_unlock();
 
     if(managed!=null)
     {
@@ -205,4 +205,59 @@ const void* memory_find(const void* m,uint8 byte,uintn n)
         }
         return null;
     }
+}
+
+/**
+ * 以非临时存储将内存m前n个字节设置成0。写入绕过缓存，不会挤出缓存中的热数据，
+ * 适合清零短期内不会访问的大块内存。返回前已完成存储围栏。
+ * 
+ * @param m 内存m。
+ * @param n 操作字节数。
+ * 
+ * @return 返回内存m的起始地址，便于进行链式处理。
+ */
+void* memory_zero_nontemporal(void* m,uintn n)
+{
+    if(n==0||m==null)
+    {
+        return m;
+    }
+
+    /*非临时存储按8字节进行，首尾不对齐部分使用普通存储*/
+    uint8* d=(uint8*)m;
+    uintn head=(8-((uintn)d&7))&7;
+    if(head>n)
+    {
+        head=n;
+    }
+    memory_set(d,0,head);
+    d+=head;
+    n-=head;
+
+    uintn blocks=n>>5;
+    uintn words=(n>>3)&3;
+    if(blocks!=0)
+    {
+        __asm__ volatile(
+            "1:\n\t"
+            "movnti %2,(%0)\n\t"
+            "movnti %2,8(%0)\n\t"
+            "movnti %2,16(%0)\n\t"
+            "movnti %2,24(%0)\n\t"
+            "add $32,%0\n\t"
+            "dec %1\n\t"
+            "jnz 1b"
+            :"+r"(d),"+r"(blocks)
+            :"r"((uint64)0)
+            :"memory","cc"
+        );
+    }
+    for(;words>0;words--)
+    {
+        __asm__ volatile("movnti %1,(%0)"::"r"(d),"r"((uint64)0):"memory");
+        d+=8;
+    }
+    __asm__ volatile("sfence":::"memory");
+    memory_set(d,0,n&7);
+    return m;
 }
\ No newline at end of file
@@ -7,8 +7,107 @@
  * SPDX-License-Identifier: MIT
  */
 #include <support/control.h>
+#include <support/io.h>
 #include <support/sync.h>
 
+/**
+ * 读写锁写者持有标志。
+ */
+const static uint32 RWLOCK_WRITER=BIT0;
+
+/**
+ * 读写锁写者等待标志。
+ */
+const static uint32 RWLOCK_WAITING=BIT1;
+
+/**
+ * 读写锁单个读者的计数。
+ */
+const static uint32 RWLOCK_READER=BIT2;
+
+/**
+ * 锁指针为空时终止CPU。
+ * 
+ * @return 不再返回。
+ */
+static void sync_halt(void)
+{
+    /*锁指针为空必须终止CPU以保证数据安全，此时应该重启计算机了*/
+    while(true)
+    {
+        x86_cpu_halt();
+    }
+}
+
+#ifdef AOS_KERNEL_LOCK_STATS
+/**
+ * 持有者累加统计值。只有持有者写入，不需要加锁前缀。
+ * 
+ * @param counter 统计值。
+ * @param value   增量。
+ * 
+ * @return 无返回值。
+ */
+static inline void sync_stats_add(atomic_uint64* counter,uint64 value)
+{
+    atomic_store_explicit(counter,atomic_load_explicit(counter,MEMORY_ORDER_RELAXED)+value,MEMORY_ORDER_RELAXED);
+}
+
+/**
+ * 记录一次加锁。在获得锁后调用。
+ * 
+ * @param stats 锁统计。
+ * @param start 开始等待的时间戳，无需等待为0。
+ * 
+ * @return 无返回值。
+ */
+static void sync_stats_acquired(lock_stats* stats,uint64 start)
+{
+    uint64 now=x86_read_tsc();
+    sync_stats_add(&stats->acquires,1);
+    if(start!=0)
+    {
+        sync_stats_add(&stats->contentions,1);
+        sync_stats_add(&stats->wait_cycles,now-start);
+    }
+    stats->hold_start=now;
+}
+
+/**
+ * 记录一次解锁。在释放锁前调用。
+ * 
+ * @param stats 锁统计。
+ * 
+ * @return 无返回值。
+ */
+static void sync_stats_released(lock_stats* stats)
+{
+    uint64 hold=x86_read_tsc()-stats->hold_start;
+    sync_stats_add(&stats->hold_cycles,hold);
+    if(hold>atomic_load_explicit(&stats->hold_max,MEMORY_ORDER_RELAXED))
+    {
+        atomic_store_explicit(&stats->hold_max,hold,MEMORY_ORDER_RELAXED);
+    }
+}
+
+/**
+ * 锁统计初始化。
+ * 
+ * @param stats 锁统计。
+ * 
+ * @return 无返回值。
+ */
+static void sync_stats_init(lock_stats* stats)
+{
+    atomic_init(&stats->acquires,0);
+    atomic_init(&stats->contentions,0);
+    atomic_init(&stats->wait_cycles,0);
+    atomic_init(&stats->hold_cycles,0);
+    atomic_init(&stats->hold_max,0);
+    stats->hold_start=0;
+}
+#endif /*AOS_KERNEL_LOCK_STATS*/
+
 /**
  * 自旋锁初始化。
  * 
@@ -20,7 +119,11 @@ void spinlock_init(spinlock* lock)
 {
     if(lock!=null)
     {
-        atomic_init(&lock->flag,ATOMIC_FLAG_INIT);
+        atomic_init(&lock->next,0);
+        atomic_init(&lock->owner,0);
+#ifdef AOS_KERNEL_LOCK_STATS
+        sync_stats_init(&lock->stats);
+#endif /*AOS_KERNEL_LOCK_STATS*/
     }
 }
 
@@ -33,25 +136,32 @@ void spinlock_init(spinlock* lock)
  */
 void spinlock_lock(spinlock* lock)
 {
-    if(lock!=null)
+    if(lock==null)
     {
-        while(atomic_flag_test_and_set_explicit(&lock->flag,MEMORY_ORDER_ACQUIRE))
-        {
-            x86_cpu_pause();
-        }
+        sync_halt();
     }
-    else
+
+    uint32 ticket=atomic_fetch_add_explicit(&lock->next,1,MEMORY_ORDER_RELAXED);
+    uint32 owner=atomic_load_explicit(&lock->owner,MEMORY_ORDER_ACQUIRE);
+#ifdef AOS_KERNEL_LOCK_STATS
+    uint64 start=owner!=ticket?x86_read_tsc():0;
+#endif /*AOS_KERNEL_LOCK_STATS*/
+    while(owner!=ticket)
     {
-        /*锁指针为空必须终止CPU以保证数据安全，此时应该重启计算机了*/
-        while(true)
+        /*前面每多一个等待者多等一轮，减少对锁所在缓存行的读取*/
+        for(uint32 count=ticket-owner;count!=0;count--)
         {
-            x86_cpu_halt();
+            x86_cpu_pause();
         }
+        owner=atomic_load_explicit(&lock->owner,MEMORY_ORDER_ACQUIRE);
     }
+#ifdef AOS_KERNEL_LOCK_STATS
+    sync_stats_acquired(&lock->stats,start);
+#endif /*AOS_KERNEL_LOCK_STATS*/
 }
 
 /**
- * 自旋锁尝试加锁。
+ * 自旋锁尝试加锁。只在没有持有者与等待者时领取票号。
  * 
  * @param lock 自旋锁。
  * 
@@ -59,7 +169,21 @@ void spinlock_lock(spinlock* lock)
  */
 bool spinlock_try_lock(spinlock* lock)
 {
-    return lock!=null&&!atomic_flag_test_and_set_explicit(&lock->flag,MEMORY_ORDER_ACQUIRE);
+    if(lock==null)
+    {
+        return false;
+    }
+    uint32 ticket=atomic_load_explicit(&lock->next,MEMORY_ORDER_RELAXED);
+    if(atomic_load_explicit(&lock->owner,MEMORY_ORDER_RELAXED)!=ticket||
+        !atomic_compare_exchange_strong_explicit(&lock->next,&ticket,ticket+1,MEMORY_ORDER_ACQUIRE,
+        MEMORY_ORDER_RELAXED))
+    {
+        return false;
+    }
+#ifdef AOS_KERNEL_LOCK_STATS
+    sync_stats_acquired(&lock->stats,0);
+#endif /*AOS_KERNEL_LOCK_STATS*/
+    return true;
 }
 
 /**
@@ -73,6 +197,355 @@ void spinlock_unlock(spinlock* lock)
 {
     if(lock!=null)
     {
-        atomic_flag_clear_explicit(&lock->flag,MEMORY_ORDER_RELEASE);
+#ifdef AOS_KERNEL_LOCK_STATS
+        sync_stats_released(&lock->stats);
+#endif /*AOS_KERNEL_LOCK_STATS*/
+        /*只有持有者写入服务票号，不需要加锁前缀*/
+        uint32 owner=atomic_load_explicit(&lock->owner,MEMORY_ORDER_RELAXED);
+        atomic_store_explicit(&lock->owner,owner+1,MEMORY_ORDER_RELEASE);
+    }
+}
+
+/**
+ * MCS队列锁初始化。
+ * 
+ * @param lock MCS队列锁。
+ * 
+ * @return 无返回值。
+ */
+void mcs_lock_init(mcs_lock* lock)
+{
+    if(lock!=null)
+    {
+        atomic_init(&lock->tail,null);
+#ifdef AOS_KERNEL_LOCK_STATS
+        sync_stats_init(&lock->stats);
+#endif /*AOS_KERNEL_LOCK_STATS*/
+    }
+}
+
+/**
+ * MCS队列锁阻塞加锁。
+ * 
+ * @param lock MCS队列锁。
+ * @param node 加锁者结点。
+ * 
+ * @return 无返回值。
+ */
+void mcs_lock_lock(mcs_lock* lock,mcs_node* node)
+{
+    if(lock==null||node==null)
+    {
+        sync_halt();
+    }
+
+    atomic_store_explicit(&node->next,null,MEMORY_ORDER_RELAXED);
+    atomic_store_explicit(&node->wait,true,MEMORY_ORDER_RELAXED);
+    mcs_node* prev=atomic_exchange_explicit(&lock->tail,node,MEMORY_ORDER_ACQ_REL);
+#ifdef AOS_KERNEL_LOCK_STATS
+    uint64 start=0;
+#endif /*AOS_KERNEL_LOCK_STATS*/
+    if(prev!=null)
+    {
+#ifdef AOS_KERNEL_LOCK_STATS
+        start=x86_read_tsc();
+#endif /*AOS_KERNEL_LOCK_STATS*/
+        /*挂到前驱之后，只在自己的结点上等待前驱交接*/
+        atomic_store_explicit(&prev->next,node,MEMORY_ORDER_RELEASE);
+        while(atomic_load_explicit(&node->wait,MEMORY_ORDER_ACQUIRE))
+        {
+            x86_cpu_pause();
+        }
+    }
+#ifdef AOS_KERNEL_LOCK_STATS
+    sync_stats_acquired(&lock->stats,start);
+#endif /*AOS_KERNEL_LOCK_STATS*/
+}
+
+/**
+ * MCS队列锁尝试加锁。
+ * 
+ * @param lock MCS队列锁。
+ * @param node 加锁者结点。
+ * 
+ * @return 成功上锁返回真。
+ */
+bool mcs_lock_try_lock(mcs_lock* lock,mcs_node* node)
+{
+    if(lock==null||node==null)
+    {
+        return false;
+    }
+    mcs_node* expected=null;
+    atomic_store_explicit(&node->next,null,MEMORY_ORDER_RELAXED);
+    atomic_store_explicit(&node->wait,false,MEMORY_ORDER_RELAXED);
+    if(!atomic_compare_exchange_strong_explicit(&lock->tail,&expected,node,MEMORY_ORDER_ACQ_REL,
+        MEMORY_ORDER_RELAXED))
+    {
+        return false;
+    }
+#ifdef AOS_KERNEL_LOCK_STATS
+    sync_stats_acquired(&lock->stats,0);
+#endif /*AOS_KERNEL_LOCK_STATS*/
+    return true;
+}
+
+/**
+ * MCS队列锁解锁。有后继时把锁直接交给后继。
+ * 
+ * @param lock MCS队列锁。
+ * @param node 加锁时使用的结点。
+ * 
+ * @return 无返回值。
+ */
+void mcs_lock_unlock(mcs_lock* lock,mcs_node* node)
+{
+    if(lock==null||node==null)
+    {
+        return;
+    }
+#ifdef AOS_KERNEL_LOCK_STATS
+    sync_stats_released(&lock->stats);
+#endif /*AOS_KERNEL_LOCK_STATS*/
+    mcs_node* next=atomic_load_explicit(&node->next,MEMORY_ORDER_ACQUIRE);
+    if(next==null)
+    {
+        mcs_node* expected=node;
+        if(atomic_compare_exchange_strong_explicit(&lock->tail,&expected,null,MEMORY_ORDER_RELEASE,
+            MEMORY_ORDER_RELAXED))
+        {
+            return;
+        }
+        /*已有后继交换了队尾，等它挂到本结点之后*/
+        while((next=atomic_load_explicit(&node->next,MEMORY_ORDER_ACQUIRE))==null)
+        {
+            x86_cpu_pause();
+        }
+    }
+    atomic_store_explicit(&next->wait,false,MEMORY_ORDER_RELEASE);
+}
+
+/**
+ * 读写锁初始化。
+ * 
+ * @param lock 读写锁。
+ * 
+ * @return 无返回值。
+ */
+void rwlock_init(rwlock* lock)
+{
+    if(lock!=null)
+    {
+        atomic_init(&lock->state,0);
+    }
+}
+
+/**
+ * 读写锁阻塞加读锁。
+ * 
+ * @param lock 读写锁。
+ * 
+ * @return 无返回值。
+ */
+void rwlock_read_lock(rwlock* lock)
+{
+    if(lock==null)
+    {
+        sync_halt();
+    }
+    while(!rwlock_read_try_lock(lock))
+    {
+        /*只读等待写者离开，不在等待期间反复写锁所在缓存行*/
+        while((atomic_load_explicit(&lock->state,MEMORY_ORDER_RELAXED)&(RWLOCK_WRITER|RWLOCK_WAITING))!=0)
+        {
+            x86_cpu_pause();
+        }
+    }
+}
+
+/**
+ * 读写锁尝试加读锁。有写者持有或等待时失败。
+ * 
+ * @param lock 读写锁。
+ * 
+ * @return 成功上锁返回真。
+ */
+bool rwlock_read_try_lock(rwlock* lock)
+{
+    if(lock==null)
+    {
+        return false;
     }
+    uint32 state=atomic_load_explicit(&lock->state,MEMORY_ORDER_RELAXED);
+    while((state&(RWLOCK_WRITER|RWLOCK_WAITING))==0)
+    {
+        if(atomic_compare_exchange_weak_explicit(&lock->state,&state,state+RWLOCK_READER,MEMORY_ORDER_ACQUIRE,
+            MEMORY_ORDER_RELAXED))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * 读写锁解读锁。
+ * 
+ * @param lock 读写锁。
+ * 
+ * @return 无返回值。
+ */
+void rwlock_read_unlock(rwlock* lock)
+{
+    if(lock!=null)
+    {
+        atomic_fetch_sub_explicit(&lock->state,RWLOCK_READER,MEMORY_ORDER_RELEASE);
+    }
+}
+
+/**
+ * 读写锁阻塞加写锁。先公布等待阻止新读者进入，再等现有读者离开。
+ * 
+ * @param lock 读写锁。
+ * 
+ * @return 无返回值。
+ */
+void rwlock_write_lock(rwlock* lock)
+{
+    if(lock==null)
+    {
+        sync_halt();
+    }
+    uint32 state=atomic_load_explicit(&lock->state,MEMORY_ORDER_RELAXED);
+    while(true)
+    {
+        if((state&~RWLOCK_WAITING)==0)
+        {
+            /*获得锁时清除等待标志，其余等待的写者会重新设置*/
+            if(atomic_compare_exchange_weak_explicit(&lock->state,&state,RWLOCK_WRITER,MEMORY_ORDER_ACQUIRE,
+                MEMORY_ORDER_RELAXED))
+            {
+                return;
+            }
+            continue;
+        }
+        if((state&RWLOCK_WAITING)==0)
+        {
+            atomic_fetch_or_explicit(&lock->state,RWLOCK_WAITING,MEMORY_ORDER_RELAXED);
+        }
+        x86_cpu_pause();
+        state=atomic_load_explicit(&lock->state,MEMORY_ORDER_RELAXED);
+    }
+}
+
+/**
+ * 读写锁尝试加写锁。只在没有读者与写者持有时成功。
+ * 
+ * @param lock 读写锁。
+ * 
+ * @return 成功上锁返回真。
+ */
+bool rwlock_write_try_lock(rwlock* lock)
+{
+    if(lock==null)
+    {
+        return false;
+    }
+    uint32 state=atomic_load_explicit(&lock->state,MEMORY_ORDER_RELAXED);
+    return (state&~RWLOCK_WAITING)==0&&atomic_compare_exchange_strong_explicit(&lock->state,&state,
+        RWLOCK_WRITER,MEMORY_ORDER_ACQUIRE,MEMORY_ORDER_RELAXED);
+}
+
+/**
+ * 读写锁解写锁。保留其他写者设置的等待标志。
+ * 
+ * @param lock 读写锁。
+ * 
+ * @return 无返回值。
+ */
+void rwlock_write_unlock(rwlock* lock)
+{
+    if(lock!=null)
+    {
+        atomic_fetch_and_explicit(&lock->state,~RWLOCK_WRITER,MEMORY_ORDER_RELEASE);
+    }
+}
+
+/**
+ * 顺序锁初始化。
+ * 
+ * @param lock 顺序锁。
+ * 
+ * @return 无返回值。
+ */
+void seqlock_init(seqlock* lock)
+{
+    if(lock!=null)
+    {
+        atomic_init(&lock->sequence,0);
+        spinlock_init(&lock->lock);
+    }
+}
+
+/**
+ * 顺序锁开始读取。等待进行中的写入结束。
+ * 
+ * @param lock 顺序锁。
+ * 
+ * @return 读取开始时的序号，交给seqlock_read_retry检查。
+ */
+uint32 seqlock_read_begin(seqlock* lock)
+{
+    uint32 sequence=atomic_load_explicit(&lock->sequence,MEMORY_ORDER_ACQUIRE);
+    while((sequence&1)!=0)
+    {
+        x86_cpu_pause();
+        sequence=atomic_load_explicit(&lock->sequence,MEMORY_ORDER_ACQUIRE);
+    }
+    return sequence;
+}
+
+/**
+ * 顺序锁检查读取是否需要重试。读到的数据只有在返回假后才能使用。
+ * 
+ * @param lock     顺序锁。
+ * @param sequence seqlock_read_begin返回的序号。
+ * 
+ * @return 读取期间有写入返回真。
+ */
+bool seqlock_read_retry(seqlock* lock,uint32 sequence)
+{
+    /*数据读取不能被推迟到再次读取序号之后*/
+    atomic_thread_fence(MEMORY_ORDER_ACQUIRE);
+    return atomic_load_explicit(&lock->sequence,MEMORY_ORDER_RELAXED)!=sequence;
+}
+
+/**
+ * 顺序锁开始写入。
+ * 
+ * @param lock 顺序锁。
+ * 
+ * @return 无返回值。
+ */
+void seqlock_write_lock(seqlock* lock)
+{
+    spinlock_lock(&lock->lock);
+    uint32 sequence=atomic_load_explicit(&lock->sequence,MEMORY_ORDER_RELAXED);
+    atomic_store_explicit(&lock->sequence,sequence+1,MEMORY_ORDER_RELAXED);
+    /*序号变为奇数必须先于数据写入可见*/
+    atomic_thread_fence(MEMORY_ORDER_RELEASE);
+}
+
+/**
+ * 顺序锁结束写入。
+ * 
+ * @param lock 顺序锁。
+ * 
+ * @return 无返回值。
+ */
+void seqlock_write_unlock(seqlock* lock)
+{
+    uint32 sequence=atomic_load_explicit(&lock->sequence,MEMORY_ORDER_RELAXED);
+    atomic_store_explicit(&lock->sequence,sequence+1,MEMORY_ORDER_RELEASE);
+    spinlock_unlock(&lock->lock);
 }
\ No newline at end of file
@@ -0,0 +1,432 @@
+/**
+ * 内核内存分配器基准测试主程序。
+ * 在宿主机映射的一段内存上模拟物理内存，直接运行内核的伙伴系统与内存池，
+ * 回放合成或记录的分配轨迹，输出每次操作耗时的分位数、碎片率与常驻内存峰值。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#include <test/bench/bench.h>
+
+#include <init/params.h>
+#include <memory/pool.h>
+#include <support/io.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../memory/memoryi.h"
+
+/**
+ * 模拟物理内存大小。全部位于低区。
+ */
+const static uintn BENCH_MEMORY_SIZE=SIZE_512MB;
+
+/**
+ * 内存池初始区域页数。
+ */
+const static uintn BENCH_POOL_PAGES=64;
+
+/**
+ * 合成轨迹申请次数。
+ */
+const static uintn BENCH_TRACE_ALLOCS=200000;
+
+/**
+ * 被测分配器。申请返回的句柄为0表示失败。
+ */
+typedef struct _bench_allocator
+{
+    const char* name;                              /*分配器名称。*/
+    uintn       unit;                              /*轨迹大小单位的位移，字节为0，页为12。*/
+    uintn       (*alloc)(uint64 size);             /*申请函数。*/
+    void        (*free)(uintn handle,uint64 size); /*释放函数。*/
+    uintn       base_held;                         /*不计入伙伴系统空闲页差值的固定占有字节数。*/
+} bench_allocator;
+
+/**
+ * 槽状态。
+ */
+typedef struct _bench_slot
+{
+    uintn  handle; /*分配句柄。*/
+    uint64 size;   /*申请大小。*/
+} bench_slot;
+
+/**
+ * 时间戳计数器换算到纳秒的分子，即校准期间经过的纳秒数。
+ */
+static uint64 tsc_ns=1;
+
+/**
+ * 时间戳计数器换算到纳秒的分母，即校准期间经过的周期数。
+ */
+static uint64 tsc_cycles=1;
+
+/**
+ * 连续两次读取时间戳计数器的最小间隔，从每次测量中扣除。
+ */
+static uint64 tsc_overhead=0;
+
+/**
+ * 运行开始时伙伴系统的空闲页数。
+ */
+static uintn run_free_pages=0;
+
+/**
+ * 校准时间戳计数器。以宿主机单调时钟为基准测量约20毫秒。
+ * 
+ * @return 无返回值。
+ */
+static void bench_calibrate(void)
+{
+    uint64 start=bench_host_clock();
+    uint64 cycles=x86_read_tsc();
+    uint64 now;
+    do
+    {
+        now=bench_host_clock();
+    }
+    while(now-start<20000000);
+    tsc_cycles=x86_read_tsc()-cycles;
+    tsc_ns=now-start;
+
+    tsc_overhead=UINT64_MAX;
+    for(uintn index=0;index<1000;index++)
+    {
+        uint64 begin=x86_read_tsc();
+        uint64 end=x86_read_tsc();
+        if(end-begin<tsc_overhead)
+        {
+            tsc_overhead=end-begin;
+        }
+    }
+}
+
+/**
+ * 周期数换算为纳秒。
+ * 
+ * @param cycles 周期数。
+ * 
+ * @return 纳秒数。
+ */
+static uint64 bench_to_ns(uint64 cycles)
+{
+    return cycles*tsc_ns/tsc_cycles;
+}
+
+/**
+ * 从内存池申请。
+ * 
+ * @param size 字节数。
+ * 
+ * @return 内存地址。
+ */
+static uintn bench_pool_alloc(uint64 size)
+{
+    return (uintn)pool_alloc(size);
+}
+
+/**
+ * 向内存池释放。
+ * 
+ * @param handle 内存地址。
+ * @param size   字节数。
+ * 
+ * @return 无返回值。
+ */
+static void bench_pool_free(uintn handle,uint64 size)
+{
+    (void)size;
+    pool_free((void*)handle);
+}
+
+/**
+ * 从伙伴系统申请。
+ * 
+ * @param size 页数。
+ * 
+ * @return 物理基址，失败返回0。
+ */
+static uintn bench_buddy_alloc(uint64 size)
+{
+    uintn base=buddy_alloc(size);
+    return base==UINTN_MAX?0:base;
+}
+
+/**
+ * 向伙伴系统释放。
+ * 
+ * @param handle 物理基址。
+ * @param size   页数。
+ * 
+ * @return 无返回值。
+ */
+static void bench_buddy_free(uintn handle,uint64 size)
+{
+    buddy_free(handle,size);
+}
+
+/**
+ * 获取分配器当前占有的字节数。
+ * 
+ * @param allocator 被测分配器。
+ * 
+ * @return 字节数。
+ */
+static uintn bench_held(const bench_allocator* allocator)
+{
+    uintn free_pages=buddy_get_free_pages();
+    return allocator->base_held+(free_pages<run_free_pages?(run_free_pages-free_pages)<<12:0);
+}
+
+/**
+ * 比较两个样本。
+ * 
+ * @param a 样本a。
+ * @param b 样本b。
+ * 
+ * @return 比较结果。
+ */
+static int bench_compare(const void* a,const void* b)
+{
+    uint64 x=*(const uint64*)a;
+    uint64 y=*(const uint64*)b;
+    return x<y?-1:x>y;
+}
+
+/**
+ * 按千分比输出比值。
+ * 
+ * @param numerator   分子。
+ * @param denominator 分母。
+ * 
+ * @return 比值的千倍。
+ */
+static uint64 bench_ratio(uint64 numerator,uint64 denominator)
+{
+    return denominator==0?0:numerator*1000/denominator;
+}
+
+/**
+ * 在给定分配器上回放一条轨迹并输出结果。
+ * 
+ * @param allocator 被测分配器。
+ * @param trace     分配轨迹。
+ * 
+ * @return 无返回值。
+ */
+static void bench_run(const bench_allocator* allocator,const bench_trace* trace)
+{
+    bench_slot* slots=(bench_slot*)calloc(trace->slots,sizeof(bench_slot));
+    uint64* samples=(uint64*)malloc(trace->count*sizeof(uint64));
+    if(slots==NULL||samples==NULL)
+    {
+        printf("[aos.kernel.bench.memory] %s %s: out of host memory.\n",allocator->name,trace->name);
+        free(slots);
+        free(samples);
+        return;
+    }
+
+    run_free_pages=buddy_get_free_pages();
+    uintn measured=0;
+    uintn failures=0;
+    uint64 total=0;
+    uint64 live=0;
+    uint64 peak_live=0;
+    uintn peak_held=0;
+    for(uintn index=0;index<trace->count;index++)
+    {
+        const bench_op* op=&trace->ops[index];
+        bench_slot* slot=&slots[op->slot];
+        bench_host_set_cpu(op->cpu);
+        if(op->kind==BENCH_OP_ALLOC)
+        {
+            if(slot->handle!=0)
+            {
+                continue;
+            }
+            uint64 begin=x86_read_tsc();
+            uintn handle=allocator->alloc(op->size);
+            uint64 end=x86_read_tsc();
+            if(handle==0)
+            {
+                failures++;
+                continue;
+            }
+            slot->handle=handle;
+            slot->size=op->size;
+            samples[measured++]=end-begin;
+
+            /*碎片率取活跃量峰值时刻的占有量与活跃量之比*/
+            live+=op->size<<allocator->unit;
+            if(live>peak_live)
+            {
+                peak_live=live;
+                peak_held=bench_held(allocator);
+            }
+        }
+        else
+        {
+            if(slot->handle==0)
+            {
+                continue;
+            }
+            uint64 begin=x86_read_tsc();
+            allocator->free(slot->handle,slot->size);
+            uint64 end=x86_read_tsc();
+            samples[measured++]=end-begin;
+            live-=slot->size<<allocator->unit;
+            slot->handle=0;
+        }
+    }
+
+    /*轨迹可能未释放全部对象，补齐后再回收，留存量反映回收效果*/
+    for(uintn index=0;index<trace->slots;index++)
+    {
+        if(slots[index].handle!=0)
+        {
+            bench_host_set_cpu(0);
+            allocator->free(slots[index].handle,slots[index].size);
+        }
+    }
+    bench_host_set_cpu(0);
+    pool_trim();
+    uintn residual=bench_held(allocator);
+
+    for(uintn index=0;index<measured;index++)
+    {
+        samples[index]=samples[index]>tsc_overhead?samples[index]-tsc_overhead:0;
+        total+=samples[index];
+    }
+    qsort(samples,measured,sizeof(uint64),bench_compare);
+
+    printf("[aos.kernel.bench.memory] %s %s: %llu ops, %llu failed.\n",allocator->name,trace->name,
+        (unsigned long long)measured,(unsigned long long)failures);
+    if(measured!=0)
+    {
+        printf("[aos.kernel.bench.memory]   ns/op mean %llu, p50 %llu, p90 %llu, p99 %llu, p99.9 %llu, max %llu.\n",
+            (unsigned long long)bench_to_ns(total/measured),
+            (unsigned long long)bench_to_ns(samples[measured*50/100]),
+            (unsigned long long)bench_to_ns(samples[measured*90/100]),
+            (unsigned long long)bench_to_ns(samples[measured*99/100]),
+            (unsigned long long)bench_to_ns(samples[measured*999/1000]),
+            (unsigned long long)bench_to_ns(samples[measured-1]));
+    }
+    uint64 ratio=bench_ratio(peak_held,peak_live);
+    printf("[aos.kernel.bench.memory]   fragmentation %llu.%03llu (%llu KB held at peak live %llu KB), "
+        "%llu KB held after trim.\n",(unsigned long long)(ratio/1000),(unsigned long long)(ratio%1000),
+        (unsigned long long)(peak_held>>10),(unsigned long long)(peak_live>>10),
+        (unsigned long long)(residual>>10));
+    printf("[aos.kernel.bench.memory]   peak RSS %llu KB.\n",(unsigned long long)(bench_host_peak_rss()>>10));
+
+    free(slots);
+    free(samples);
+}
+
+/**
+ * 建立模拟物理内存并初始化伙伴系统与内存池。
+ * 
+ * @return 成功初始化返回真。
+ */
+static bool bench_memory_init(void)
+{
+    uintn frames=BENCH_MEMORY_SIZE>>12;
+    void* memory=bench_host_map(BENCH_MEMORY_SIZE);
+    void* descriptors=bench_host_map(frames*sizeof(page_frame));
+    if(memory==NULL||descriptors==NULL)
+    {
+        return false;
+    }
+    memory_host_map_base=(uintn)memory;
+
+    static aos_efi_memory_descriptor map;
+    map.type=7; /*EFI未分配内存。*/
+    map.pstart=0;
+    map.vstart=0;
+    map.pages=frames;
+    map.attr=0;
+
+    static aos_boot_params params;
+    params.minfo.memory_map=&map;
+    params.minfo.map_length=sizeof(map);
+    params.minfo.map_entry_size=sizeof(map);
+    params.minfo.frames=frames;
+    params.kinfo.fbase=(uintn)descriptors;
+    if(!memory_buddy_init(&params))
+    {
+        return false;
+    }
+
+    bench_host_set_cpu(0);
+    uintn pool=buddy_alloc(BENCH_POOL_PAGES);
+    if(pool==UINTN_MAX||!memory_pool_init(memory_phys_to_virt(pool),BENCH_POOL_PAGES))
+    {
+        return false;
+    }
+    memory_pool_attach_page_allocator();
+    return true;
+}
+
+/**
+ * 基准测试主函数。参数为记录的轨迹文件，在内存池上回放，大小单位为字节。
+ * 
+ * @param argc 参数数目。
+ * @param argv 参数数组。
+ * 
+ * @return 成功返回0。
+ */
+int main(int argc,char** argv)
+{
+    if(!bench_memory_init())
+    {
+        printf("[aos.kernel.bench.memory] Failed to set up the simulated memory.\n");
+        return 1;
+    }
+    bench_calibrate();
+
+    const bench_allocator pool={"pool",0,bench_pool_alloc,bench_pool_free,BENCH_POOL_PAGES<<12};
+    const bench_allocator buddy={"buddy",12,bench_buddy_alloc,bench_buddy_free,0};
+    bench_trace trace;
+
+    if(bench_trace_uniform(&trace,BENCH_TRACE_ALLOCS,4096,16,4096,1))
+    {
+        bench_run(&pool,&trace);
+        bench_trace_release(&trace);
+    }
+    if(bench_trace_power_law(&trace,BENCH_TRACE_ALLOCS,4096,16,SIZE_64KB,2))
+    {
+        bench_run(&pool,&trace);
+        bench_trace_release(&trace);
+    }
+    if(bench_trace_producer_consumer(&trace,BENCH_TRACE_ALLOCS,256,32,512,3))
+    {
+        bench_run(&pool,&trace);
+        bench_trace_release(&trace);
+    }
+    if(bench_trace_uniform(&trace,BENCH_TRACE_ALLOCS,512,1,64,4))
+    {
+        bench_run(&buddy,&trace);
+        bench_trace_release(&trace);
+    }
+    if(bench_trace_power_law(&trace,BENCH_TRACE_ALLOCS,512,1,512,5))
+    {
+        bench_run(&buddy,&trace);
+        bench_trace_release(&trace);
+    }
+
+    for(int index=1;index<argc;index++)
+    {
+        if(bench_trace_load(&trace,argv[index]))
+        {
+            bench_run(&pool,&trace);
+            bench_trace_release(&trace);
+        }
+        else
+        {
+            printf("[aos.kernel.bench.memory] Failed to load trace %s.\n",argv[index]);
+        }
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,133 @@
+/**
+ * 内核内存分配器基准测试宿主机接口。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#include <test/bench/bench.h>
+
+#include <cpu/info.h>
+
+#ifdef _WIN32
+#define PSAPI_VERSION 2
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <time.h>
+#endif
+
+/**
+ * 模拟物理内存的映射基址。内存模块经它完成物理地址与线性地址的转换。
+ */
+uintn memory_host_map_base=0;
+
+/**
+ * 模拟的当前CPU编号。
+ */
+static uint32 bench_cpu=0;
+
+/**
+ * 向宿主机申请一段按页对齐、零初始化的内存，页面在首次访问时才真正提交。
+ * 
+ * @param size 内存大小。
+ * 
+ * @return 成功申请返回基址，失败返回空指针。
+ */
+void* bench_host_map(uintn size)
+{
+#ifdef _WIN32
+    return VirtualAlloc(NULL,size,MEM_RESERVE|MEM_COMMIT,PAGE_READWRITE);
+#else
+    void* base=mmap(NULL,size,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE,-1,0);
+    return base==MAP_FAILED?NULL:base;
+#endif
+}
+
+/**
+ * 向宿主机释放一段内存。
+ * 
+ * @param base 内存基址。
+ * @param size 内存大小。
+ * 
+ * @return 无返回值。
+ */
+void bench_host_unmap(void* base,uintn size)
+{
+#ifdef _WIN32
+    (void)size;
+    VirtualFree(base,0,MEM_RELEASE);
+#else
+    munmap(base,size);
+#endif
+}
+
+/**
+ * 获取宿主机单调时钟。
+ * 
+ * @return 纳秒数。
+ */
+uint64 bench_host_clock(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER counter,frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    uint64 seconds=(uint64)counter.QuadPart/(uint64)frequency.QuadPart;
+    uint64 rest=(uint64)counter.QuadPart%(uint64)frequency.QuadPart;
+    return seconds*1000000000ULL+rest*1000000000ULL/(uint64)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC,&now);
+    return (uint64)now.tv_sec*1000000000ULL+(uint64)now.tv_nsec;
+#endif
+}
+
+/**
+ * 获取进程常驻内存峰值。
+ * 
+ * @return 字节数，无法获取返回0。
+ */
+uintn bench_host_peak_rss(void)
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if(!GetProcessMemoryInfo(GetCurrentProcess(),&counters,sizeof(counters)))
+    {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF,&usage)!=0)
+    {
+        return 0;
+    }
+    return (uintn)usage.ru_maxrss*1024;
+#endif
+}
+
+/**
+ * 切换模拟的当前CPU。
+ * 
+ * @param id CPU编号。
+ * 
+ * @return 无返回值。
+ */
+void bench_host_set_cpu(uint32 id)
+{
+    bench_cpu=id;
+}
+
+/**
+ * 获取当前CPU编号。宿主机上返回模拟的CPU编号。
+ * 
+ * @return 当前CPU编号。
+ */
+uint32 get_current_cpu_id(void)
+{
+    return bench_cpu;
+}
\ No newline at end of file
@@ -0,0 +1,389 @@
+/**
+ * 内核内存分配器基准测试轨迹。
+ * @date 2026-10-17
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#include <test/bench/bench.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <support/util.h>
+
+/**
+ * 轨迹生成器状态。
+ */
+typedef struct _bench_generator
+{
+    uint64  state; /*随机数状态。*/
+    uint32* live;  /*活跃槽号数组。*/
+    uintn   used;  /*活跃槽数目。*/
+    uint32* idle;  /*空闲槽号栈。*/
+    uintn   free;  /*空闲槽数目。*/
+} bench_generator;
+
+/**
+ * 生成下一个随机数。使用xorshift64*，结果可复现。
+ * 
+ * @param state 随机数状态。
+ * 
+ * @return 随机数。
+ */
+static uint64 bench_random(uint64* state)
+{
+    uint64 x=*state;
+    x^=x>>12;
+    x^=x<<25;
+    x^=x>>27;
+    *state=x;
+    return x*0x2545F4914F6CDD1DULL;
+}
+
+/**
+ * 初始化轨迹与生成器。
+ * 
+ * @param trace 分配轨迹。
+ * @param gen   生成器。
+ * @param name  轨迹名称。
+ * @param count 申请次数。
+ * @param slots 槽数目。
+ * @param seed  随机种子。
+ * 
+ * @return 成功初始化返回真。
+ */
+static bool bench_generator_init(bench_trace* trace,bench_generator* gen,const char* name,uintn count,
+    uintn slots,uint64 seed)
+{
+    trace->name=name;
+    trace->ops=(bench_op*)calloc(count*2,sizeof(bench_op));
+    trace->count=0;
+    trace->slots=slots;
+    gen->state=seed|1;
+    gen->live=(uint32*)calloc(slots,sizeof(uint32));
+    gen->used=0;
+    gen->idle=(uint32*)calloc(slots,sizeof(uint32));
+    gen->free=slots;
+    if(trace->ops==NULL||gen->live==NULL||gen->idle==NULL)
+    {
+        free(trace->ops);
+        free(gen->live);
+        free(gen->idle);
+        trace->ops=NULL;
+        return false;
+    }
+    for(uintn index=0;index<slots;index++)
+    {
+        gen->idle[index]=(uint32)(slots-1-index);
+    }
+    return true;
+}
+
+/**
+ * 追加一个申请操作。
+ * 
+ * @param trace 分配轨迹。
+ * @param gen   生成器。
+ * @param size  申请大小。
+ * @param cpu   CPU编号。
+ * 
+ * @return 无返回值。
+ */
+static void bench_generator_alloc(bench_trace* trace,bench_generator* gen,uint64 size,uint8 cpu)
+{
+    uint32 slot=gen->idle[--gen->free];
+    gen->live[gen->used++]=slot;
+    bench_op* op=&trace->ops[trace->count++];
+    op->kind=BENCH_OP_ALLOC;
+    op->cpu=cpu;
+    op->slot=slot;
+    op->size=size;
+}
+
+/**
+ * 追加一个释放操作。
+ * 
+ * @param trace 分配轨迹。
+ * @param gen   生成器。
+ * @param index 活跃槽数组下标。
+ * @param cpu   CPU编号。
+ * 
+ * @return 无返回值。
+ */
+static void bench_generator_free(bench_trace* trace,bench_generator* gen,uintn index,uint8 cpu)
+{
+    uint32 slot=gen->live[index];
+    gen->live[index]=gen->live[--gen->used];
+    gen->idle[gen->free++]=slot;
+    bench_op* op=&trace->ops[trace->count++];
+    op->kind=BENCH_OP_FREE;
+    op->cpu=cpu;
+    op->slot=slot;
+    op->size=0;
+}
+
+/**
+ * 结束生成。释放全部活跃对象，使轨迹结束时不留存活对象。
+ * 
+ * @param trace 分配轨迹。
+ * @param gen   生成器。
+ * 
+ * @return 无返回值。
+ */
+static void bench_generator_finish(bench_trace* trace,bench_generator* gen)
+{
+    while(gen->used>0)
+    {
+        bench_generator_free(trace,gen,gen->used-1,0);
+    }
+    free(gen->live);
+    free(gen->idle);
+}
+
+/**
+ * 按给定大小分布生成随机申请释放交错的轨迹。
+ * 
+ * @param trace     分配轨迹。
+ * @param name      轨迹名称。
+ * @param count     申请次数。
+ * @param live      活跃对象上限。
+ * @param min       最小申请大小。
+ * @param max       最大申请大小。
+ * @param seed      随机种子。
+ * @param power_law 为真按幂律分布，否则均匀分布。
+ * 
+ * @return 成功生成返回真。
+ */
+static bool bench_trace_random(bench_trace* trace,const char* name,uintn count,uintn live,uint64 min,
+    uint64 max,uint64 seed,bool power_law)
+{
+    bench_generator gen;
+    if(trace==NULL||count==0||live==0||min==0||min>max||!bench_generator_init(trace,&gen,name,count,live,seed))
+    {
+        return false;
+    }
+
+    uintn classes=0;
+    while(classes<63&&(min<<classes)<=max)
+    {
+        classes++;
+    }
+
+    uintn allocs=0;
+    while(allocs<count)
+    {
+        /*活跃数低于一半时只申请，达到上限时只释放，其间申请释放各半*/
+        uint64 random=bench_random(&gen.state);
+        if(gen.used==live||(gen.used>=live/2&&(random&BIT0)))
+        {
+            bench_generator_free(trace,&gen,(uintn)((random>>1)%gen.used),0);
+            continue;
+        }
+
+        uint64 size;
+        if(power_law)
+        {
+            /*尾随零个数服从几何分布，档位概率随大小减半*/
+            uintn shift=min(count_trailing_zeros(bench_random(&gen.state)),classes-1);
+            uint64 low=min<<shift;
+            size=low+bench_random(&gen.state)%low;
+            if(size>max)
+            {
+                size=max;
+            }
+        }
+        else
+        {
+            size=min+bench_random(&gen.state)%(max-min+1);
+        }
+        bench_generator_alloc(trace,&gen,size,0);
+        allocs++;
+    }
+    bench_generator_finish(trace,&gen);
+    return true;
+}
+
+/**
+ * 生成均匀分布轨迹。活跃对象数在上限附近随机申请释放，大小在区间内均匀分布。
+ * 
+ * @param trace 分配轨迹。
+ * @param count 申请次数。
+ * @param live  活跃对象上限。
+ * @param min   最小申请大小。
+ * @param max   最大申请大小。
+ * @param seed  随机种子。
+ * 
+ * @return 成功生成返回真。
+ */
+bool bench_trace_uniform(bench_trace* trace,uintn count,uintn live,uint64 min,uint64 max,uint64 seed)
+{
+    return bench_trace_random(trace,"uniform",count,live,min,max,seed,false);
+}
+
+/**
+ * 生成幂律分布轨迹。大小按2的幂分档，档位概率随大小减半，档内均匀分布。
+ * 
+ * @param trace 分配轨迹。
+ * @param count 申请次数。
+ * @param live  活跃对象上限。
+ * @param min   最小申请大小。
+ * @param max   最大申请大小。
+ * @param seed  随机种子。
+ * 
+ * @return 成功生成返回真。
+ */
+bool bench_trace_power_law(bench_trace* trace,uintn count,uintn live,uint64 min,uint64 max,uint64 seed)
+{
+    return bench_trace_random(trace,"power-law",count,live,min,max,seed,true);
+}
+
+/**
+ * 生成生产者消费者轨迹。CPU0批量申请，CPU1批量释放，覆盖跨CPU释放路径。
+ * 每轮先申请新一批，再释放上一批，因此同时最多有两批对象存活。
+ * 
+ * @param trace 分配轨迹。
+ * @param count 申请次数。
+ * @param batch 每批对象数。
+ * @param min   最小申请大小。
+ * @param max   最大申请大小。
+ * @param seed  随机种子。
+ * 
+ * @return 成功生成返回真。
+ */
+bool bench_trace_producer_consumer(bench_trace* trace,uintn count,uintn batch,uint64 min,uint64 max,uint64 seed)
+{
+    bench_generator gen;
+    if(trace==NULL||count==0||batch==0||min==0||min>max||
+        !bench_generator_init(trace,&gen,"producer-consumer",count,batch*2,seed))
+    {
+        return false;
+    }
+
+    uintn allocs=0;
+    while(allocs<count)
+    {
+        uintn round=min(batch,count-allocs);
+        uintn previous=gen.used;
+        for(uintn index=0;index<round;index++)
+        {
+            bench_generator_alloc(trace,&gen,min+bench_random(&gen.state)%(max-min+1),0);
+        }
+        allocs+=round;
+
+        /*上一批位于活跃数组前部，从后往前释放时空位只会被新一批填补*/
+        for(uintn index=previous;index>0;index--)
+        {
+            bench_generator_free(trace,&gen,index-1,1);
+        }
+    }
+    while(gen.used>0)
+    {
+        bench_generator_free(trace,&gen,gen.used-1,1);
+    }
+    free(gen.live);
+    free(gen.idle);
+    return true;
+}
+
+/**
+ * 读取记录的轨迹文件。每行一个操作：“a 槽号 大小 [CPU]”或“f 槽号 [CPU]”，以#开头的行为注释。
+ * 
+ * @param trace 分配轨迹。
+ * @param path  文件路径。
+ * 
+ * @return 成功读取返回真。
+ */
+bool bench_trace_load(bench_trace* trace,const char* path)
+{
+    if(trace==NULL||path==NULL)
+    {
+        return false;
+    }
+    FILE* file=fopen(path,"r");
+    if(file==NULL)
+    {
+        return false;
+    }
+
+    uintn capacity=4096;
+    trace->name=path;
+    trace->ops=(bench_op*)malloc(capacity*sizeof(bench_op));
+    trace->count=0;
+    trace->slots=0;
+
+    char line[256];
+    while(trace->ops!=NULL&&fgets(line,sizeof(line),file)!=NULL)
+    {
+        char kind;
+        unsigned long slot;
+        unsigned long long size=0;
+        unsigned cpu=0;
+        int fields=sscanf(line," %c %lu",&kind,&slot);
+        if(fields<2||kind=='#')
+        {
+            continue;
+        }
+        if(kind=='a')
+        {
+            if(sscanf(line," %c %lu %llu %u",&kind,&slot,&size,&cpu)<3||size==0)
+            {
+                continue;
+            }
+        }
+        else if(kind=='f')
+        {
+            sscanf(line," %c %lu %u",&kind,&slot,&cpu);
+        }
+        else
+        {
+            continue;
+        }
+        if(slot>=UINT32_MAX||cpu>UINT8_MAX)
+        {
+            continue;
+        }
+
+        if(trace->count==capacity)
+        {
+            capacity*=2;
+            bench_op* ops=(bench_op*)realloc(trace->ops,capacity*sizeof(bench_op));
+            if(ops==NULL)
+            {
+                free(trace->ops);
+                trace->ops=NULL;
+                break;
+            }
+            trace->ops=ops;
+        }
+        bench_op* op=&trace->ops[trace->count++];
+        op->kind=kind=='a'?BENCH_OP_ALLOC:BENCH_OP_FREE;
+        op->cpu=(uint8)cpu;
+        op->rsvd=0;
+        op->slot=(uint32)slot;
+        op->size=size;
+        if(slot+1>trace->slots)
+        {
+            trace->slots=slot+1;
+        }
+    }
+    fclose(file);
+    return trace->ops!=NULL&&trace->count>0;
+}
+
+/**
+ * 释放轨迹占用的内存。
+ * 
+ * @param trace 分配轨迹。
+ * 
+ * @return 无返回值。
+ */
+void bench_trace_release(bench_trace* trace)
+{
+    if(trace!=NULL)
+    {
+        free(trace->ops);
+        trace->ops=NULL;
+        trace->count=0;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,214 @@
+/**
+ * 内核宿主机测试宿主机接口。
+ * @date 2026-10-18
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#include <test/host/host.h>
+
+#include <cpu/rcu.h>
+#include <memory/slab.h>
+#include <support/atomic.h>
+#include <support/control.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/**
+ * 模拟的对象缓存对象大小。被测模块只创建一个缓存，全部对象直接向宿主机申请。
+ */
+static uintn host_slab_size=0;
+
+/**
+ * 正在运行的线程入口。
+ */
+static host_thread_routine host_routine=NULL;
+
+/**
+ * 起跑屏障需要等待的线程数。
+ */
+static atomic_uint32 host_expected;
+
+/**
+ * 已到达起跑屏障的线程数。
+ */
+static atomic_uint32 host_arrived;
+
+/**
+ * 在起跑屏障等待全部线程到达后运行线程入口。
+ * 
+ * @param index 线程序号。
+ * 
+ * @return 无返回值。
+ */
+static void host_thread_start(uintn index)
+{
+    atomic_fetch_add(&host_arrived,1);
+    while(atomic_load(&host_arrived)<atomic_load(&host_expected))
+    {
+        x86_cpu_pause();
+    }
+    host_routine(index);
+}
+
+/**
+ * 创建对象缓存。
+ * 
+ * @param name  缓存名称。
+ * @param size  对象大小。
+ * @param align 对象对齐。
+ * @param ctor  对象构造函数。
+ * 
+ * @return 缓存。
+ */
+slab_cache* slab_cache_create(const char* name,uintn size,uintn align,slab_constructor ctor)
+{
+    (void)name;
+    (void)align;
+    (void)ctor;
+    host_slab_size=size;
+    return (slab_cache*)&host_slab_size;
+}
+
+/**
+ * 从缓存申请对象。
+ * 
+ * @param cache 缓存。
+ * 
+ * @return 成功申请返回零初始化的对象，失败返回空指针。
+ */
+void* slab_cache_alloc(slab_cache* cache)
+{
+    (void)cache;
+    return calloc(1,host_slab_size);
+}
+
+/**
+ * 向缓存释放对象。
+ * 
+ * @param cache  缓存。
+ * @param object 对象。
+ * 
+ * @return 无返回值。
+ */
+void slab_cache_free(slab_cache* cache,void* object)
+{
+    (void)cache;
+    free(object);
+}
+
+/**
+ * 登记宽限期后执行的回调。测试中写者与无锁读者不并发，直接执行回调。
+ * 
+ * @param head     延迟回调结点。
+ * @param callback 回调函数。
+ * 
+ * @return 无返回值。
+ */
+void call_rcu(rcu_head* head,rcu_callback callback)
+{
+    callback(head);
+}
+
+#ifdef _WIN32
+/**
+ * 线程入口转换。
+ * 
+ * @param param 线程序号。
+ * 
+ * @return 总是返回0。
+ */
+static DWORD WINAPI host_thread_entry(LPVOID param)
+{
+    host_thread_start((uintn)param);
+    return 0;
+}
+#else
+/**
+ * 线程入口转换。
+ * 
+ * @param param 线程序号。
+ * 
+ * @return 总是返回空指针。
+ */
+static void* host_thread_entry(void* param)
+{
+    host_thread_start((uintn)param);
+    return NULL;
+}
+#endif
+
+/**
+ * 启动若干宿主机线程并等待全部结束。
+ * 
+ * @param count   线程数，不超过HOST_THREAD_LIMIT。
+ * @param routine 线程入口，参数为线程序号。
+ * 
+ * @return 全部线程成功启动返回真。
+ */
+bool host_thread_run(uintn count,host_thread_routine routine)
+{
+    uintn started=0;
+    host_routine=routine;
+    atomic_store(&host_arrived,0);
+    atomic_store(&host_expected,(uint32)count);
+#ifdef _WIN32
+    HANDLE threads[HOST_THREAD_LIMIT];
+    while(started<count&&started<HOST_THREAD_LIMIT)
+    {
+        threads[started]=CreateThread(NULL,0,host_thread_entry,(LPVOID)started,0,NULL);
+        if(threads[started]==NULL)
+        {
+            break;
+        }
+        started++;
+    }
+    /*有线程未能启动时放开屏障，避免已启动的线程永远等待*/
+    atomic_store(&host_expected,(uint32)started);
+    for(uintn index=0;index<started;index++)
+    {
+        WaitForSingleObject(threads[index],INFINITE);
+        CloseHandle(threads[index]);
+    }
+#else
+    pthread_t threads[HOST_THREAD_LIMIT];
+    while(started<count&&started<HOST_THREAD_LIMIT)
+    {
+        if(pthread_create(&threads[started],NULL,host_thread_entry,(void*)started)!=0)
+        {
+            break;
+        }
+        started++;
+    }
+    atomic_store(&host_expected,(uint32)started);
+    for(uintn index=0;index<started;index++)
+    {
+        pthread_join(threads[index],NULL);
+    }
+#endif
+    return started==count;
+}
+
+/**
+ * 获取宿主机在线处理器数。
+ * 
+ * @return 处理器数，至少为1。
+ */
+uintn host_cpu_count(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors==0?1:info.dwNumberOfProcessors;
+#else
+    long count=sysconf(_SC_NPROCESSORS_ONLN);
+    return count<1?1:(uintn)count;
+#endif
+}
\ No newline at end of file
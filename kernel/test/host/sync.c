@@ -0,0 +1,382 @@
+/**
+ * 内核同步原语测试。
+ * @date 2026-10-18
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#include <test/host/test.h>
+
+#include <support/control.h>
+#include <support/sync.h>
+#include <support/util.h>
+
+/**
+ * 竞争线程数上限。实际线程数不超过宿主机处理器数。
+ */
+#define SYNC_TEST_THREADS 4
+
+/**
+ * 每个线程的加锁轮数。
+ */
+#define SYNC_TEST_ROUNDS 20000
+
+/**
+ * 临界区内读改写之间的停顿次数，拉长竞争窗口。
+ */
+#define SYNC_TEST_DELAY 8
+
+/**
+ * 实际竞争线程数。
+ */
+static uintn threads=0;
+
+/**
+ * 自旋锁。
+ */
+static spinlock test_spinlock;
+
+/**
+ * MCS队列锁。
+ */
+static mcs_lock test_mcs_lock;
+
+/**
+ * 读写锁。
+ */
+static rwlock test_rwlock;
+
+/**
+ * 顺序锁。
+ */
+static seqlock test_seqlock;
+
+/**
+ * 顺序锁保护的数据对。写者保持后者为前者的两倍，读者读到不一致的一对说明重试检查失效。
+ */
+static volatile uintn pair[2];
+
+/**
+ * 受保护的计数器。以非原子读改写累加，缺少互斥时会丢失更新。
+ */
+static volatile uintn counter=0;
+
+/**
+ * 临界区内的写者数。
+ */
+static atomic_uint32 writers;
+
+/**
+ * 临界区内的读者数。
+ */
+static atomic_uint32 readers;
+
+/**
+ * 观察到互斥被破坏的次数。
+ */
+static atomic_uint32 violations;
+
+/**
+ * 重置共享状态。
+ * 
+ * @return 无返回值。
+ */
+static void sync_test_reset(void)
+{
+    threads=min((uintn)SYNC_TEST_THREADS,host_cpu_count());
+    counter=0;
+    atomic_store(&writers,0);
+    atomic_store(&readers,0);
+    atomic_store(&violations,0);
+    pair[0]=0;
+    pair[1]=0;
+}
+
+/**
+ * 独占临界区。进入时检查没有其他持有者，再以非原子读改写累加计数器。
+ * 
+ * @return 无返回值。
+ */
+static void sync_test_exclusive(void)
+{
+    if(atomic_fetch_add(&writers,1)!=0||atomic_load(&readers)!=0)
+    {
+        atomic_fetch_add(&violations,1);
+    }
+    uintn value=counter;
+    for(uintn count=0;count<SYNC_TEST_DELAY;count++)
+    {
+        x86_cpu_pause();
+    }
+    counter=value+1;
+    atomic_fetch_sub(&writers,1);
+}
+
+/**
+ * 共享临界区。进入时检查没有写者，两次读取的计数器应当相同。
+ * 
+ * @return 无返回值。
+ */
+static void sync_test_shared(void)
+{
+    atomic_fetch_add(&readers,1);
+    if(atomic_load(&writers)!=0)
+    {
+        atomic_fetch_add(&violations,1);
+    }
+    uintn value=counter;
+    for(uintn count=0;count<SYNC_TEST_DELAY;count++)
+    {
+        x86_cpu_pause();
+    }
+    if(counter!=value)
+    {
+        atomic_fetch_add(&violations,1);
+    }
+    atomic_fetch_sub(&readers,1);
+}
+
+/**
+ * 自旋锁竞争线程。每隔几轮改用尝试加锁。
+ * 
+ * @param index 线程序号。
+ * 
+ * @return 无返回值。
+ */
+static void sync_test_spinlock_thread(uintn index)
+{
+    for(uintn round=0;round<SYNC_TEST_ROUNDS;round++)
+    {
+        if((round+index)%4==0)
+        {
+            while(!spinlock_try_lock(&test_spinlock))
+            {
+                x86_cpu_pause();
+            }
+        }
+        else
+        {
+            spinlock_lock(&test_spinlock);
+        }
+        sync_test_exclusive();
+        spinlock_unlock(&test_spinlock);
+    }
+}
+
+/**
+ * MCS队列锁竞争线程。结点放在线程栈上，每隔几轮改用尝试加锁。
+ * 
+ * @param index 线程序号。
+ * 
+ * @return 无返回值。
+ */
+static void sync_test_mcs_thread(uintn index)
+{
+    mcs_node node;
+    for(uintn round=0;round<SYNC_TEST_ROUNDS;round++)
+    {
+        if((round+index)%4==0)
+        {
+            while(!mcs_lock_try_lock(&test_mcs_lock,&node))
+            {
+                x86_cpu_pause();
+            }
+        }
+        else
+        {
+            mcs_lock_lock(&test_mcs_lock,&node);
+        }
+        sync_test_exclusive();
+        mcs_lock_unlock(&test_mcs_lock,&node);
+    }
+}
+
+/**
+ * 读写锁竞争线程。前一半线程为写者，后一半为读者。
+ * 
+ * @param index 线程序号。
+ * 
+ * @return 无返回值。
+ */
+static void sync_test_rwlock_thread(uintn index)
+{
+    bool writer=index<threads/2;
+    for(uintn round=0;round<SYNC_TEST_ROUNDS;round++)
+    {
+        bool try=(round+index)%4==0;
+        if(writer)
+        {
+            if(try)
+            {
+                while(!rwlock_write_try_lock(&test_rwlock))
+                {
+                    x86_cpu_pause();
+                }
+            }
+            else
+            {
+                rwlock_write_lock(&test_rwlock);
+            }
+            sync_test_exclusive();
+            rwlock_write_unlock(&test_rwlock);
+        }
+        else
+        {
+            if(try)
+            {
+                while(!rwlock_read_try_lock(&test_rwlock))
+                {
+                    x86_cpu_pause();
+                }
+            }
+            else
+            {
+                rwlock_read_lock(&test_rwlock);
+            }
+            sync_test_shared();
+            rwlock_read_unlock(&test_rwlock);
+        }
+    }
+}
+
+/**
+ * 顺序锁竞争线程。前一半线程为写者，后一半为读者，读者只使用检查通过的读取结果。
+ * 
+ * @param index 线程序号。
+ * 
+ * @return 无返回值。
+ */
+static void sync_test_seqlock_thread(uintn index)
+{
+    for(uintn round=0;round<SYNC_TEST_ROUNDS;round++)
+    {
+        if(index<threads/2)
+        {
+            seqlock_write_lock(&test_seqlock);
+            sync_test_exclusive();
+            uintn value=pair[0]+1;
+            pair[0]=value;
+            for(uintn count=0;count<SYNC_TEST_DELAY;count++)
+            {
+                x86_cpu_pause();
+            }
+            pair[1]=value*2;
+            seqlock_write_unlock(&test_seqlock);
+        }
+        else
+        {
+            uintn first,second;
+            uint32 sequence;
+            do
+            {
+                sequence=seqlock_read_begin(&test_seqlock);
+                first=pair[0];
+                for(uintn count=0;count<SYNC_TEST_DELAY;count++)
+                {
+                    x86_cpu_pause();
+                }
+                second=pair[1];
+            }
+            while(seqlock_read_retry(&test_seqlock,sequence));
+            if(second!=first*2)
+            {
+                atomic_fetch_add(&violations,1);
+            }
+        }
+    }
+}
+
+/**
+ * 测试自旋锁在竞争下的互斥。
+ * 
+ * @return 无返回值。
+ */
+UTEST_CASE(spinlock_contention)
+{
+    sync_test_reset();
+    spinlock_init(&test_spinlock);
+    UTEST_ASSERT_TRUE(host_thread_run(threads,sync_test_spinlock_thread));
+    UTEST_ASSERT_EQUAL(counter,threads*SYNC_TEST_ROUNDS);
+    UTEST_ASSERT_EQUAL(atomic_load(&violations),0);
+
+    /*全部解锁后应能立即再次加锁*/
+    UTEST_ASSERT_TRUE(spinlock_try_lock(&test_spinlock));
+    UTEST_ASSERT_FALSE(spinlock_try_lock(&test_spinlock));
+    spinlock_unlock(&test_spinlock);
+}
+
+/**
+ * 测试MCS队列锁在竞争下的互斥。
+ * 
+ * @return 无返回值。
+ */
+UTEST_CASE(mcs_lock_contention)
+{
+    sync_test_reset();
+    mcs_lock_init(&test_mcs_lock);
+    UTEST_ASSERT_TRUE(host_thread_run(threads,sync_test_mcs_thread));
+    UTEST_ASSERT_EQUAL(counter,threads*SYNC_TEST_ROUNDS);
+    UTEST_ASSERT_EQUAL(atomic_load(&violations),0);
+
+    mcs_node node,other;
+    UTEST_ASSERT_TRUE(mcs_lock_try_lock(&test_mcs_lock,&node));
+    UTEST_ASSERT_FALSE(mcs_lock_try_lock(&test_mcs_lock,&other));
+    mcs_lock_unlock(&test_mcs_lock,&node);
+}
+
+/**
+ * 测试读写锁在竞争下写者独占、读者不与写者并存。
+ * 
+ * @return 无返回值。
+ */
+UTEST_CASE(rwlock_contention)
+{
+    sync_test_reset();
+    rwlock_init(&test_rwlock);
+    UTEST_ASSERT_TRUE(host_thread_run(threads,sync_test_rwlock_thread));
+    UTEST_ASSERT_EQUAL(counter,threads/2*SYNC_TEST_ROUNDS);
+    UTEST_ASSERT_EQUAL(atomic_load(&violations),0);
+
+    /*读者可以共存，写者与读者互斥*/
+    UTEST_ASSERT_TRUE(rwlock_read_try_lock(&test_rwlock));
+    UTEST_ASSERT_TRUE(rwlock_read_try_lock(&test_rwlock));
+    UTEST_ASSERT_FALSE(rwlock_write_try_lock(&test_rwlock));
+    rwlock_read_unlock(&test_rwlock);
+    rwlock_read_unlock(&test_rwlock);
+    UTEST_ASSERT_TRUE(rwlock_write_try_lock(&test_rwlock));
+    UTEST_ASSERT_FALSE(rwlock_read_try_lock(&test_rwlock));
+    rwlock_write_unlock(&test_rwlock);
+}
+
+/**
+ * 测试顺序锁在竞争下写者互斥、读者只接受一致的读取结果。
+ * 
+ * @return 无返回值。
+ */
+UTEST_CASE(seqlock_contention)
+{
+    sync_test_reset();
+    seqlock_init(&test_seqlock);
+    UTEST_ASSERT_TRUE(host_thread_run(threads,sync_test_seqlock_thread));
+    UTEST_ASSERT_EQUAL(counter,threads/2*SYNC_TEST_ROUNDS);
+    UTEST_ASSERT_EQUAL(pair[0],threads/2*SYNC_TEST_ROUNDS);
+    UTEST_ASSERT_EQUAL(atomic_load(&violations),0);
+}
+
+/**
+ * 同步原语测试。
+ * 
+ * @return 失败测试数。
+ */
+int32 sync_test(void)
+{
+    UTEST_SUITE("aos.kernel.test.host.sync");
+
+    UTEST_RUN(spinlock_contention);
+    UTEST_RUN(mcs_lock_contention);
+    UTEST_RUN(rwlock_contention);
+    UTEST_RUN(seqlock_contention);
+
+    UTEST_SUMMARY("aos.kernel.test.host.sync");
+}
\ No newline at end of file
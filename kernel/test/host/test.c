@@ -0,0 +1,44 @@
+/**
+ * 内核宿主机测试主程序。
+ * @date 2026-10-18
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#include <test/host/test.h>
+
+/**
+ * 测试线性区域管理。
+ * 
+ * @return 无返回值。
+ */
+UTEST_CASE(vma_test)
+{
+    UTEST_ASSERT_EQUAL(vma_test(),0);
+}
+
+/**
+ * 测试同步原语。
+ * 
+ * @return 无返回值。
+ */
+UTEST_CASE(sync_test)
+{
+    UTEST_ASSERT_EQUAL(sync_test(),0);
+}
+
+/**
+ * 主测试。
+ * 
+ * @return 失败测试数。
+ */
+int32 main(void)
+{
+    UTEST_SUITE("aos.kernel.test.host");
+    
+    UTEST_RUN(vma_test);
+    UTEST_RUN(sync_test);
+
+    UTEST_END("aos.kernel.test.host");
+}
\ No newline at end of file
@@ -0,0 +1,598 @@
+/**
+ * 内核线性区域管理测试。
+ * @date 2026-10-18
+ * 
+ * Copyright (c) 2026 Tony Chen Smith
+ * 
+ * SPDX-License-Identifier: MIT
+ */
+#include <test/host/test.h>
+
+#include <init/params.h>
+#include <memory/vma.h>
+#include <support/memory.h>
+#include <support/util.h>
+
+#include "../../memory/memoryi.h"
+
+/**
+ * 四级分页下非规范地址空洞的起始地址，初始化时登记为保留区域。
+ */
+#define VMA_TEST_HOLE_START __UINT64_C(0x800000000000)
+
+/**
+ * 四级分页下非规范地址空洞的结束地址。
+ */
+#define VMA_TEST_HOLE_END __UINT64_C(0xFFFF800000000000)
+
+/**
+ * 管理范围上界。
+ */
+#define VMA_TEST_HIGH (0-(uintn)SIZE_4KB)
+
+/**
+ * 随机测试使用的页号范围。范围较小，区域之间频繁相邻与重叠。
+ */
+#define VMA_TEST_PAGES 4096
+
+/**
+ * 参照模型的区域数上限。
+ */
+#define VMA_TEST_LIMIT 1024
+
+/**
+ * 参照模型区域。
+ */
+typedef struct _vma_test_range
+{
+    uintn start; /*起始地址。*/
+    uintn end;   /*结束地址。*/
+} vma_test_range;
+
+/**
+ * 树遍历检查状态。
+ */
+typedef struct _vma_test_walk
+{
+    uintn prev_end; /*前一区域结束地址。*/
+    uintn count;    /*区域数。*/
+    bool  valid;    /*满足全部性质。*/
+} vma_test_walk;
+
+/**
+ * 参照模型，按起始地址排序。
+ */
+static vma_test_range model[VMA_TEST_LIMIT];
+
+/**
+ * 参照模型区域数。
+ */
+static uintn model_count=0;
+
+/**
+ * 随机数状态。
+ */
+static uint64 vma_test_seed=0;
+
+/**
+ * 生成伪随机数。
+ * 
+ * @param bound 上界，不包含在范围内。
+ * 
+ * @return 随机数。
+ */
+static uintn vma_test_random(uintn bound)
+{
+    vma_test_seed^=vma_test_seed<<13;
+    vma_test_seed^=vma_test_seed>>7;
+    vma_test_seed^=vma_test_seed<<17;
+    return (uintn)(vma_test_seed%bound);
+}
+
+/**
+ * 重新初始化线性区域管理与参照模型，只留下非规范地址空洞。上一个用例留下的区域先全部移除释放。
+ * 
+ * @return 初始化成功返回真。
+ */
+static bool vma_test_reset(void)
+{
+    for(uintn index=0;index<model_count;index++)
+    {
+        vma_remove(model[index].start);
+    }
+    aos_boot_params params;
+    memory_zero(&params,sizeof(params));
+    model_count=1;
+    model[0].start=VMA_TEST_HOLE_START;
+    model[0].end=VMA_TEST_HOLE_END;
+    vma_test_seed=__UINT64_C(0x9E3779B97F4A7C15);
+    return memory_vma_init(&params);
+}
+
+/**
+ * 由保留区域向上找到红黑树根节点。
+ * 
+ * @return 根节点。
+ */
+static const vma_node* vma_test_root(void)
+{
+    const vma_node* node=vma_find(VMA_TEST_HOLE_START);
+    while(node!=NULL&&node->parent!=NULL)
+    {
+        node=node->parent;
+    }
+    return node;
+}
+
+/**
+ * 中序检查子树的链接、顺序、颜色、空隙与最大空隙。
+ * 
+ * @param node   子树根节点。
+ * @param parent 父节点。
+ * @param walk   遍历状态。
+ * 
+ * @return 子树黑高。
+ */
+static uintn vma_test_check(const vma_node* node,const vma_node* parent,vma_test_walk* walk)
+{
+    if(node==NULL)
+    {
+        return 1;
+    }
+    if(node->parent!=parent||(node->red&&parent!=NULL&&parent->red))
+    {
+        walk->valid=false;
+    }
+    uintn left=vma_test_check(node->left,node,walk);
+    uintn gap=node->start>walk->prev_end?node->start-walk->prev_end:0;
+    if(node->start<walk->prev_end||node->end<=node->start||node->gap!=gap)
+    {
+        walk->valid=false;
+    }
+    walk->prev_end=node->end;
+    walk->count++;
+    uintn right=vma_test_check(node->right,node,walk);
+    uintn max_gap=node->gap;
+    if(node->left!=NULL)
+    {
+        max_gap=max(max_gap,node->left->max_gap);
+    }
+    if(node->right!=NULL)
+    {
+        max_gap=max(max_gap,node->right->max_gap);
+    }
+    if(left!=right||node->max_gap!=max_gap)
+    {
+        walk->valid=false;
+    }
+    return left+(node->red?0:1);
+}
+
+/**
+ * 检查整棵树满足红黑树与空隙性质，且区域数与参照模型一致。
+ * 
+ * @return 满足返回真。
+ */
+static bool vma_test_valid(void)
+{
+    const vma_node* root=vma_test_root();
+    vma_test_walk walk={0,0,true};
+    if(root==NULL||root->red)
+    {
+        return false;
+    }
+    vma_test_check(root,NULL,&walk);
+    return walk.valid&&walk.count==model_count;
+}
+
+/**
+ * 在参照模型中检查范围是否重叠。
+ * 
+ * @param start 起始地址。
+ * @param end   结束地址。
+ * 
+ * @return 重叠返回真。
+ */
+static bool vma_test_model_overlaps(uintn start,uintn end)
+{
+    for(uintn index=0;index<model_count;index++)
+    {
+        if(start<model[index].end&&model[index].start<end)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * 在参照模型中登记区域。
+ * 
+ * @param start 起始地址。
+ * @param end   结束地址。
+ * 
+ * @return 无返回值。
+ */
+static void vma_test_model_insert(uintn start,uintn end)
+{
+    uintn index=model_count++;
+    while(index>0&&model[index-1].start>start)
+    {
+        model[index]=model[index-1];
+        index--;
+    }
+    model[index].start=start;
+    model[index].end=end;
+}
+
+/**
+ * 从参照模型中移除区域。
+ * 
+ * @param index 区域下标。
+ * 
+ * @return 无返回值。
+ */
+static void vma_test_model_remove(uintn index)
+{
+    for(model_count--;index<model_count;index++)
+    {
+        model[index]=model[index+1];
+    }
+}
+
+/**
+ * 在参照模型中按地址顺序查找第一个不小于门限且放得下对齐范围的空隙。
+ * 
+ * @param length 范围长度。
+ * @param align  对齐。
+ * @param low    查找下界。
+ * @param high   查找上界。
+ * @param need   空隙大小门限，最高区域之后的空隙传入0时才检查。
+ * 
+ * @return 成功找到返回起始地址，失败返回0。
+ */
+static uintn vma_test_model_search(uintn length,uintn align,uintn low,uintn high,uintn need)
+{
+    uintn prev_end=0;
+    for(uintn index=0;index<=model_count;index++)
+    {
+        bool tail=index==model_count;
+        uintn gap_end=tail?VMA_TEST_HIGH:model[index].start;
+        uintn start=align_up(max(prev_end,low),align);
+        uintn end=min(gap_end,high);
+        if((tail?need==0:gap_end-prev_end>=need)&&start>=prev_end&&start<=end&&end-start>=length)
+        {
+            return start;
+        }
+        if(!tail)
+        {
+            prev_end=model[index].end;
+        }
+    }
+    return 0;
+}
+
+/**
+ * 逐个空隙线性查找空闲范围，与vma_find_free的参数约定与空隙取舍顺序相同：先查树内不小于长度加对齐余量的空隙，
+ * 再查树内恰好放得下的空隙，最后查最高区域之后的空隙。
+ * 
+ * @param pages 页数。
+ * @param align 对齐。
+ * @param low   范围下界。
+ * @param high  范围上界，不包含在范围内。
+ * 
+ * @return 成功找到返回起始地址，失败返回0。
+ */
+static uintn vma_test_model_find_free(uintn pages,uintn align,uintn low,uintn high)
+{
+    low=max(align_up(low,SIZE_4KB),(uintn)SIZE_4KB);
+    high=min(high,VMA_TEST_HIGH);
+    if(pages==0||low>=high||pages>(high-low)/SIZE_4KB||align>high-low)
+    {
+        return 0;
+    }
+    uintn length=pages*SIZE_4KB;
+    uintn need=length+align-SIZE_4KB<length?UINTN_MAX:length+align-SIZE_4KB;
+    uintn start=vma_test_model_search(length,align,low,high,need);
+    if(start==0)
+    {
+        start=vma_test_model_search(length,align,low,high,length);
+    }
+    if(start==0)
+    {
+        start=vma_test_model_search(length,align,low,high,0);
+    }
+    return start;
+}
+
+/**
+ * 测试初始化后的保留区域与树形状。
+ * 
+ * @return 无返回值。
+ */
+UTEST_CASE(vma_init_basic)
+{
+    UTEST_ASSERT_TRUE(vma_test_reset());
+    UTEST_ASSERT_TRUE(vma_test_valid());
+
+    const vma_node* hole=vma_find(VMA_TEST_HOLE_END-SIZE_4KB);
+    UTEST_ASSERT_NOT_NULL(hole);
+    UTEST_ASSERT_EQUAL(hole->start,VMA_TEST_HOLE_START);
+    UTEST_ASSERT_EQUAL(hole->end,VMA_TEST_HOLE_END);
+    UTEST_ASSERT_EQUAL(hole->flags&VMA_TYPE_MASK,VMA_TYPE_RESERVED);
+    UTEST_ASSERT_EQUAL(hole->gap,VMA_TEST_HOLE_START);
+    UTEST_ASSERT_NULL(vma_find(VMA_TEST_HOLE_START-SIZE_4KB));
+    UTEST_ASSERT_NULL(vma_find(VMA_TEST_HOLE_END));
+}
+
+/**
+ * 测试重叠检查与非法范围。
+ * 
+ * @return 无返回值。
+ */
+UTEST_CASE(vma_insert_overlap)
+{
+    UTEST_ASSERT_TRUE(vma_test_reset());
+    UTEST_ASSERT_NOT_NULL(vma_insert(0x10000,4,VMA_TYPE_MEMORY));
+
+    UTEST_ASSERT_NULL(vma_insert(0x10000,1,VMA_TYPE_MEMORY));
+    UTEST_ASSERT_NULL(vma_insert(0xF000,2,VMA_TYPE_MEMORY));
+    UTEST_ASSERT_NULL(vma_insert(0x13000,1,VMA_TYPE_MEMORY));
+    UTEST_ASSERT_NULL(vma_insert(0x8000,16,VMA_TYPE_MEMORY));
+    UTEST_ASSERT_NULL(vma_insert(0x10800,1,VMA_TYPE_MEMORY));
+    UTEST_ASSERT_NULL(vma_insert(0x20000,0,VMA_TYPE_MEMORY));
+    UTEST_ASSERT_NULL(vma_insert(VMA_TEST_HOLE_START-SIZE_4KB,2,VMA_TYPE_MEMORY));
+
+    /*首尾相接不算重叠*/
+    UTEST_ASSERT_NOT_NULL(vma_insert(0xF000,1,VMA_TYPE_MEMORY));
+    UTEST_ASSERT_NOT_NULL(vma_insert(0x14000,1,VMA_TYPE_MEMORY));
+    UTEST_ASSERT_TRUE(vma_overlaps(0x13000,1));
+    UTEST_ASSERT_FALSE(vma_overlaps(0x15000,1));
+    UTEST_ASSERT_FALSE(vma_overlaps(0x1000,14));
+    UTEST_ASSERT_TRUE(vma_overlaps(0x1000,15));
+    UTEST_ASSERT_TRUE(vma_overlaps(0x1000,0));
+
+    /*管理范围的两端*/
+    UTEST_ASSERT_NOT_NULL(vma_insert(0,1,VMA_TYPE_MEMORY));
+    UTEST_ASSERT_NOT_NULL(vma_insert(VMA_TEST_HIGH-SIZE_4KB,1,VMA_TYPE_MEMORY));
+    UTEST_ASSERT_NULL(vma_insert(VMA_TEST_HIGH,1,VMA_TYPE_MEMORY));
+    UTEST_ASSERT_TRUE(vma_overlaps(VMA_TEST_HIGH,1));
+
+    const vma_node* node=vma_find(0x12FFF);
+    UTEST_ASSERT_NOT_NULL(node);
+    UTEST_ASSERT_EQUAL(node->start,0x10000);
+    UTEST_ASSERT_EQUAL(node->end,0x14000);
+    UTEST_ASSERT_FALSE(vma_remove(0x11000));
+    UTEST_ASSERT_TRUE(vma_remove(0x10000));
+    UTEST_ASSERT_FALSE(vma_remove(0x10000));
+    UTEST_ASSERT_NULL(vma_find(0x12FFF));
+}
+
+/**
+ * 测试顺序插入与移除引起的旋转中空隙的传播。
+ * 
+ * @return 无返回值。
+ */
+UTEST_CASE(vma_rotation_gap)
+{
+    UTEST_ASSERT_TRUE(vma_test_reset());
+
+    /*升序插入每次都在最右路径上旋转，空隙逐个增大使最大空隙随旋转换位*/
+    bool valid=true;
+    uintn start=SIZE_4KB;
+    for(uintn index=1;index<=256;index++)
+    {
+        valid&=vma_insert(start,1,VMA_TYPE_MEMORY)!=NULL;
+        vma_test_model_insert(start,start+SIZE_4KB);
+        valid&=vma_test_valid();
+        start+=SIZE_4KB+index*SIZE_4KB;
+    }
+    UTEST_ASSERT_TRUE(valid);
+    UTEST_ASSERT_EQUAL(vma_test_root()->max_gap,VMA_TEST_HOLE_START-model[model_count-2].end);
+
+    /*移除最高的小区域后空洞之前的空隙扩大，需从叶侧一路传播到根节点*/
+    uintn last=model[model_count-2].start;
+    UTEST_ASSERT_TRUE(vma_remove(last));
+    vma_test_model_remove(model_count-2);
+    UTEST_ASSERT_TRUE(vma_test_valid());
+    UTEST_ASSERT_EQUAL(vma_test_root()->max_gap,VMA_TEST_HOLE_START-model[model_count-2].end);
+
+    /*降序插入并交错移除，覆盖左旋与右旋以及后继接替*/
+    start=VMA_TEST_HOLE_END+SIZE_1MB*512;
+    for(uintn index=0;index<256;index++)
+    {
+        valid&=vma_insert(start,2,VMA_TYPE_MEMORY)!=NULL;
+        vma_test_model_insert(start,start+2*SIZE_4KB);
+        valid&=vma_test_valid();
+        start-=SIZE_1MB;
+    }
+    while(model_count>1)
+    {
+        uintn index=model_count/2;
+        if(model[index].start==VMA_TEST_HOLE_START)
+        {
+            index=index==0?1:index-1;
+        }
+        valid&=vma_remove(model[index].start);
+        vma_test_model_remove(index);
+        valid&=vma_test_valid();
+    }
+    UTEST_ASSERT_TRUE(valid);
+    UTEST_ASSERT_EQUAL(vma_test_root()->max_gap,VMA_TEST_HOLE_START);
+}
+
+/**
+ * 测试随机插入与移除后树的性质与参照模型一致。
+ * 
+ * @return 无返回值。
+ */
+UTEST_CASE(vma_random_insert_remove)
+{
+    UTEST_ASSERT_TRUE(vma_test_reset());
+    bool valid=true;
+    for(uintn round=0;round<20000;round++)
+    {
+        if(vma_test_random(3)!=0&&model_count<VMA_TEST_LIMIT)
+        {
+            uintn start=vma_test_random(VMA_TEST_PAGES)*SIZE_4KB;
+            uintn pages=1+vma_test_random(16);
+            bool overlaps=vma_test_model_overlaps(start,start+pages*SIZE_4KB);
+            valid&=vma_overlaps(start,pages)==overlaps;
+            valid&=(vma_insert(start,pages,VMA_TYPE_MEMORY)==NULL)==overlaps;
+            if(!overlaps)
+            {
+                vma_test_model_insert(start,start+pages*SIZE_4KB);
+            }
+        }
+        else if(model_count>1)
+        {
+            uintn index=vma_test_random(model_count);
+            if(model[index].start!=VMA_TEST_HOLE_START)
+            {
+                valid&=vma_remove(model[index].start);
+                vma_test_model_remove(index);
+            }
+        }
+        valid&=vma_test_valid();
+        if(!valid)
+        {
+            break;
+        }
+    }
+    UTEST_ASSERT_TRUE(valid);
+}
+
+/**
+ * 测试树的两端与对齐边界处的空闲范围查找。
+ * 
+ * @return 无返回值。
+ */
+UTEST_CASE(vma_find_free_edge)
+{
+    UTEST_ASSERT_TRUE(vma_test_reset());
+
+    /*地址0表示失败，最低只能从4KB开始*/
+    UTEST_ASSERT_EQUAL(vma_find_free(1,SIZE_4KB,0,UINTN_MAX),SIZE_4KB);
+    UTEST_ASSERT_EQUAL(vma_find_free(1,SIZE_2MB,0,UINTN_MAX),SIZE_2MB);
+    UTEST_ASSERT_EQUAL(vma_find_free(1,SIZE_4KB,1,UINTN_MAX),SIZE_4KB);
+
+    /*最高区域之后的空隙不在树中记录，结束于管理范围上界*/
+    uintn top=(VMA_TEST_HIGH-VMA_TEST_HOLE_END)/SIZE_4KB;
+    UTEST_ASSERT_EQUAL(vma_find_free(1,SIZE_1GB,VMA_TEST_HOLE_START,UINTN_MAX),VMA_TEST_HOLE_END);
+    UTEST_ASSERT_EQUAL(vma_find_free(top,SIZE_4KB,VMA_TEST_HOLE_END,UINTN_MAX),VMA_TEST_HOLE_END);
+    UTEST_ASSERT_EQUAL(vma_find_free(top+1,SIZE_4KB,VMA_TEST_HOLE_END,UINTN_MAX),0);
+    UTEST_ASSERT_EQUAL(vma_find_free(1,SIZE_4KB,VMA_TEST_HIGH-SIZE_4KB,UINTN_MAX),VMA_TEST_HIGH-SIZE_4KB);
+    UTEST_ASSERT_EQUAL(vma_find_free(1,SIZE_4KB,VMA_TEST_HIGH,UINTN_MAX),0);
+
+    /*空洞之前最后一段恰好放下，空洞之后的空隙少一页*/
+    uintn below=VMA_TEST_HOLE_START/SIZE_4KB-1;
+    UTEST_ASSERT_EQUAL(vma_find_free(below,SIZE_4KB,0,UINTN_MAX),SIZE_4KB);
+    UTEST_ASSERT_EQUAL(vma_find_free(below+1,SIZE_4KB,0,UINTN_MAX),0);
+    UTEST_ASSERT_EQUAL(vma_find_free(top,SIZE_4KB,0,UINTN_MAX),SIZE_4KB);
+
+    /*空隙[0x3000,0x12000)恰好放得下15页；按64KB对齐时小于长度加对齐余量，后面有更大的空隙时不被使用*/
+    UTEST_ASSERT_NOT_NULL(vma_insert(0,3,VMA_TYPE_MEMORY));
+    UTEST_ASSERT_NOT_NULL(vma_insert(0x12000,1,VMA_TYPE_MEMORY));
+    UTEST_ASSERT_EQUAL(vma_find_free(15,SIZE_4KB,0,UINTN_MAX),0x3000);
+    UTEST_ASSERT_EQUAL(vma_find_free(16,SIZE_4KB,0,UINTN_MAX),0x13000);
+    UTEST_ASSERT_EQUAL(vma_find_free(2,0x10000,0,UINTN_MAX),0x20000);
+
+    /*空隙[0x13000,0x40000)足够大时取其中第一个对齐地址，放不下时跳到下一个空隙*/
+    UTEST_ASSERT_NOT_NULL(vma_insert(0x40000,1,VMA_TYPE_MEMORY));
+    UTEST_ASSERT_EQUAL(vma_find_free(2,0x10000,0,UINTN_MAX),0x20000);
+    UTEST_ASSERT_EQUAL(vma_find_free(0x1E,0x10000,0,UINTN_MAX),0x20000);
+    UTEST_ASSERT_EQUAL(vma_find_free(0x1F,0x10000,0,UINTN_MAX),0x50000);
+    UTEST_ASSERT_EQUAL(vma_find_free(1,0x10000,0x31000,UINTN_MAX),0x50000);
+    UTEST_ASSERT_EQUAL(vma_find_free(1,0x10000,0x30000,UINTN_MAX),0x30000);
+
+    /*上界截去后面的空隙后，小空隙中恰好对齐的位置仍能找到*/
+    UTEST_ASSERT_EQUAL(vma_find_free(2,0x10000,0,0x13000),0x10000);
+    UTEST_ASSERT_EQUAL(vma_find_free(3,0x10000,0,0x13000),0);
+
+    /*上界不包含在范围内*/
+    UTEST_ASSERT_EQUAL(vma_find_free(2,SIZE_4KB,0x10000,0x12000),0x10000);
+    UTEST_ASSERT_EQUAL(vma_find_free(2,SIZE_4KB,0x10000,0x11FFF),0);
+    UTEST_ASSERT_EQUAL(vma_find_free(1,SIZE_4KB,0x12000,0x13000),0);
+
+    /*非法参数*/
+    UTEST_ASSERT_EQUAL(vma_find_free(0,SIZE_4KB,0,UINTN_MAX),0);
+    UTEST_ASSERT_EQUAL(vma_find_free(1,0x3000,0,UINTN_MAX),0);
+    UTEST_ASSERT_EQUAL(vma_find_free(1,0x800,0,UINTN_MAX),0);
+    UTEST_ASSERT_EQUAL(vma_find_free(1,SIZE_4KB,0x20000,0x20000),0);
+
+    /*树内只剩恰好按1GB对齐的1GB空隙，应先于最高区域之后的空隙被找到*/
+    UTEST_ASSERT_TRUE(vma_test_reset());
+    UTEST_ASSERT_NOT_NULL(vma_insert(SIZE_4KB,SIZE_1GB/SIZE_4KB-1,VMA_TYPE_MEMORY));
+    UTEST_ASSERT_NOT_NULL(vma_insert(SIZE_2GB,(VMA_TEST_HOLE_START-SIZE_2GB)/SIZE_4KB,VMA_TYPE_MEMORY));
+    UTEST_ASSERT_EQUAL(vma_find_free(SIZE_1GB/SIZE_4KB,SIZE_1GB,0,UINTN_MAX),SIZE_1GB);
+    UTEST_ASSERT_EQUAL(vma_find_free(SIZE_1GB/SIZE_4KB,SIZE_1GB,0,VMA_TEST_HOLE_START),SIZE_1GB);
+    UTEST_ASSERT_EQUAL(vma_find_free(SIZE_1GB/SIZE_4KB+1,SIZE_1GB,0,UINTN_MAX),VMA_TEST_HOLE_END);
+    UTEST_ASSERT_EQUAL(vma_find_free(SIZE_1GB/SIZE_4KB,SIZE_1GB,SIZE_1GB+SIZE_4KB,UINTN_MAX),VMA_TEST_HOLE_END);
+    UTEST_ASSERT_TRUE(vma_remove(SIZE_4KB));
+    UTEST_ASSERT_TRUE(vma_remove(SIZE_2GB));
+    model_count=1;
+}
+
+/**
+ * 测试随机树上的空闲范围查找与逐个空隙线性查找一致。
+ * 
+ * @return 无返回值。
+ */
+UTEST_CASE(vma_find_free_random)
+{
+    UTEST_ASSERT_TRUE(vma_test_reset());
+    uintn mismatches=0;
+    for(uintn round=0;round<4000;round++)
+    {
+        uintn start=vma_test_random(VMA_TEST_PAGES)*SIZE_4KB;
+        uintn pages=1+vma_test_random(8);
+        if(model_count<VMA_TEST_LIMIT/2&&!vma_test_model_overlaps(start,start+pages*SIZE_4KB))
+        {
+            vma_insert(start,pages,VMA_TYPE_MEMORY);
+            vma_test_model_insert(start,start+pages*SIZE_4KB);
+        }
+        else if(model_count>1)
+        {
+            uintn index=vma_test_random(model_count);
+            if(model[index].start!=VMA_TEST_HOLE_START)
+            {
+                vma_remove(model[index].start);
+                vma_test_model_remove(index);
+            }
+        }
+
+        /*下界与上界取在窗口内、窗口两端或管理范围两端*/
+        for(uintn query=0;query<8;query++)
+        {
+            uintn length=1+vma_test_random(32);
+            uintn align=SIZE_4KB<<vma_test_random(6);
+            uintn low=vma_test_random(4)==0?0:vma_test_random(VMA_TEST_PAGES*SIZE_4KB);
+            uintn high=vma_test_random(4)==0?UINTN_MAX:low+vma_test_random(VMA_TEST_PAGES*SIZE_4KB);
+            if(vma_find_free(length,align,low,high)!=vma_test_model_find_free(length,align,low,high))
+            {
+                mismatches++;
+            }
+        }
+    }
+    UTEST_ASSERT_TRUE(vma_test_valid());
+    UTEST_ASSERT_EQUAL(mismatches,0);
+}
+
+/**
+ * 线性区域管理测试。
+ * 
+ * @return 失败测试数。
+ */
+int32 vma_test(void)
+{
+    UTEST_SUITE("aos.kernel.test.host.vma");
+
+    UTEST_RUN(vma_init_basic);
+    UTEST_RUN(vma_insert_overlap);
+    UTEST_RUN(vma_rotation_gap);
+    UTEST_RUN(vma_random_insert_remove);
+    UTEST_RUN(vma_find_free_edge);
+    UTEST_RUN(vma_find_free_random);
+
+    UTEST_SUMMARY("aos.kernel.test.host.vma");
+}
\ No newline at end of file
@@ -407,6 +407,57 @@ UTEST_CASE(memory_zero_partial)
     UTEST_ASSERT_EQUAL(buffer[4],5);
 }
 
+/**
+ * 测试非临时存储置零整页。
+ * 
+ * @return 无返回值。
+ */
+UTEST_CASE(memory_zero_nontemporal_page)
+{
+    static uint8 buffer[4096+64];
+    memory_generate_test_data(buffer,sizeof(buffer));
+    uint8* page=(uint8*)(((uintn)buffer+63)&~(uintn)63);
+    
+    void* result=memory_zero_nontemporal(page,4096);
+    
+    UTEST_ASSERT_EQUAL(result,page);
+    uintn nonzero=0;
+    for(uintn index=0;index<4096;index++)
+    {
+        nonzero+=page[index]!=0;
+    }
+    UTEST_ASSERT_EQUAL(nonzero,0);
+    UTEST_ASSERT_NOT_EQUAL(page[4096],0);
+}
+
+/**
+ * 测试非临时存储置零不对齐的首尾。
+ * 
+ * @return 无返回值。
+ */
+UTEST_CASE(memory_zero_nontemporal_unaligned)
+{
+    uint8 buffer[128];
+    for(uintn offset=0;offset<8;offset++)
+    {
+        for(uintn size=0;size<80;size+=7)
+        {
+            memory_set(buffer,0xA5,sizeof(buffer));
+            
+            void* result=memory_zero_nontemporal(buffer+offset,size);
+            
+            UTEST_ASSERT_EQUAL(result,buffer+offset);
+            uintn wrong=0;
+            for(uintn index=0;index<sizeof(buffer);index++)
+            {
+                bool inside=index>=offset&&index<offset+size;
+                wrong+=inside?buffer[index]!=0:buffer[index]!=0xA5;
+            }
+            UTEST_ASSERT_EQUAL(wrong,0);
+        }
+    }
+}
+
 /**
  * 测试边界和大内存操作。
  * 
@@ -498,6 +549,8 @@ int32 memory_test(void)
     UTEST_RUN(memory_zero_basic);
     UTEST_RUN(memory_zero_zero);
     UTEST_RUN(memory_zero_partial);
+    UTEST_RUN(memory_zero_nontemporal_page);
+    UTEST_RUN(memory_zero_nontemporal_unaligned);
 
     UTEST_RUN(memory_large_operations);
     UTEST_RUN(memory_integration);
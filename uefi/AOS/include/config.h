@@ -19,11 +19,6 @@
  */
 #define CONFIG_KERNEL_POOL 64
 
-/**
- * 页表内存池总页数。要求为64的倍数，且显然大于0。
- */
-#define CONFIG_PAGE_TABLE_POOL 128
-
 /**
  * 内核栈使用页数。实际处理时会前后各添加一页作为边界，但是这一步骤由内核重构线性区时进行。
  */
@@ -57,17 +52,6 @@
 #error The macro CONFIG_KERNEL_POOL must be greater than the macro CONFIG_BOOTSTRAP_POOL.
 #endif /*CONFIG_KERNEL_POOL*/
 
-/**
- * CONFIG_PAGE_TABLE_POOL检查。
- */
-#ifndef CONFIG_PAGE_TABLE_POOL
-#error The macro CONFIG_PAGE_TABLE_POOL is undefined.
-#elif CONFIG_PAGE_TABLE_POOL<=64
-#error The macro CONFIG_PAGE_TABLE_POOL must be greater than 64.
-#elif (CONFIG_PAGE_TABLE_POOL%64)!=0
-#error The macro CONFIG_PAGE_TABLE_POOL must be a multiple of 64.
-#endif /*CONFIG_PAGE_TABLE_POOL*/
-
 /**
  * CONFIG_KERNEL_STACK检查。
  */
@@ -88,4 +88,13 @@ VOID EFIAPI dump_pool_info(IN VOID* pool);
  */
 EFI_STATUS EFIAPI get_memory_type(IN UINTN* addrs,IN UINTN length,OUT EFI_MEMORY_TYPE* types);
 
+/**
+ * 获取物理内存上限，即所有内存类描述符中最高的结束地址。设备映射与保留区域不计入。
+ * 
+ * @param limit 物理内存上限。
+ * 
+ * @return 返回调用状态。
+ */
+EFI_STATUS EFIAPI get_memory_limit(OUT UINTN* limit);
+
 #endif /*__AOS_UEFI_MEM_H__*/
\ No newline at end of file
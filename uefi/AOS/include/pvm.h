@@ -26,7 +26,8 @@ VOID EFIAPI dump_bitmap();
 VOID EFIAPI dump_page_table();
 
 /**
- * 添加一个内核线性区。
+ * 添加一个内核线性区。线性区先登记，获取内存映射时按全部线性区一次建立页表。
+ * 页表建立后添加的线性区立即映射，页表只能取自页表池的固定预留，预留不足时返回资源不足。
  * 
  * @param vaddr 线性区域基址。
  * @param paddr 物理区域基址。
@@ -75,6 +75,7 @@ STATIC EFI_STATUS EFIAPI env_set_cpu(IN OUT aos_boot_params* params)
     CPUID_VERSION_INFO_ECX ml1ecx={.Uint32=ecx};
     AsmCpuidEx(CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS,
         CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS_SUB_LEAF_INFO,&eax,&ebx,&ecx,&edx);
+    CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS_EBX ml7ebx={.Uint32=ebx};
     CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS_ECX ml7ecx={.Uint32=ecx};
     AsmCpuid(CPUID_EXTENDED_CPU_SIG, &eax,&ebx,&ecx,&edx);
     CPUID_EXTENDED_CPU_SIG_ECX el1ecx={.Uint32=ecx};
@@ -164,6 +165,15 @@ STATIC EFI_STATUS EFIAPI env_set_cpu(IN OUT aos_boot_params* params)
     {
         params->features.features|=AOS_FEATURES_LA57;
     }
+    if(ml1ecx.Bits.PCID)
+    {
+        /*CR4.PCIDE由内核在接管页表后开启*/
+        params->features.features|=AOS_FEATURES_PCID;
+        if(ml7ebx.Bits.INVPCID)
+        {
+            params->features.features|=AOS_FEATURES_INVPCID;
+        }
+    }
 
     /*设置内存属性*/
     BOOLEAN interrupt=SaveAndDisableInterrupts();
@@ -1003,29 +1013,6 @@ EFI_STATUS EFIAPI env_init(IN OUT aos_boot_params* params)
     params->minfo.fblock_paddr[2]=base;
     params->minfo.fblock_pages[2]=CONFIG_KERNEL_POOL;
 
-    base=SIZE_2GB;
-    status=gBS->AllocatePages(AllocateMaxAddress,EfiLoaderData,CONFIG_PAGE_TABLE_POOL,&base);
-    if(EFI_ERROR(status))
-    {
-        /*申请页表内存池失败*/
-        DEBUG((DEBUG_ERROR,"[aos.uefi.env] Failed to allocate page table memory pool of %llu "
-            "pages.\n",(UINT64)CONFIG_PAGE_TABLE_POOL));
-        return status;
-    }
-    params->minfo.fblock_paddr[1]=base;
-    params->minfo.fblock_pages[1]=CONFIG_PAGE_TABLE_POOL;
-    params->bitmap_length=CONFIG_PAGE_TABLE_POOL/8+(CONFIG_PAGE_TABLE_POOL%8?1:0);
-    params->bitmap=(UINT8*)umalloc(params->bitmap_length);
-    if(params->bitmap==NULL)
-    {
-        /*申请页表内存池位图失败*/
-        DEBUG((DEBUG_ERROR,"[aos.uefi.env] Failed to allocate page table memory pool bitmap of "
-            "%llu pages.\n",(UINT64)CONFIG_PAGE_TABLE_POOL));
-        return EFI_OUT_OF_RESOURCES;
-    }
-    ZeroMem(params->bitmap,params->bitmap_length);
-    params->bitmap[params->bitmap_length-1]=ENV_BITMAP_MASK[CONFIG_PAGE_TABLE_POOL%8];
-
     UINT64 seed_value=AOS_UEFI_VERSION;
     GetRandomNumber64(&seed_value);
     AsciiSPrint(seed,sizeof(seed),"Module \"aos.uefi\" seed: "
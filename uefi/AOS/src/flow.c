@@ -116,6 +116,8 @@ VOID EFIAPI dump_boot_params(IN aos_boot_params* params)
         OFFSET_OF(aos_graphics_info,fb_base),params->graphics.fb_base));
     DEBUG((DEBUG_INFO,"[aos.uefi.flow] [0x%03lX]fb_size:0x%016lX\n",
         OFFSET_OF(aos_graphics_info,fb_size),params->graphics.fb_size));
+    DEBUG((DEBUG_INFO,"[aos.uefi.flow] [0x%03lX]fb_vbase:0x%016lX\n",
+        OFFSET_OF(aos_graphics_info,fb_vbase),params->graphics.fb_vbase));
     DEBUG((DEBUG_INFO,"[aos.uefi.flow] [0x%03lX]red:0x%08X\n",OFFSET_OF(aos_graphics_info,red),
         params->graphics.red));
     DEBUG((DEBUG_INFO,"[aos.uefi.flow] [0x%03lX]green:0x%08X\n",OFFSET_OF(aos_graphics_info,green),
@@ -137,6 +139,8 @@ VOID EFIAPI dump_boot_params(IN aos_boot_params* params)
         params->kinfo.gbase));
     DEBUG((DEBUG_INFO,"[aos.uefi.flow] [0x%03lX]pbase:0x%016lX\n",OFFSET_OF(aos_kernel_info,gbase),
         params->kinfo.pbase));
+    DEBUG((DEBUG_INFO,"[aos.uefi.flow] [0x%03lX]fbase:0x%016lX\n",OFFSET_OF(aos_kernel_info,fbase),
+        params->kinfo.fbase));
     DEBUG((DEBUG_INFO,"[aos.uefi.flow] [0x%03lX]entry:0x%016lX\n",OFFSET_OF(aos_kernel_info,entry),
         params->kinfo.entry));
     DEBUG((DEBUG_INFO,"[aos.uefi.flow] [0x%03lX]load:%lu\n",OFFSET_OF(aos_kernel_info,load),
@@ -178,10 +182,16 @@ VOID EFIAPI dump_boot_params(IN aos_boot_params* params)
         OFFSET_OF(aos_memory_info,fblock_paddr[4]),params->minfo.fblock_paddr[4]));
     DEBUG((DEBUG_INFO,"[aos.uefi.flow] [0x%03lX]fblock_pages[4]:0x%016lX\n",
         OFFSET_OF(aos_memory_info,fblock_pages[4]),params->minfo.fblock_pages[4]));
+    DEBUG((DEBUG_INFO,"[aos.uefi.flow] [0x%03lX]fblock_paddr[5]:0x%016lX\n",
+        OFFSET_OF(aos_memory_info,fblock_paddr[5]),params->minfo.fblock_paddr[5]));
+    DEBUG((DEBUG_INFO,"[aos.uefi.flow] [0x%03lX]fblock_pages[5]:0x%016lX\n",
+        OFFSET_OF(aos_memory_info,fblock_pages[5]),params->minfo.fblock_pages[5]));
     DEBUG((DEBUG_INFO,"[aos.uefi.flow] [0x%03lX]vblock_paddr:0x%016lX\n",
         OFFSET_OF(aos_memory_info,vblock_paddr),params->minfo.vblock_paddr));
     DEBUG((DEBUG_INFO,"[aos.uefi.flow] [0x%03lX]vblock_pages:0x%016lX\n",
         OFFSET_OF(aos_memory_info,vblock_pages),params->minfo.vblock_pages));
+    DEBUG((DEBUG_INFO,"[aos.uefi.flow] [0x%03lX]frames:0x%016lX\n",
+        OFFSET_OF(aos_memory_info,frames),params->minfo.frames));
     DEBUG_CODE_END();
 }
 
@@ -40,6 +40,70 @@ STATIC BOOLEAN EFIAPI loader_elf_check(IN loader_elf64_ehdr* header,IN UINTN siz
     return TRUE;
 }
 
+/**
+ * 为每个物理页框预留内核页框描述符数组，并映射到页框描述符区域。数组按2MB对齐以便使用大页映射。
+ *
+ * @param params 启动参数。
+ *
+ * @return 正常完成返回成功，内存上限无法获取或分配失败返回对应错误。
+ */
+STATIC EFI_STATUS EFIAPI loader_map_frames(IN OUT aos_boot_params* params)
+{
+    UINTN limit;
+    EFI_STATUS status=get_memory_limit(&limit);
+    if(EFI_ERROR(status))
+    {
+        /*获取物理内存上限失败*/
+        DEBUG((DEBUG_ERROR,"[aos.uefi.loader] Failed to get the physical memory limit.\n"));
+        return status;
+    }
+
+    UINTN frames=EFI_SIZE_TO_PAGES(limit);
+    UINTN size=ALIGN_VALUE(frames*AOS_FRAME_DESCRIPTOR_SIZE,SIZE_2MB);
+    if(size>SIZE_512GB)
+    {
+        /*页框描述符数组超出区域大小*/
+        DEBUG((DEBUG_ERROR,"[aos.uefi.loader] The frame descriptor array exceeds its region.\n"));
+        return EFI_UNSUPPORTED;
+    }
+
+    /*多申请不足2MB的部分用于对齐，之后把首尾多余页面归还*/
+    UINTN pages=EFI_SIZE_TO_PAGES(size);
+    UINTN total=pages+EFI_SIZE_TO_PAGES(SIZE_2MB)-1;
+    EFI_PHYSICAL_ADDRESS base;
+    status=gBS->AllocatePages(AllocateAnyPages,EfiLoaderData,total,&base);
+    if(EFI_ERROR(status))
+    {
+        /*申请页面失败*/
+        DEBUG((DEBUG_ERROR,"[aos.uefi.loader] Failed to allocate pages.\n"));
+        return status;
+    }
+    UINTN aligned=ALIGN_VALUE(base,SIZE_2MB);
+    if(aligned>base)
+    {
+        gBS->FreePages(base,EFI_SIZE_TO_PAGES(aligned-base));
+    }
+    if(base+EFI_PAGES_TO_SIZE(total)>aligned+size)
+    {
+        gBS->FreePages(aligned+size,EFI_SIZE_TO_PAGES(base+EFI_PAGES_TO_SIZE(total)-aligned-size));
+    }
+
+    params->minfo.fblock_paddr[5]=aligned;
+    params->minfo.fblock_pages[5]=pages;
+    params->minfo.frames=frames;
+    params->kinfo.fbase=LOADER_FRAME_BASE;
+    status=add_kernel_vma(params->kinfo.fbase,aligned,pages,AOS_BOOT_VMA_READ|AOS_BOOT_VMA_WRITE|
+        AOS_BOOT_VMA_GLOBAL|AOS_BOOT_VMA_TYPE_WB);
+    if(EFI_ERROR(status))
+    {
+        /*添加页框描述符数组线性区失败*/
+        DEBUG((DEBUG_ERROR,"[aos.uefi.loader] Failed to add the frame descriptor array VMA.\n"));
+        return status;
+    }
+
+    return EFI_SUCCESS;
+}
+
 /**
  * 将内核文件内容映射到内存区域。
  *
@@ -347,7 +411,7 @@ STATIC EFI_STATUS EFIAPI loader_map(IN asv_file* kernel,IN OUT aos_boot_params*
         return status;
     }
 
-    return EFI_SUCCESS;
+    return loader_map_frames(params);
 }
 
 /**
@@ -367,4 +367,9 @@ typedef struct _loader_elf64_dyn
  */
 #define LOADER_POOL_BASE ((UINTN)(-5*SIZE_512GB))
 
+/**
+ * 页框描述符数组区域基址。
+ */
+#define LOADER_FRAME_BASE ((UINTN)(-6*SIZE_512GB))
+
 #endif /*__AOS_UEFI_LOADER_INTERNAL_H__*/
\ No newline at end of file
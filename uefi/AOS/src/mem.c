@@ -618,4 +618,73 @@ EFI_STATUS EFIAPI get_memory_type(IN UINTN* addrs,IN UINTN length,OUT EFI_MEMORY
         ufree(memmap);
         return EFI_SUCCESS;
     }
+}
+
+/**
+ * 获取物理内存上限，即所有内存类描述符中最高的结束地址。设备映射与保留区域不计入。
+ * 
+ * @param limit 物理内存上限。
+ * 
+ * @return 返回调用状态。
+ */
+EFI_STATUS EFIAPI get_memory_limit(OUT UINTN* limit)
+{
+    EFI_MEMORY_DESCRIPTOR* memmap=NULL;
+    UINTN map_size=0,desc_size,map_key;
+    UINT32 desc_ver;
+    EFI_STATUS status;
+
+    *limit=0;
+    status=gBS->GetMemoryMap(&map_size,memmap,&map_key,&desc_size,&desc_ver);
+    if(status!=EFI_BUFFER_TOO_SMALL)
+    {
+        /*在检查内存映射大小时设置了不正确的参数*/
+        DEBUG((DEBUG_ERROR,"[aos.uefi.mem] Incorrect parameters were set when checking the "
+            "memory map size.\n"));
+        return status;
+    }
+
+    ASSERT(map_size>0);
+    memmap=umalloc(map_size);
+    if(memmap==NULL)
+    {
+        /*配置的内存池空间不足*/
+        DEBUG((DEBUG_ERROR,"[aos.uefi.mem] The configured memory pool space is insufficient.\n"));
+        return EFI_OUT_OF_RESOURCES;
+    }
+    status=gBS->GetMemoryMap(&map_size,memmap,&map_key,&desc_size,&desc_ver);
+    if(status!=EFI_SUCCESS||desc_ver!=EFI_MEMORY_DESCRIPTOR_VERSION)
+    {
+        /*在获取内存映射时发生意外状况*/
+        DEBUG((DEBUG_ERROR,"[aos.uefi.mem] An unexpected condition occurred while obtaining "
+            "the memory map.\n"));
+        ufree(memmap);
+        return EFI_UNSUPPORTED;
+    }
+
+    EFI_MEMORY_DESCRIPTOR* desc=memmap;
+    UINTN end=map_size+(UINTN)memmap;
+    while((UINTN)desc<end)
+    {
+        switch(desc->Type)
+        {
+            case EfiReservedMemoryType:
+            case EfiUnusableMemory:
+            case EfiMemoryMappedIO:
+            case EfiMemoryMappedIOPortSpace:
+                break;
+            default:
+            {
+                UINTN desc_end=EFI_PAGES_TO_SIZE(desc->NumberOfPages)+desc->PhysicalStart;
+                if(desc_end>*limit)
+                {
+                    *limit=desc_end;
+                }
+                break;
+            }
+        }
+        desc=(EFI_MEMORY_DESCRIPTOR*)((UINTN)desc+desc_size);
+    }
+    ufree(memmap);
+    return EFI_SUCCESS;
 }
\ No newline at end of file
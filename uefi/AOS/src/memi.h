@@ -128,7 +128,7 @@ typedef struct _mem_tlsf_meta
  * 总页数检查。
  * 这里主要是避免过大，虚拟机默认低4GB映射了2GB，合计使用超过1GB的内存池没有意义。
  */
-#if (CONFIG_BOOTSTRAP_POOL+CONFIG_KERNEL_POOL+CONFIG_PAGE_TABLE_POOL)>EFI_SIZE_TO_PAGES(SIZE_1GB)
+#if (CONFIG_BOOTSTRAP_POOL+CONFIG_KERNEL_POOL)>EFI_SIZE_TO_PAGES(SIZE_1GB)
 #error The required memory is too large.
 #endif
 
@@ -9,14 +9,19 @@
 #include "pvmi.h"
 
 /**
- * 位图指针。
+ * 位图指针。每个64位字对应64页，位为1表示已占用。
  */
-STATIC UINT8* bitmap;
+STATIC UINT64* bitmap;
 
 /**
- * 位图长度。
+ * 位图字数。
  */
-STATIC UINTN bitmap_length;
+STATIC UINTN bitmap_words;
+
+/**
+ * 下次查找的起始字下标。
+ */
+STATIC UINTN cursor;
 
 /**
  * 页表池基址。
@@ -29,53 +34,178 @@ STATIC UINTN pbase;
 STATIC UINTN ppages;
 
 /**
- * 申请一页内存。
+ * 预留页段的下一页地址。预留页段已清零，建立新子树时一次申请，之后逐页取用。
+ */
+STATIC UINTN supply_base=0;
+
+/**
+ * 预留页段剩余页数。
+ */
+STATIC UINTN supply_pages=0;
+
+/**
+ * 在位图中标记一段页面。
+ * 
+ * @param index 起始页号。
+ * @param pages 页数。
+ * @param used  为真标记为占用，否则标记为空闲。
+ * 
+ * @return 无返回值。
+ */
+STATIC VOID EFIAPI pvm_bitmap_set(IN UINTN index,IN UINTN pages,IN BOOLEAN used)
+{
+    while(pages>0)
+    {
+        UINTN bit=index&0x3F;
+        UINTN count=MIN(64-bit,pages);
+        UINT64 mask=count==64?MAX_UINT64:(LShiftU64(1,count)-1)<<bit;
+        if(used)
+        {
+            bitmap[index>>6]|=mask;
+        }
+        else
+        {
+            bitmap[index>>6]&=~mask;
+        }
+        index+=count;
+        pages-=count;
+    }
+}
+
+/**
+ * 申请一页内存。优先从预留页段取用，否则从游标处按字查找第一个空闲位。
  * 
  * @return 正常返回一页指针基址，错误返回固定常量。
  */
 STATIC VOID* EFIAPI pvm_page_alloc()
 {
-    UINTN index=bitmap_length;
-    for(UINTN i=0;i<bitmap_length;i++)
+    if(supply_pages>0)
+    {
+        VOID* addr=(VOID*)supply_base;
+        supply_base+=SIZE_4KB;
+        supply_pages--;
+        return addr;
+    }
+
+    for(UINTN i=0;i<bitmap_words;i++)
     {
-        if(bitmap[i]==0xFF)
+        UINTN word=cursor+i;
+        if(word>=bitmap_words)
         {
-            continue;
+            word-=bitmap_words;
         }
-        else
+        if(bitmap[word]==MAX_UINT64)
         {
-            index=i;
-            break;
+            continue;
         }
+
+        UINTN bit=(UINTN)LowBitSet64(~bitmap[word]);
+        bitmap[word]|=LShiftU64(1,bit);
+        cursor=word;
+        VOID* addr=(VOID*)((((word<<6)+bit)<<12)+pbase);
+        ZeroMem(addr,SIZE_4KB);
+        return addr;
     }
 
-    if(index>=bitmap_length)
+    /*页面内存池耗尽，无页面可用*/
+    DEBUG((DEBUG_ERROR,"[aos.uefi.pvm] "
+        "The page memory pool is exhausted and no pages are available.\n"));
+    return PVM_ERROR;
+}
+
+/**
+ * 申请连续多页内存。从游标处开始查找，全满字与全空字整字跳过。
+ * 
+ * @param pages 页数。
+ * 
+ * @return 正常返回起始页基址，找不到足够长的空闲段返回固定常量。
+ */
+STATIC VOID* EFIAPI pvm_pages_alloc(IN UINTN pages)
+{
+    if(pages==0||pages>ppages)
     {
-        /*页面内存池耗尽，无页面可用*/
-        DEBUG((DEBUG_ERROR,"[aos.uefi.pvm] "
-            "The page memory pool is exhausted and no pages are available.\n"));
         return PVM_ERROR;
     }
-    else
+
+    /*游标前的空闲段可能跨越回绕点，因此从游标处起最多扫描一圈再多一个字*/
+    UINTN start=0;
+    UINTN length=0;
+    for(UINTN i=0;i<=bitmap_words;i++)
     {
-        UINT8 bit=8;
-        for(UINTN i=0;i<8;i++)
+        UINTN word=cursor+i;
+        if(word>=bitmap_words)
         {
-            if(bitmap[index]&PVM_BITMAP_MASK[i])
+            word-=bitmap_words;
+            if(word==0)
             {
-                continue;
+                /*空闲段不跨越池尾*/
+                length=0;
             }
-            else
+        }
+
+        UINT64 value=bitmap[word];
+        if(value==MAX_UINT64)
+        {
+            length=0;
+            continue;
+        }
+        if(value==0)
+        {
+            if(length==0)
             {
-                bit=i;
-                break;
+                start=word<<6;
             }
+            length+=64;
         }
-        bitmap[index]|=PVM_BITMAP_MASK[bit];
-        index=(index<<3)+bit;
-        VOID* addr=(VOID*)((index<<12)+pbase);
-        ZeroMem(addr,SIZE_4KB);
-        return addr;
+        else
+        {
+            for(UINTN bit=0;bit<64&&length<pages;bit++)
+            {
+                if(value&LShiftU64(1,bit))
+                {
+                    length=0;
+                }
+                else
+                {
+                    if(length==0)
+                    {
+                        start=(word<<6)+bit;
+                    }
+                    length++;
+                }
+            }
+        }
+
+        if(length>=pages)
+        {
+            pvm_bitmap_set(start,pages,TRUE);
+            cursor=(start+pages-1)>>6;
+            VOID* addr=(VOID*)((start<<12)+pbase);
+            ZeroMem(addr,EFI_PAGES_TO_SIZE(pages));
+            return addr;
+        }
+    }
+    return PVM_ERROR;
+}
+
+/**
+ * 为即将建立的子树预留连续页段。已有剩余预留页或找不到连续空闲段时不预留，之后逐页申请。
+ * 
+ * @param pages 子树所需页表页数。
+ * 
+ * @return 无返回值。
+ */
+STATIC VOID EFIAPI pvm_page_reserve(IN UINTN pages)
+{
+    if(supply_pages>0||pages<2)
+    {
+        return;
+    }
+    VOID* addr=pvm_pages_alloc(pages);
+    if(((UINTN)addr&0xFFF)==0)
+    {
+        supply_base=(UINTN)addr;
+        supply_pages=pages;
     }
 }
 
@@ -94,9 +224,7 @@ STATIC VOID EFIAPI pvm_page_free(IN VOID* addr)
     }
 
     ptr=(ptr-pbase)>>12;
-    UINT8 bit=ptr&0x7;
-    ptr=ptr>>3;
-    bitmap[ptr]=bitmap[ptr]&(~PVM_BITMAP_MASK[bit]);
+    bitmap[ptr>>6]&=~LShiftU64(1,ptr&0x3F);
 }
 
 /**
@@ -110,11 +238,12 @@ VOID EFIAPI dump_bitmap()
     DEBUG((DEBUG_INFO,"[aos.uefi.pvm] ==================================================\n"));
     DEBUG((DEBUG_INFO,"[aos.uefi.pvm] Bitmap Pool Base:0x%016lX\n",pbase));
     DEBUG((DEBUG_INFO,"[aos.uefi.pvm] Bitmap Pool Size:%lu\n",ppages));
+    DEBUG((DEBUG_INFO,"[aos.uefi.pvm] Bitmap Supply:%lu\n",supply_pages));
     DEBUG((DEBUG_INFO,"[aos.uefi.pvm] ==================================================\n"));
     DEBUG((DEBUG_INFO,"[aos.uefi.pvm] Bitmap Info\n"));
-    for(UINTN index=0;index<bitmap_length;index++)
+    for(UINTN index=0;index<bitmap_words;index++)
     {
-        DEBUG((DEBUG_INFO,"[aos.uefi.pvm] %02lu:%02X\n",index,bitmap[index]));
+        DEBUG((DEBUG_INFO,"[aos.uefi.pvm] %02lu:%016lX\n",index,bitmap[index]));
     }
     DEBUG_CODE_END();
 }
@@ -129,6 +258,37 @@ STATIC BOOLEAN nx=FALSE;
  */
 STATIC BOOLEAN page1gb=FALSE;
 
+/**
+ * 计算新建页目录或页目录指针表映射一段内存所需的页表页数，包括其自身。
+ * 判断大页的条件与映射函数一致，因此预留的页面恰好用完。
+ * 
+ * @param level 页表层级，2为页目录，3为页目录指针表。
+ * @param vaddr 映射目标起始地址。
+ * @param paddr 映射物理起始地址。
+ * @param pages 内存块页数。
+ * 
+ * @return 页表页数。
+ */
+STATIC UINTN EFIAPI pvm_subtree_pages(IN UINTN level,IN UINTN vaddr,IN UINTN paddr,IN UINTN pages)
+{
+    UINTN span=level==3?0x40000:0x200;
+    UINTN mask=level==3?PVM_PAGE_1G_OFFSET_MASK:PVM_PAGE_2M_OFFSET_MASK;
+    UINTN count=1;
+    while(pages>0)
+    {
+        UINTN block=span-((vaddr>>12)&(span-1));
+        block=MIN(block,pages);
+        if(block!=span||(vaddr&mask)||(paddr&mask)||(level==3&&!page1gb))
+        {
+            count+=level==3?pvm_subtree_pages(2,vaddr,paddr,block):1;
+        }
+        pages-=block;
+        vaddr+=EFI_PAGES_TO_SIZE(block);
+        paddr+=EFI_PAGES_TO_SIZE(block);
+    }
+    return count;
+}
+
 /**
  * 将物理内存块映射到页表项内。
  * 
@@ -243,6 +403,7 @@ STATIC EFI_STATUS EFIAPI pvm_pdpe_map(IN VOID* pdp,IN UINTN vaddr,IN UINTN paddr
             }
             else
             {
+                pvm_page_reserve(pvm_subtree_pages(2,vaddr,paddr,block));
                 pd=pvm_page_alloc();
                 if((UINTN)pd&0xFFF)
                 {
@@ -290,6 +451,7 @@ STATIC EFI_STATUS EFIAPI pvm_pml4e_map(IN VOID* pml4,IN UINTN vaddr,IN UINTN pad
         }
         else
         {
+            pvm_page_reserve(pvm_subtree_pages(3,vaddr,paddr,block));
             pdp=pvm_page_alloc();
             if((UINTN)pdp&0xFFF)
             {
@@ -902,7 +1064,10 @@ STATIC VOID EFIAPI (*pvm_dump_pml)();
  */
 VOID EFIAPI dump_page_table()
 {
-    pvm_dump_pml();
+    if(page_table!=NULL)
+    {
+        pvm_dump_pml();
+    }
 }
 
 /**
@@ -1069,7 +1234,8 @@ STATIC BOOLEAN EFIAPI pvm_check_vma_node(IN UINTN vaddr,IN UINTN pages)
 }
 
 /**
- * 添加一个内核线性区。
+ * 添加一个内核线性区。线性区先登记，获取内存映射时按全部线性区一次建立页表。
+ * 页表建立后添加的线性区立即映射，页表只能取自页表池的固定预留，预留不足时返回资源不足。
  * 
  * @param vaddr 线性区域基址。
  * @param paddr 物理区域基址。
@@ -1126,6 +1292,7 @@ EFI_STATUS EFIAPI add_kernel_vma(IN UINTN vaddr,IN UINTN paddr,IN UINTN pages,IN
     {
         vma->start=vaddr;
         vma->end=vaddr+EFI_PAGES_TO_SIZE(pages);
+        vma->paddr=paddr;
         vma->flags=flags|AOS_BOOT_VMA_ALLOCATED;
         vma->prev=NULL;
         vma->next=NULL;
@@ -1146,7 +1313,10 @@ VOID EFIAPI remove_kernel_vma(IN UINTN vaddr)
     aos_boot_vma* node=pvm_find_vma_node(vaddr);
     if(node!=NULL)
     {
-        pvm_pml_unmap(node->start,node->end);
+        if(page_table!=NULL)
+        {
+            pvm_pml_unmap(node->start,node->end);
+        }
         pvm_remove_vma_node(node);
         ufree(node);
     }
@@ -1193,6 +1363,7 @@ VOID EFIAPI dump_vma()
             DEBUG((DEBUG_INFO,"[aos.uefi.pvm] ==================================================\n"));
             DEBUG((DEBUG_INFO,"[aos.uefi.pvm] VMA-%lu\n",index));
             DEBUG((DEBUG_INFO,"[aos.uefi.pvm] Range:0x%016lX-0x%016lX\n",node->start,node->end));
+            DEBUG((DEBUG_INFO,"[aos.uefi.pvm] Physical:0x%016lX\n",node->paddr));
             DEBUG((DEBUG_INFO,"[aos.uefi.pvm] Flags:%016lX\n",node->flags));
             node=node->next;
             index++;
@@ -1228,6 +1399,44 @@ UINT32 EFIAPI random32(IN OUT UINT32* a,IN OUT UINT32* b,IN OUT UINT32* c)
     return value;
 }
 
+/**
+ * 添加帧缓冲线性区。帧缓冲按写合并映射，内核经该线性区输出像素，不再经过不可缓存的恒等映射。
+ * 恒等映射与直接映射中同一物理区域仍为不可缓存，但不可缓存映射不会被推测访问，只要不经它们写入就不会冲突。
+ * 
+ * @param params 启动参数。
+ * 
+ * @return 正常添加或没有帧缓冲返回成功。
+ */
+STATIC EFI_STATUS EFIAPI pvm_set_framebuffer_vma(IN OUT aos_boot_params* params)
+{
+    params->graphics.fb_vbase=0;
+    if(params->graphics.fb_size==0)
+    {
+        return EFI_SUCCESS;
+    }
+
+    UINTN paddr=params->graphics.fb_base&~PVM_PAGE_4K_OFFSET_MASK;
+    UINTN pages=EFI_SIZE_TO_PAGES(params->graphics.fb_base+params->graphics.fb_size-paddr);
+    if(pages>EFI_SIZE_TO_PAGES(SIZE_512GB-SIZE_1GB))
+    {
+        /*帧缓冲超出区域大小*/
+        DEBUG((DEBUG_ERROR,"[aos.uefi.pvm] The framebuffer exceeds its region.\n"));
+        return EFI_UNSUPPORTED;
+    }
+
+    UINTN vaddr=PVM_FRAMEBUFFER_BASE+(paddr&PVM_PAGE_1G_OFFSET_MASK);
+    EFI_STATUS status=add_kernel_vma(vaddr,paddr,pages,AOS_BOOT_VMA_READ|AOS_BOOT_VMA_WRITE|AOS_BOOT_VMA_GLOBAL|
+        AOS_BOOT_VMA_TYPE_WC);
+    if(EFI_ERROR(status))
+    {
+        /*添加帧缓冲线性区失败*/
+        DEBUG((DEBUG_ERROR,"[aos.uefi.pvm] Failed to add the framebuffer VMA.\n"));
+        return status;
+    }
+    params->graphics.fb_vbase=vaddr+(params->graphics.fb_base&PVM_PAGE_4K_OFFSET_MASK);
+    return EFI_SUCCESS;
+}
+
 /**
  * 初始化页表与线性区管理功能。
  * 
@@ -1237,10 +1446,6 @@ UINT32 EFIAPI random32(IN OUT UINT32* a,IN OUT UINT32* b,IN OUT UINT32* c)
  */
 EFI_STATUS EFIAPI pvm_init(IN OUT aos_boot_params* params)
 {
-    pbase=params->minfo.fblock_paddr[1];
-    bitmap=params->bitmap;
-    bitmap_length=params->bitmap_length;
-    ppages=params->minfo.fblock_pages[1];
     head=&params->vma_head;
     tail=&params->vma_tail;
 
@@ -1259,11 +1464,7 @@ EFI_STATUS EFIAPI pvm_init(IN OUT aos_boot_params* params)
         pvm_dump_pml=pvm_dump_pml4;
     }
 
-    /*必不可能报错*/
-    page_table=pvm_page_alloc();
-    params->page_table=(UINTN)page_table;
-
-    /*以下为线性区添加*/
+    /*以下为线性区添加。页表在全部线性区登记后一次建立*/
     EFI_STATUS status;
     status=add_kernel_vma(0,0,EFI_SIZE_TO_PAGES(SIZE_4GB),
         AOS_BOOT_VMA_READ|AOS_BOOT_VMA_WRITE|AOS_BOOT_VMA_EXECUTE|AOS_BOOT_VMA_TYPE_UC);
@@ -1274,7 +1475,7 @@ EFI_STATUS EFIAPI pvm_init(IN OUT aos_boot_params* params)
         return EFI_OUT_OF_RESOURCES;
     }
 
-    return EFI_SUCCESS;
+    return pvm_set_framebuffer_vma(params);
 }
 
 /**
@@ -1451,6 +1652,247 @@ STATIC EFI_STATUS EFIAPI pvm_set_runtime_vma(IN EFI_MEMORY_DESCRIPTOR* runtime)
     return EFI_SUCCESS;
 }
 
+/**
+ * 判断内存描述符是否描述普通内存。
+ * 
+ * @param dsc 内存描述符。
+ * 
+ * @return 普通内存返回真，保留、不可用与MMIO区域返回假。
+ */
+STATIC BOOLEAN EFIAPI pvm_is_ram(IN EFI_MEMORY_DESCRIPTOR* dsc)
+{
+    switch(dsc->Type)
+    {
+        case EfiReservedMemoryType:
+        case EfiUnusableMemory:
+        case EfiMemoryMappedIO:
+        case EfiMemoryMappedIOPortSpace:
+            return FALSE;
+        default:
+            return TRUE;
+    }
+}
+
+/**
+ * 添加一段直接映射线性区。
+ * 
+ * @param start 物理起始地址。
+ * @param end   物理结束地址。
+ * @param ram   为真按普通内存映射，否则按不可缓存映射。
+ * 
+ * @return 映射状态。
+ */
+STATIC EFI_STATUS EFIAPI pvm_add_direct_vma(IN UINTN start,IN UINTN end,IN BOOLEAN ram)
+{
+    DEBUG((DEBUG_INFO,"[aos.uefi.pvm] Direct map 0x%016lX-0x%016lX,%a.\n",start,end,ram?"WB":"UC"));
+    UINT64 flags=AOS_BOOT_VMA_READ|AOS_BOOT_VMA_WRITE|AOS_BOOT_VMA_GLOBAL;
+    flags|=ram?AOS_BOOT_VMA_TYPE_WB:AOS_BOOT_VMA_TYPE_UC;
+    EFI_STATUS status=add_kernel_vma(PVM_DIRECT_BASE+start,start,EFI_SIZE_TO_PAGES(end-start),flags);
+    if(EFI_ERROR(status))
+    {
+        /*添加直接映射线性区失败*/
+        DEBUG((DEBUG_ERROR,"[aos.uefi.pvm] Failed to add the direct map VMA.\n"));
+    }
+    return status;
+}
+
+/**
+ * 建立全部物理内存的直接映射。普通内存按回写映射，空洞与MMIO按不可缓存映射，
+ * 避免大页把设备区域映射为可缓存。连续区段对齐允许时由页表自动使用2MB或1GB大页。
+ * 
+ * @param memmap     内存图。
+ * @param map_size   内存图大小。
+ * @param entry_size 内存项大小。
+ * 
+ * @return 映射状态。
+ */
+STATIC EFI_STATUS EFIAPI pvm_set_direct_map(IN EFI_MEMORY_DESCRIPTOR* memmap,IN UINTN map_size,IN UINTN entry_size)
+{
+    UINTN end=(UINTN)memmap+map_size;
+    UINTN limit=0;
+    for(EFI_MEMORY_DESCRIPTOR* dsc=memmap;(UINTN)dsc<end;dsc=(EFI_MEMORY_DESCRIPTOR*)((UINTN)dsc+entry_size))
+    {
+        limit=MAX(limit,dsc->PhysicalStart+EFI_PAGES_TO_SIZE(dsc->NumberOfPages));
+    }
+    limit=ALIGN_VALUE(limit,SIZE_2MB);
+    if(limit>PVM_DIRECT_LIMIT)
+    {
+        /*物理地址超出直接映射区*/
+        DEBUG((DEBUG_WARN,"[aos.uefi.pvm] Physical memory beyond the direct map is not mapped.\n"));
+        limit=PVM_DIRECT_LIMIT;
+    }
+
+    /*内存图不保证有序，每轮从游标处合并相接的普通内存，否则延伸到下一段普通内存*/
+    UINTN cursor=0;
+    while(cursor<limit)
+    {
+        UINTN next=cursor;
+        BOOLEAN grown=TRUE;
+        while(grown)
+        {
+            grown=FALSE;
+            for(EFI_MEMORY_DESCRIPTOR* dsc=memmap;(UINTN)dsc<end;
+                dsc=(EFI_MEMORY_DESCRIPTOR*)((UINTN)dsc+entry_size))
+            {
+                UINTN dsc_end=dsc->PhysicalStart+EFI_PAGES_TO_SIZE(dsc->NumberOfPages);
+                if(pvm_is_ram(dsc)&&dsc->PhysicalStart<=next&&dsc_end>next)
+                {
+                    next=dsc_end;
+                    grown=TRUE;
+                }
+            }
+        }
+
+        BOOLEAN ram=next>cursor;
+        if(!ram)
+        {
+            next=limit;
+            for(EFI_MEMORY_DESCRIPTOR* dsc=memmap;(UINTN)dsc<end;
+                dsc=(EFI_MEMORY_DESCRIPTOR*)((UINTN)dsc+entry_size))
+            {
+                if(pvm_is_ram(dsc)&&dsc->PhysicalStart>cursor&&dsc->PhysicalStart<next)
+                {
+                    next=dsc->PhysicalStart;
+                }
+            }
+        }
+        next=MIN(next,limit);
+
+        EFI_STATUS status=pvm_add_direct_vma(cursor,next,ram);
+        if(EFI_ERROR(status))
+        {
+            return status;
+        }
+        cursor=next;
+    }
+    return EFI_SUCCESS;
+}
+
+/**
+ * 统计一段连续槽中尚未统计的槽数。
+ * 
+ * @param next  第一个尚未统计的槽。
+ * @param first 起始槽。
+ * @param last  结束槽。
+ * 
+ * @return 新统计的槽数。
+ */
+STATIC UINTN EFIAPI pvm_plan_slots(IN OUT UINTN* next,IN UINTN first,IN UINTN last)
+{
+    if(last<*next)
+    {
+        return 0;
+    }
+    UINTN count=last-MAX(first,*next)+1;
+    *next=last+1;
+    return count;
+}
+
+/**
+ * 统计映射全部线性区时某一层级需要的页表数。一个槽对应一张该层级的页表，
+ * 线性区链表按地址有序且互不重叠，相邻线性区最多共用边界上的一个槽，因此按顺序记录已统计到的槽即可去重。
+ * 
+ * @param shift 一个槽覆盖范围的位数。
+ * @param large 为真表示完整覆盖且对齐的槽用大页映射，不需要该层级页表。
+ * 
+ * @return 页表数。
+ */
+STATIC UINTN EFIAPI pvm_plan_tables(IN UINTN shift,IN BOOLEAN large)
+{
+    UINTN mask=LShiftU64(1,shift)-1;
+    UINTN next=0;
+    UINTN count=0;
+    for(aos_boot_vma* node=*head;node!=NULL;node=node->next)
+    {
+        UINTN first=node->start>>shift;
+        UINTN last=(node->end-1)>>shift;
+        if(!large||((node->start^node->paddr)&mask))
+        {
+            count+=pvm_plan_slots(&next,first,last);
+        }
+        else
+        {
+            /*线性与物理地址同余时中间的槽都可用大页，只有首尾不完整的槽需要页表*/
+            if(node->start&mask)
+            {
+                count+=pvm_plan_slots(&next,first,first);
+            }
+            if(node->end&mask)
+            {
+                count+=pvm_plan_slots(&next,last,last);
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * 建立内核页表。先按全部线性区精确计算各层级页表数，加上固定预留一次申请页表池，再逐个映射线性区。
+ * 
+ * @param params 启动参数。
+ * 
+ * @return 正常建立返回成功，申请内存失败返回对应错误。
+ */
+STATIC EFI_STATUS EFIAPI pvm_build_page_table(IN OUT aos_boot_params* params)
+{
+    BOOLEAN la57=(params->state.state&AOS_STATE_LA57)!=0;
+    UINTN pt=pvm_plan_tables(21,TRUE);
+    UINTN pd=pvm_plan_tables(30,page1gb);
+    UINTN pdp=pvm_plan_tables(39,FALSE);
+    UINTN pml4=la57?pvm_plan_tables(48,FALSE):0;
+    UINTN pages=1+pml4+pdp+pd+pt+PVM_TABLE_RESERVE_PAGES;
+    DEBUG((DEBUG_INFO,"[aos.uefi.pvm] Page table plan:1 root,%lu PML4,%lu PDPT,%lu PD,%lu PT,%lu reserve,"
+        "%lu pages.\n",pml4,pdp,pd,pt,(UINTN)PVM_TABLE_RESERVE_PAGES,pages));
+
+    EFI_PHYSICAL_ADDRESS base=SIZE_2GB;
+    EFI_STATUS status=gBS->AllocatePages(AllocateMaxAddress,EfiLoaderData,pages,&base);
+    if(EFI_ERROR(status))
+    {
+        /*申请页表内存池失败*/
+        DEBUG((DEBUG_ERROR,"[aos.uefi.pvm] Failed to allocate page table memory pool of %lu pages.\n",pages));
+        return status;
+    }
+
+    /*位图按64位字访问，长度取整到字，池外的位置为占用*/
+    UINTN words=pages/64+(pages%64?1:0);
+    bitmap=(UINT64*)umalloc(words*sizeof(UINT64));
+    if(bitmap==NULL)
+    {
+        /*申请页表内存池位图失败*/
+        DEBUG((DEBUG_ERROR,"[aos.uefi.pvm] Failed to allocate page table memory pool bitmap of %lu pages.\n",
+            pages));
+        gBS->FreePages(base,pages);
+        return EFI_OUT_OF_RESOURCES;
+    }
+    ZeroMem(bitmap,words*sizeof(UINT64));
+    if(pages%64)
+    {
+        bitmap[words-1]=LShiftU64(MAX_UINT64,pages%64);
+    }
+    bitmap_words=words;
+    cursor=0;
+    pbase=base;
+    ppages=pages;
+    params->minfo.fblock_paddr[1]=base;
+    params->minfo.fblock_pages[1]=pages;
+    params->bitmap=(UINT8*)bitmap;
+    params->bitmap_length=words*sizeof(UINT64);
+
+    page_table=pvm_page_alloc();
+    params->page_table=(UINTN)page_table;
+    for(aos_boot_vma* node=*head;node!=NULL;node=node->next)
+    {
+        status=pvm_pml_map(node->start,node->paddr,EFI_SIZE_TO_PAGES(node->end-node->start),node->flags);
+        if(EFI_ERROR(status))
+        {
+            /*规划的页表数不足*/
+            DEBUG((DEBUG_ERROR,"[aos.uefi.pvm] The planned page table memory pool is insufficient.\n"));
+            return status;
+        }
+    }
+    return EFI_SUCCESS;
+}
+
 /**
  * 获取内存映射。应该在准备结束启动服务时调用。
  * 
@@ -1473,8 +1915,9 @@ EFI_STATUS EFIAPI get_memory_map(IN OUT aos_boot_params* params,OUT UINTN* map_k
     if(status==EFI_BUFFER_TOO_SMALL)
     {
         ASSERT(map_size>0);
-        /*预留4个空位，避免越界*/
+        /*预留4个空位，避免越界。申请页表内存池还会拆分一项*/
         map_size+=sizeof(EFI_MEMORY_DESCRIPTOR)*4;
+        UINTN capacity=map_size;
         memmap=(EFI_MEMORY_DESCRIPTOR*)umalloc(map_size);
         if(memmap==NULL)
         {
@@ -1487,11 +1930,9 @@ EFI_STATUS EFIAPI get_memory_map(IN OUT aos_boot_params* params,OUT UINTN* map_k
         ASSERT(status==EFI_SUCCESS);
         ASSERT(*version==EFI_MEMORY_DESCRIPTOR_VERSION);
 
-        params->minfo.map_length=map_size;
         params->minfo.memory_map=(aos_efi_memory_descriptor*)memmap;
         params->minfo.map_entry_size=entry_size;
 
-        
         EFI_MEMORY_DESCRIPTOR* dsc=memmap;
         UINTN end=map_size+(UINTN)dsc;
         while((UINTN)dsc<end)
@@ -1507,6 +1948,35 @@ EFI_STATUS EFIAPI get_memory_map(IN OUT aos_boot_params* params,OUT UINTN* map_k
             dsc=(EFI_MEMORY_DESCRIPTOR*)((UINTN)dsc+entry_size);
         }
 
+        status=pvm_set_direct_map(memmap,map_size,entry_size);
+        if(EFI_ERROR(status))
+        {
+            return status;
+        }
+        status=pvm_build_page_table(params);
+        if(EFI_ERROR(status))
+        {
+            return status;
+        }
+
+        /*申请页表内存池改变了内存图，重新获取映射键，运行时描述符的线性地址要重新设置*/
+        map_size=capacity;
+        status=gBS->GetMemoryMap(&map_size,memmap,map_key,&entry_size,version);
+        if(EFI_ERROR(status))
+        {
+            /*获取内存图失败*/
+            DEBUG((DEBUG_ERROR,"[aos.uefi.loader] Failed to get the memory map.\n"));
+            return status;
+        }
+        params->minfo.map_length=map_size;
+        end=map_size+(UINTN)memmap;
+        for(dsc=memmap;(UINTN)dsc<end;dsc=(EFI_MEMORY_DESCRIPTOR*)((UINTN)dsc+entry_size))
+        {
+            if(dsc->Attribute&EFI_MEMORY_RUNTIME)
+            {
+                dsc->VirtualStart=vbase+dsc->PhysicalStart;
+            }
+        }
         return EFI_SUCCESS;
     }
     else
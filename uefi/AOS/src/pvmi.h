@@ -17,11 +17,6 @@
 #include <Library/BaseCryptLib.h>
 #include <Library/TimerLib.h>
 
-/**
- * 位图用掩码。
- */
-CONST UINT8 PVM_BITMAP_MASK[]={BIT0,BIT1,BIT2,BIT3,BIT4,BIT5,BIT6,BIT7};
-
 /**
  * 错误指针。
  */
@@ -71,6 +66,11 @@ UINT64* CONST PVM_ERROR=(UINT64*)0x101;
  */
 #define PVM_PDE_FLAGS (PVM_PTE_P|PVM_PTE_RW|PVM_PTE_US)
 
+/**
+ * 页表池在规划页数之外预留的页数。页表建立后再添加的线性区从预留中取页表。
+ */
+#define PVM_TABLE_RESERVE_PAGES 16
+
 /**
  * 物理地址保留掩码。
  */
@@ -86,6 +86,21 @@ UINT64* CONST PVM_ERROR=(UINT64*)0x101;
  */
 #define PVM_VADDR5_RESERVED_MASK 0xFF00000000000000ULL
 
+/**
+ * 帧缓冲线性基址。帧缓冲在该区域内的偏移与物理地址对1GB同余，使对齐允许时能用大页映射。
+ */
+#define PVM_FRAMEBUFFER_BASE ((UINTN)(-2*SIZE_512GB))
+
+/**
+ * 直接映射区线性基址。与内核的直接映射区基址一致，物理地址加上该偏移即为线性地址。
+ */
+#define PVM_DIRECT_BASE ((UINTN)(-10*SIZE_512GB))
+
+/**
+ * 直接映射区大小上限。直接映射区之上是页框描述符数组区域。
+ */
+#define PVM_DIRECT_LIMIT SIZE_2TB
+
 /**
  * 随机魔数。这里是黄金比例常数。
  */